@@ -0,0 +1,115 @@
+#include "adaptive_sampler.h"
+#include <cstring>
+#include "varint.h"
+
+static uint32_t clamp_interval(const adaptive_sampler_t* sampler, uint32_t interval_ms) {
+    if (interval_ms < sampler->floor_ms) {
+        return sampler->floor_ms;
+    }
+    if (interval_ms > sampler->ceiling_ms) {
+        return sampler->ceiling_ms;
+    }
+    return interval_ms;
+}
+
+static void set_interval(adaptive_sampler_t* sampler, uint32_t interval_ms) {
+    interval_ms = clamp_interval(sampler, interval_ms);
+    if (interval_ms != sampler->interval_ms) {
+        sampler->interval_ms = interval_ms;
+        if (sampler->batch.changes < UINT16_MAX) {
+            sampler->batch.changes++;
+        }
+    }
+}
+
+void adaptive_init(adaptive_sampler_t* sampler, uint32_t floor_ms, uint32_t ceiling_ms, uint8_t quiet_pct,
+                   uint8_t quiet_samples, const uint16_t* thresholds, size_t register_count) {
+    memset(sampler, 0, sizeof(*sampler));
+    sampler->floor_ms = floor_ms > 0 ? floor_ms : 1;
+    sampler->ceiling_ms = ceiling_ms > sampler->floor_ms ? ceiling_ms : sampler->floor_ms;
+    sampler->quiet_pct = quiet_pct;
+    sampler->quiet_samples = quiet_samples > 0 ? quiet_samples : 1;
+    sampler->register_count = register_count < ADAPTIVE_MAX_REGISTERS ? register_count : ADAPTIVE_MAX_REGISTERS;
+    memcpy(sampler->thresholds, thresholds, sampler->register_count * sizeof(uint16_t));
+    adaptive_begin_batch(sampler);
+}
+
+uint32_t adaptive_configure(adaptive_sampler_t* sampler, uint32_t base_ms) {
+    if (base_ms != sampler->base_ms) {
+        sampler->base_ms = base_ms;
+        sampler->interval_ms = clamp_interval(sampler, base_ms);
+        sampler->quiet_streak = 0;
+    }
+    return sampler->interval_ms;
+}
+
+uint32_t adaptive_activity(const adaptive_sampler_t* sampler, const uint16_t* values, uint32_t elapsed_ms) {
+    if (elapsed_ms == 0) {
+        elapsed_ms = 1;
+    }
+    uint32_t activity = 0;
+    for (size_t reg = 0; reg < sampler->register_count; reg++) {
+        if (sampler->thresholds[reg] == 0) {
+            continue;
+        }
+        int32_t change = (int32_t)values[reg] - (int32_t)sampler->last[reg];
+        uint64_t magnitude = (uint64_t)(change < 0 ? -change : change);
+        // change per second / threshold, in percent
+        uint64_t pct = magnitude * 1000 * 100 / ((uint64_t)elapsed_ms * sampler->thresholds[reg]);
+        if (pct > activity) {
+            activity = pct > UINT32_MAX ? UINT32_MAX : (uint32_t)pct;
+        }
+    }
+    return activity;
+}
+
+uint32_t adaptive_update(adaptive_sampler_t* sampler, const uint16_t* values, uint32_t timestamp_ms) {
+    if (sampler->has_last) {
+        uint32_t elapsed_ms = timestamp_ms - sampler->last_ms;
+        adaptive_batch_t* batch = &sampler->batch;
+        batch->gaps++;
+        batch->gap_total_ms += elapsed_ms;
+        if (elapsed_ms < batch->gap_min_ms) {
+            batch->gap_min_ms = elapsed_ms;
+        }
+        if (elapsed_ms > batch->gap_max_ms) {
+            batch->gap_max_ms = elapsed_ms;
+        }
+
+        uint32_t activity = adaptive_activity(sampler, values, elapsed_ms);
+        if (activity >= 100) {
+            sampler->quiet_streak = 0;
+            set_interval(sampler, sampler->floor_ms);
+        } else if (activity < sampler->quiet_pct) {
+            if (++sampler->quiet_streak >= sampler->quiet_samples) {
+                sampler->quiet_streak = 0;
+                uint32_t interval_ms = sampler->interval_ms;
+                set_interval(sampler, interval_ms > sampler->ceiling_ms / 2 ? sampler->ceiling_ms : interval_ms * 2);
+            }
+        } else {
+            sampler->quiet_streak = 0;
+        }
+    }
+
+    memcpy(sampler->last, values, sampler->register_count * sizeof(uint16_t));
+    sampler->last_ms = timestamp_ms;
+    sampler->has_last = true;
+    return sampler->interval_ms;
+}
+
+void adaptive_begin_batch(adaptive_sampler_t* sampler) {
+    memset(&sampler->batch, 0, sizeof(sampler->batch));
+    sampler->batch.gap_min_ms = UINT32_MAX;
+}
+
+size_t adaptive_encode_batch(const adaptive_sampler_t* sampler, uint8_t* out, size_t capacity) {
+    const adaptive_batch_t* batch = &sampler->batch;
+    uint32_t mean_ms = batch->gaps ? (uint32_t)(batch->gap_total_ms / batch->gaps) : 0;
+    size_t pos = 0;
+    if (!put_varint(out, capacity, &pos, sampler->interval_ms) || !put_varint(out, capacity, &pos, mean_ms) ||
+        !put_varint(out, capacity, &pos, batch->gaps ? batch->gap_min_ms : 0) ||
+        !put_varint(out, capacity, &pos, batch->gap_max_ms) || !put_varint(out, capacity, &pos, batch->changes)) {
+        return 0;
+    }
+    return pos;
+}
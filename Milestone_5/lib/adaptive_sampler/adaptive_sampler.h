@@ -0,0 +1,64 @@
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Activity-driven read interval. Each new sample is compared with the
+// previous one: the register changing fastest, relative to its threshold
+// (raw counts per second), sets the activity level.
+//   activity >= 100 %            interval drops straight to the floor
+//   activity <  quiet_pct        counts as a quiet sample; after quiet_samples
+//                                in a row the interval doubles (up to the ceiling)
+//   anything in between          interval is held (hysteresis band)
+// Portable (no Arduino dependencies) so it can be exercised on a host.
+//
+// The sampler also keeps per-batch figures, sent as the FRAME_TLV_SAMPLING
+// trailer record: [target interval ms varint] [mean gap ms varint]
+// [min gap varint] [max gap varint] [interval changes varint].
+
+#define ADAPTIVE_MAX_REGISTERS 16
+
+typedef struct {
+    uint32_t gaps;           // Sample gaps seen in the batch
+    uint64_t gap_total_ms;
+    uint32_t gap_min_ms;
+    uint32_t gap_max_ms;
+    uint16_t changes;        // Interval changes in the batch
+} adaptive_batch_t;
+
+typedef struct {
+    uint32_t base_ms;        // Configured interval (start value)
+    uint32_t floor_ms;       // Fastest interval
+    uint32_t ceiling_ms;     // Slowest interval
+    uint32_t interval_ms;    // Effective interval
+    uint8_t quiet_pct;       // Below this activity a sample is quiet
+    uint8_t quiet_samples;   // Quiet samples in a row before backing off
+    uint8_t quiet_streak;
+    size_t register_count;
+    uint16_t thresholds[ADAPTIVE_MAX_REGISTERS];  // Counts per second for 100 %, 0 = ignored
+    uint16_t last[ADAPTIVE_MAX_REGISTERS];
+    uint32_t last_ms;
+    bool has_last;
+    adaptive_batch_t batch;
+} adaptive_sampler_t;
+
+void adaptive_init(adaptive_sampler_t* sampler, uint32_t floor_ms, uint32_t ceiling_ms, uint8_t quiet_pct,
+                   uint8_t quiet_samples, const uint16_t* thresholds, size_t register_count);
+
+// Configured interval; restarts adaptation only when it changed. Returns the effective interval.
+uint32_t adaptive_configure(adaptive_sampler_t* sampler, uint32_t base_ms);
+
+// Activity of a sample against the previous one, in percent of the thresholds
+uint32_t adaptive_activity(const adaptive_sampler_t* sampler, const uint16_t* values, uint32_t elapsed_ms);
+
+// Feed a new sample taken at timestamp_ms; returns the interval for the next read
+uint32_t adaptive_update(adaptive_sampler_t* sampler, const uint16_t* values, uint32_t timestamp_ms);
+
+// Start the figures of a new batch
+void adaptive_begin_batch(adaptive_sampler_t* sampler);
+
+// Batch figures as a trailer record value; returns its length, 0 if it does not fit
+size_t adaptive_encode_batch(const adaptive_sampler_t* sampler, uint8_t* out, size_t capacity);
+
+#endif // ADAPTIVE_SAMPLER_H
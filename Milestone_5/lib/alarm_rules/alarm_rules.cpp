@@ -0,0 +1,55 @@
+#include "alarm_rules.h"
+
+void alarm_init(alarm_state_t* state) {
+    state->active = 0;
+    state->fired = 0;
+}
+
+uint32_t alarm_evaluate(alarm_state_t* state, const alarm_rule_t* rules, size_t rule_count,
+                        const uint16_t* values, size_t value_count) {
+    uint32_t fired = 0;
+    if (rule_count > ALARM_MAX_RULES) {
+        rule_count = ALARM_MAX_RULES;
+    }
+    for (size_t i = 0; i < rule_count; i++) {
+        const alarm_rule_t* rule = &rules[i];
+        if (rule->reg >= value_count) {
+            continue;
+        }
+        uint32_t bit = (uint32_t)1 << i;
+        int32_t value = values[rule->reg];
+        int32_t threshold = rule->threshold;
+        bool rising = rule->edge == ALARM_EDGE_RISING;
+
+        if (!(state->active & bit)) {
+            if (rising ? value >= threshold : value <= threshold) {
+                state->active |= bit;
+                fired |= bit;
+                if (state->fired < UINT32_MAX) {
+                    state->fired++;
+                }
+            }
+        } else if (rising ? value <= threshold - rule->hysteresis : value >= threshold + rule->hysteresis) {
+            state->active &= ~bit;  // Re-armed
+        }
+    }
+    return fired;
+}
+
+size_t alarm_encode(const alarm_rule_t* rules, size_t rule_count, uint32_t fired, uint8_t* out, size_t capacity) {
+    size_t pos = 0;
+    for (size_t i = 0; i < rule_count && i < ALARM_MAX_RULES; i++) {
+        if (!(fired & ((uint32_t)1 << i))) {
+            continue;
+        }
+        if (pos + ALARM_ENTRY_SIZE > capacity) {
+            return 0;
+        }
+        out[pos++] = (uint8_t)i;
+        out[pos++] = rules[i].reg;
+        out[pos++] = rules[i].edge;
+        out[pos++] = rules[i].threshold & 0xFF;
+        out[pos++] = rules[i].threshold >> 8;
+    }
+    return pos;
+}
@@ -0,0 +1,46 @@
+#ifndef ALARM_RULES_H
+#define ALARM_RULES_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Per-register threshold rules with hysteresis. A rising rule fires when the
+// value reaches the threshold and re-arms once it falls to threshold -
+// hysteresis; a falling rule fires at or below the threshold and re-arms at
+// threshold + hysteresis. Each excursion fires once, however long it lasts.
+// Portable (no Arduino dependencies) so it can be exercised on a host.
+//
+// Fired rules are sent as the FRAME_TLV_ALARM trailer record, one entry per
+// rule: [rule id] [register] [edge] [threshold u16 LE].
+
+#define ALARM_MAX_RULES 32
+
+typedef enum {
+    ALARM_EDGE_RISING = 0,
+    ALARM_EDGE_FALLING = 1
+} alarm_edge_t;
+
+typedef struct {
+    uint8_t reg;          // Index into the read registers
+    uint8_t edge;         // alarm_edge_t
+    uint16_t threshold;   // Raw register counts
+    uint16_t hysteresis;  // Raw counts back across the threshold before re-arming
+} alarm_rule_t;
+
+typedef struct {
+    uint32_t active;      // Bit per rule: excursion in progress
+    uint32_t fired;       // Rules fired since boot (saturating)
+} alarm_state_t;
+
+#define ALARM_ENTRY_SIZE 5
+
+void alarm_init(alarm_state_t* state);
+
+// Evaluate one sample; returns the mask of rules that fired on it
+uint32_t alarm_evaluate(alarm_state_t* state, const alarm_rule_t* rules, size_t rule_count,
+                        const uint16_t* values, size_t value_count);
+
+// Trailer record value for the fired rules; returns its length, 0 if it does not fit
+size_t alarm_encode(const alarm_rule_t* rules, size_t rule_count, uint32_t fired, uint8_t* out, size_t capacity);
+
+#endif // ALARM_RULES_H
@@ -2,6 +2,7 @@
 #include "config.h"
 #include "error_handler.h"
 #include "cloudAPI_handler.h"
+#include "modbus_frame.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
 
@@ -10,11 +11,27 @@ bool api_init(void) {
     return true;
 }
 
-String api_send_request(const String& url, const String& method, const String& api_key, const String& frame) {
+size_t api_send_request(const String& url, const String& method, const String& api_key, const uint8_t* frame, size_t frame_length, uint8_t* response_frame, size_t response_capacity) {
     if (WiFi.status() != WL_CONNECTED) {
         log_error(ERROR_WIFI_DISCONNECTED, "WiFi not connected for API request");
-        return "";
+        return 0;
+    }
+
+    // Request body built on the stack, the frame hex-encoded in place
+    static const char BODY_PREFIX[] = "{\"frame\":\"";
+    static const char BODY_SUFFIX[] = "\"}";
+    char request_body[sizeof(BODY_PREFIX) + MODBUS_MAX_FRAME * 2 + sizeof(BODY_SUFFIX)];
+    size_t body_length = sizeof(BODY_PREFIX) - 1;
+    memcpy(request_body, BODY_PREFIX, body_length);
+    size_t hex_length = modbus_hex_encode(frame, frame_length, request_body + body_length,
+                                          sizeof(request_body) - body_length);
+    if (hex_length == 0) {
+        log_error(ERROR_HTTP_FAILED, "Request frame too long");
+        return 0;
     }
+    body_length += hex_length;
+    memcpy(request_body + body_length, BODY_SUFFIX, sizeof(BODY_SUFFIX) - 1);
+    body_length += sizeof(BODY_SUFFIX) - 1;
 
     HTTPClient http;
 
@@ -24,41 +41,31 @@ String api_send_request(const String& url, const String& method, const String& a
     http.addHeader(F("Content-Type"), F("application/json"));
     http.addHeader(F("Authorization"), api_key);
 
-    // Pre-allocate request body
-    String request_body;
-    request_body.reserve(frame.length() + 20);
-    request_body = F("{\"frame\":\"");
-    request_body += frame;
-    request_body += F("\"}");
-    
     int http_code;
     if (method == "POST") {
-        http_code = http.POST(request_body);
+        http_code = http.POST((uint8_t*)request_body, body_length);
     } else if (method == "GET") {
         http_code = http.GET();
     } else {
         log_error(ERROR_INVALID_HTTP_METHOD, "Unsupported HTTP method");
         http.end();
-        return "";
+        return 0;
     }
 
+    size_t response_length = 0;
     if (http_code == HTTP_CODE_OK) {
         String response = http.getString();
 
-        // Parse JSON response more robustly
+        // Decode the "frame" hex straight out of the body, in one pass
         int start = response.indexOf(F("\"frame\":\""));
         if (start >= 0) {
             start += 9; // Length of "\"frame\":\""
             int end = response.indexOf('\"', start);
 
             if (end > start) {
-                String frame_hex = response.substring(start, end);
-                http.end();
-
-                // Basic validation of hex string
-                if (frame_hex.length() > 0 && frame_hex.length() % 2 == 0) {
-                    return frame_hex;
-                } else {
+                response_length = modbus_hex_decode(response.c_str() + start, end - start,
+                                                    response_frame, response_capacity);
+                if (response_length == 0) {
                     log_error(ERROR_INVALID_RESPONSE, "Invalid frame format in response");
                 }
             }
@@ -74,7 +81,7 @@ String api_send_request(const String& url, const String& method, const String& a
     }
 
     http.end();
-    return "";
+    return response_length;
 }
 
 String upload_api_send_request(const String& url, const String& method, const String& api_key, const uint8_t* frame, size_t frame_length, const String& nonce, const String& mac) {
@@ -128,15 +135,30 @@ String upload_api_send_request(const String& url, const String& method, const St
     return "";
 }
 
-String api_send_request_with_retry(const String& url, const String& method, const String& api_key, const String& frame) {
+static api_wait_hook_t wait_hook = nullptr;
+
+void api_set_wait_hook(api_wait_hook_t hook) {
+    wait_hook = hook;
+}
+
+// Retry backoff: lets the owner of the hook use the wait (e.g. keep sampling)
+static void api_wait(unsigned long wait_ms) {
+    if (wait_hook) {
+        wait_hook(wait_ms);
+    } else {
+        delay(wait_ms);
+    }
+}
+
+size_t api_send_request_with_retry(const String& url, const String& method, const String& api_key, const uint8_t* frame, size_t frame_length, uint8_t* response_frame, size_t response_capacity) {
     int retry_count = 0;
     error_code_t last_error_code = ERROR_NONE;
 
     while (retry_count <= MAX_RETRIES) {
-        String response = api_send_request(url, method, api_key, frame);
-        if (response.length() > 0) {
+        size_t response_length = api_send_request(url, method, api_key, frame, frame_length, response_frame, response_capacity);
+        if (response_length > 0) {
             // Success
-            return response;
+            return response_length;
         }
 
         // Get the last error for retry decision
@@ -160,7 +182,7 @@ String api_send_request_with_retry(const String& url, const String& method, cons
         Serial.print(delay_ms);
         Serial.println(F(" ms..."));
 
-        delay(delay_ms);
+        api_wait(delay_ms);
 
         // Try to reconnect WiFi if needed
         if (last_error_code == ERROR_WIFI_DISCONNECTED) {
@@ -168,7 +190,7 @@ String api_send_request_with_retry(const String& url, const String& method, cons
         }
     }
 
-    return "";
+    return 0;
 }
 
 String upload_api_send_request_with_retry(const String& url, const String& method, const String& api_key, const uint8_t* frame, size_t frame_length, const String& nonce, const String& mac) {
@@ -204,7 +226,7 @@ String upload_api_send_request_with_retry(const String& url, const String& metho
         Serial.print(delay_ms);
         Serial.println(F(" ms..."));
 
-        delay(delay_ms);
+        api_wait(delay_ms);
 
         // Try to reconnect WiFi if needed
         if (last_error_code == ERROR_WIFI_DISCONNECTED) {
@@ -337,7 +359,7 @@ void api_command_request_with_retry(const String& url, const String& method, con
         Serial.print(delay_ms);
         Serial.println(F(" ms..."));
 
-        delay(delay_ms);
+        api_wait(delay_ms);
 
         // Try to reconnect WiFi if needed
         if (last_error_code == ERROR_WIFI_DISCONNECTED) {
@@ -6,11 +6,16 @@
 // Initialize the API client
 bool api_init(void);
 
-// Send an API request
-String api_send_request(const String& url, const String& method, const String& api_key, const String& frame);
+// Called instead of delay() for retry backoff waits; must return after wait_ms
+typedef void (*api_wait_hook_t)(unsigned long wait_ms);
+void api_set_wait_hook(api_wait_hook_t hook);
+
+// Send a binary Modbus frame (hex-encoded into the JSON body); the reply's frame is decoded
+// into response_frame. Returns the response length, 0 on failure.
+size_t api_send_request(const String& url, const String& method, const String& api_key, const uint8_t* frame, size_t frame_length, uint8_t* response_frame, size_t response_capacity);
 
 // Send an API request with retry logic
-String api_send_request_with_retry(const String& url, const String& method, const String& api_key, const String& frame);
+size_t api_send_request_with_retry(const String& url, const String& method, const String& api_key, const uint8_t* frame, size_t frame_length, uint8_t* response_frame, size_t response_capacity);
 
 // Send an API request for uploading data
 String upload_api_send_request(const String& url, const String& method, const String& api_key, const uint8_t* frame, size_t frame_length, const String& nonce, const String& mac);
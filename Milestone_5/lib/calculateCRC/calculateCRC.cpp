@@ -1,7 +1,6 @@
 #include "calculateCRC.h"
 
-uint16_t calculateCRC(const uint8_t* data, int length) {
-    uint16_t crc = 0xFFFF;
+uint16_t updateCRC(uint16_t crc, const uint8_t* data, int length) {
     for (int i = 0; i < length; i++) {
         crc ^= data[i];
         for (int j = 0; j < 8; j++) {
@@ -15,3 +14,7 @@ uint16_t calculateCRC(const uint8_t* data, int length) {
     }
     return crc & 0xFFFF;
 }
+
+uint16_t calculateCRC(const uint8_t* data, int length) {
+    return updateCRC(0xFFFF, data, length);
+}
@@ -5,4 +5,7 @@
 
 uint16_t calculateCRC(const uint8_t* data, int length);
 
+// Continue a CRC over more bytes (calculateCRC starts from 0xFFFF)
+uint16_t updateCRC(uint16_t crc, const uint8_t* data, int length);
+
 #endif
@@ -1,9 +0,0 @@
-#ifndef CHECKCRC_H
-#define CHECKCRC_H
-
-#include <cstdint>
-#include <Arduino.h>
-
-bool checkCRC(const String& responseFrame);
-
-#endif
\ No newline at end of file
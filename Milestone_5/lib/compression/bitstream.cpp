@@ -0,0 +1,89 @@
+#include "bitstream.h"
+
+// ---------------- Bit writer ----------------
+void bit_writer_init(bit_writer_t* writer, uint8_t* data, size_t capacity) {
+    writer->data = data;
+    writer->capacity = capacity;
+    writer->byte_pos = 0;
+    writer->acc = 0;
+    writer->acc_bits = 0;
+    writer->overflow = false;
+}
+
+void bit_writer_put(bit_writer_t* writer, uint32_t value, uint8_t bits) {
+    if (bits == 0) {
+        return;
+    }
+
+    writer->acc = (writer->acc << bits) | (value & ((1UL << bits) - 1));
+    writer->acc_bits += bits;
+
+    // Emit every complete byte
+    while (writer->acc_bits >= 8) {
+        writer->acc_bits -= 8;
+        if (writer->data == nullptr) {
+            // Counting mode: only track the size
+        } else if (writer->byte_pos < writer->capacity) {
+            writer->data[writer->byte_pos] = (uint8_t)(writer->acc >> writer->acc_bits);
+        } else {
+            writer->overflow = true;
+        }
+        writer->byte_pos++;
+    }
+    writer->acc &= (1UL << writer->acc_bits) - 1;
+}
+
+void bit_writer_align(bit_writer_t* writer) {
+    if (writer->acc_bits > 0) {
+        bit_writer_put(writer, 0, 8 - writer->acc_bits);
+    }
+}
+
+size_t bit_writer_bytes(const bit_writer_t* writer) {
+    // Partial trailing byte counts as a full byte
+    return writer->byte_pos + (writer->acc_bits > 0 ? 1 : 0);
+}
+
+// ---------------- Bit reader ----------------
+void bit_reader_init(bit_reader_t* reader, const uint8_t* data, size_t length) {
+    reader->data = data;
+    reader->length = length;
+    reader->byte_pos = 0;
+    reader->acc = 0;
+    reader->acc_bits = 0;
+    reader->overflow = false;
+}
+
+uint32_t bit_reader_get(bit_reader_t* reader, uint8_t bits) {
+    if (bits == 0) {
+        return 0;
+    }
+
+    // Refill until enough bits are buffered
+    while (reader->acc_bits < bits) {
+        uint8_t next = 0;
+        if (reader->byte_pos < reader->length) {
+            next = reader->data[reader->byte_pos];
+        } else {
+            reader->overflow = true;
+        }
+        reader->byte_pos++;
+        reader->acc = (reader->acc << 8) | next;
+        reader->acc_bits += 8;
+    }
+
+    reader->acc_bits -= bits;
+    uint32_t value = (reader->acc >> reader->acc_bits) & ((1UL << bits) - 1);
+    reader->acc &= (1UL << reader->acc_bits) - 1;
+    return value;
+}
+
+void bit_reader_align(bit_reader_t* reader) {
+    // Drop the unread remainder of the current byte
+    reader->acc_bits -= reader->acc_bits % 8;
+    reader->acc &= (1UL << reader->acc_bits) - 1;
+}
+
+size_t bit_reader_bytes(const bit_reader_t* reader) {
+    return reader->byte_pos - reader->acc_bits / 8;
+}
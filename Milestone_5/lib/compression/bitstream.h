@@ -0,0 +1,60 @@
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <cstdint>
+#include <cstddef>
+
+// MSB-first bit writer over a caller-owned byte buffer.
+// Writes past capacity are dropped and flagged in `overflow`.
+// A writer initialised with data == nullptr only counts bits (size trials).
+typedef struct {
+    uint8_t* data;
+    size_t capacity;
+    size_t byte_pos;
+    uint32_t acc;
+    uint8_t acc_bits;
+    bool overflow;
+} bit_writer_t;
+
+// MSB-first bit reader. Reads past the end return zeros and set `overflow`.
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    size_t byte_pos;
+    uint32_t acc;
+    uint8_t acc_bits;
+    bool overflow;
+} bit_reader_t;
+
+// Writer functions (bits must be <= 24 per call)
+void bit_writer_init(bit_writer_t* writer, uint8_t* data, size_t capacity);
+void bit_writer_put(bit_writer_t* writer, uint32_t value, uint8_t bits);
+void bit_writer_align(bit_writer_t* writer);
+size_t bit_writer_bytes(const bit_writer_t* writer);
+
+// Reader functions (bits must be <= 24 per call)
+void bit_reader_init(bit_reader_t* reader, const uint8_t* data, size_t length);
+uint32_t bit_reader_get(bit_reader_t* reader, uint8_t bits);
+void bit_reader_align(bit_reader_t* reader);
+size_t bit_reader_bytes(const bit_reader_t* reader);
+
+// Zigzag mapping of 16-bit signed deltas to unsigned (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...)
+inline uint16_t zigzag_encode16(int16_t value) {
+    return (uint16_t)(((uint16_t)value << 1) ^ (uint16_t)(value >> 15));
+}
+
+inline int16_t zigzag_decode16(uint16_t value) {
+    return (int16_t)((value >> 1) ^ (uint16_t)(-(int16_t)(value & 1)));
+}
+
+// Number of bits needed to represent value (0 for 0)
+inline uint8_t bit_width16(uint16_t value) {
+    uint8_t width = 0;
+    while (value) {
+        width++;
+        value >>= 1;
+    }
+    return width;
+}
+
+#endif // BITSTREAM_H
@@ -0,0 +1,685 @@
+#include "codecs.h"
+#include "entropy_table.h"
+#include <cstring>
+
+// ---------------- Shared helpers ----------------
+// Every codec stores the first value of a column as a plain 16-bit word
+static bool push_first(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    if (encoder->samples > 0) {
+        return false;
+    }
+    bit_writer_put(writer, value, 16);
+    encoder->prev = value;
+    encoder->samples = 1;
+    return true;
+}
+
+// Flush pending zigzag residuals as one block: 5-bit width + packed values
+static void flush_block(column_encoder_t* encoder, bit_writer_t* writer) {
+    if (encoder->block_len == 0) {
+        return;
+    }
+
+    uint16_t block_or = 0;
+    for (uint8_t i = 0; i < encoder->block_len; i++) {
+        block_or |= encoder->block[i];
+    }
+
+    uint8_t width = bit_width16(block_or);
+    bit_writer_put(writer, width, BITPACK_WIDTH_BITS);
+    for (uint8_t i = 0; i < encoder->block_len; i++) {
+        bit_writer_put(writer, encoder->block[i], width);
+    }
+    encoder->block_len = 0;
+}
+
+static void push_residual(column_encoder_t* encoder, bit_writer_t* writer, uint16_t zigzag) {
+    encoder->block[encoder->block_len++] = zigzag;
+    if (encoder->block_len == BITPACK_BLOCK_SIZE) {
+        flush_block(encoder, writer);
+    }
+}
+
+// Read a block width, rejecting anything wider than 16 bits
+static bool read_block_width(bit_reader_t* reader, uint8_t* width) {
+    *width = (uint8_t)bit_reader_get(reader, BITPACK_WIDTH_BITS);
+    return *width <= 16;
+}
+
+// ---------------- Raw ----------------
+static void raw_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    bit_writer_put(writer, value, 16);
+    encoder->samples++;
+}
+
+static void raw_finish(column_encoder_t* encoder, bit_writer_t* writer) {
+    (void)encoder;
+    (void)writer;
+}
+
+static bool raw_decode(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        values[i * stride] = (uint16_t)bit_reader_get(reader, 16);
+    }
+    return true;
+}
+
+// ---------------- Delta + RLE (byte tokens, same layout as compress_raw) ----------------
+static void rle_flush_run(column_encoder_t* encoder, bit_writer_t* writer) {
+    if (encoder->run > 0) {
+        bit_writer_put(writer, 0x00, 8);
+        bit_writer_put(writer, encoder->run, 8);
+        encoder->run = 0;
+    }
+}
+
+// Emit one residual as a byte token; zero residuals extend the pending run
+static void rle_emit(column_encoder_t* encoder, bit_writer_t* writer, uint16_t residual) {
+    if (residual == 0) {
+        encoder->run++;
+        if (encoder->run == 255) {
+            rle_flush_run(encoder, writer);
+        }
+    } else {
+        rle_flush_run(encoder, writer);
+        bit_writer_put(writer, 0x01, 8);
+        bit_writer_put(writer, residual, 16);
+    }
+}
+
+static void rle_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    if (push_first(encoder, writer, value)) {
+        return;
+    }
+
+    uint16_t delta = (uint16_t)(value - encoder->prev);
+    encoder->prev = value;
+    encoder->samples++;
+    rle_emit(encoder, writer, delta);
+}
+
+static void rle_finish(column_encoder_t* encoder, bit_writer_t* writer) {
+    rle_flush_run(encoder, writer);
+}
+
+// Read the count-1 residual tokens into values[1..count-1]
+static bool rle_read_residuals(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    size_t i = 1;
+    while (i < count) {
+        uint8_t token = (uint8_t)bit_reader_get(reader, 8);
+        if (token == 0x00) {
+            uint8_t run = (uint8_t)bit_reader_get(reader, 8);
+            if (run == 0 || i + run > count) {
+                return false;
+            }
+            for (uint8_t r = 0; r < run; r++) {
+                values[(i++) * stride] = 0;
+            }
+        } else if (token == 0x01) {
+            values[(i++) * stride] = (uint16_t)bit_reader_get(reader, 16);
+        } else {
+            return false;
+        }
+        if (reader->overflow) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool rle_decode(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    values[0] = (uint16_t)bit_reader_get(reader, 16);
+    if (!rle_read_residuals(reader, values, stride, count)) {
+        return false;
+    }
+
+    // Integrate deltas in place
+    for (size_t i = 1; i < count; i++) {
+        values[i * stride] = (uint16_t)(values[(i - 1) * stride] + values[i * stride]);
+    }
+    return true;
+}
+
+// ---------------- Zigzag delta, bit-packed blocks ----------------
+static void bitpack_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    if (push_first(encoder, writer, value)) {
+        return;
+    }
+
+    int16_t delta = (int16_t)(value - encoder->prev);
+    encoder->prev = value;
+    encoder->samples++;
+    push_residual(encoder, writer, zigzag_encode16(delta));
+}
+
+static void bitpack_finish(column_encoder_t* encoder, bit_writer_t* writer) {
+    flush_block(encoder, writer);
+}
+
+static bool bitpack_decode(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    uint16_t prev = (uint16_t)bit_reader_get(reader, 16);
+    values[0] = prev;
+
+    for (size_t block_start = 1; block_start < count; block_start += BITPACK_BLOCK_SIZE) {
+        size_t block_end = block_start + BITPACK_BLOCK_SIZE;
+        if (block_end > count) block_end = count;
+
+        uint8_t width;
+        if (!read_block_width(reader, &width)) {
+            return false;
+        }
+        for (size_t i = block_start; i < block_end; i++) {
+            prev = (uint16_t)(prev + zigzag_decode16((uint16_t)bit_reader_get(reader, width)));
+            values[i * stride] = prev;
+        }
+    }
+    return true;
+}
+
+// ---------------- Delta-of-delta, bit-packed blocks ----------------
+// Linear ramps give a constant delta, so the second difference is zero and
+// packs into 5-bit empty blocks. All arithmetic is modulo 2^16, so counter
+// wraparound (65535 -> 0) is just another delta of +1.
+static void dod_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    if (push_first(encoder, writer, value)) {
+        encoder->prev_delta = 0;
+        return;
+    }
+
+    uint16_t delta = (uint16_t)(value - encoder->prev);
+    int16_t dod = (int16_t)(delta - encoder->prev_delta);
+    encoder->prev = value;
+    encoder->prev_delta = delta;
+    encoder->samples++;
+    push_residual(encoder, writer, zigzag_encode16(dod));
+}
+
+static bool dod_decode(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    uint16_t prev = (uint16_t)bit_reader_get(reader, 16);
+    uint16_t prev_delta = 0;
+    values[0] = prev;
+
+    for (size_t block_start = 1; block_start < count; block_start += BITPACK_BLOCK_SIZE) {
+        size_t block_end = block_start + BITPACK_BLOCK_SIZE;
+        if (block_end > count) block_end = count;
+
+        uint8_t width;
+        if (!read_block_width(reader, &width)) {
+            return false;
+        }
+        for (size_t i = block_start; i < block_end; i++) {
+            prev_delta = (uint16_t)(prev_delta + zigzag_decode16((uint16_t)bit_reader_get(reader, width)));
+            prev = (uint16_t)(prev + prev_delta);
+            values[i * stride] = prev;
+        }
+    }
+    return true;
+}
+
+// ---------------- Delta-of-delta + RLE (byte tokens) ----------------
+// Same tokens as Delta+RLE, but over second differences: a counter stepping
+// by a constant amount collapses into 0x00 <run> tokens. Wraparound is
+// handled by the same modulo 2^16 arithmetic as the bit-packed variant.
+static void dod_rle_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    if (push_first(encoder, writer, value)) {
+        encoder->prev_delta = 0;
+        return;
+    }
+
+    uint16_t delta = (uint16_t)(value - encoder->prev);
+    uint16_t dod = (uint16_t)(delta - encoder->prev_delta);
+    encoder->prev = value;
+    encoder->prev_delta = delta;
+    encoder->samples++;
+    rle_emit(encoder, writer, dod);
+}
+
+static bool dod_rle_decode(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    values[0] = (uint16_t)bit_reader_get(reader, 16);
+    if (!rle_read_residuals(reader, values, stride, count)) {
+        return false;
+    }
+
+    // Integrate twice in place: dod -> delta -> value
+    uint16_t delta = 0;
+    for (size_t i = 1; i < count; i++) {
+        delta = (uint16_t)(delta + values[i * stride]);
+        values[i * stride] = (uint16_t)(values[(i - 1) * stride] + delta);
+    }
+    return true;
+}
+
+// ---------------- XOR (Gorilla-style) ----------------
+// '0'                       : value repeats
+// '10' + bits               : XOR fits the previous leading/meaningful window
+// '11' + lead(4) + len-1(4) + bits : new window
+static uint8_t leading_zeros16(uint16_t value) {
+    return (uint8_t)(16 - bit_width16(value));
+}
+
+static uint8_t trailing_zeros16(uint16_t value) {
+    uint8_t count = 0;
+    while (count < 16 && !(value & 1)) {
+        value >>= 1;
+        count++;
+    }
+    return count;
+}
+
+static void xor_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    if (push_first(encoder, writer, value)) {
+        encoder->xor_lead = 0;
+        encoder->xor_len = 0;
+        return;
+    }
+
+    uint16_t x = value ^ encoder->prev;
+    encoder->prev = value;
+    encoder->samples++;
+
+    if (x == 0) {
+        bit_writer_put(writer, 0, 1);
+        return;
+    }
+
+    uint8_t lead = leading_zeros16(x);
+    uint8_t trail = trailing_zeros16(x);
+
+    if (encoder->xor_len > 0 && lead >= encoder->xor_lead &&
+        trail >= 16 - encoder->xor_lead - encoder->xor_len) {
+        // Reuse previous window
+        uint8_t shift = 16 - encoder->xor_lead - encoder->xor_len;
+        bit_writer_put(writer, 0x2, 2);
+        bit_writer_put(writer, x >> shift, encoder->xor_len);
+    } else {
+        uint8_t len = 16 - lead - trail;
+        bit_writer_put(writer, 0x3, 2);
+        bit_writer_put(writer, lead, 4);
+        bit_writer_put(writer, len - 1, 4);
+        bit_writer_put(writer, x >> trail, len);
+        encoder->xor_lead = lead;
+        encoder->xor_len = len;
+    }
+}
+
+static bool xor_decode(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    uint16_t prev = (uint16_t)bit_reader_get(reader, 16);
+    uint8_t lead = 0;
+    uint8_t len = 0;
+    values[0] = prev;
+
+    for (size_t i = 1; i < count; i++) {
+        if (bit_reader_get(reader, 1) != 0) {
+            if (bit_reader_get(reader, 1) != 0) {
+                lead = (uint8_t)bit_reader_get(reader, 4);
+                len = (uint8_t)bit_reader_get(reader, 4) + 1;
+                if (lead + len > 16) {
+                    return false;
+                }
+            } else if (len == 0) {
+                return false; // Window reuse before any window was set
+            }
+            uint8_t shift = 16 - lead - len;
+            prev ^= (uint16_t)(bit_reader_get(reader, len) << shift);
+        }
+        values[i * stride] = prev;
+    }
+    return true;
+}
+
+// ---------------- Swinging door ----------------
+// Only the end points of straight segments are stored; the decoder fills the
+// samples in between by rounded linear interpolation. A segment from the anchor
+// may end at a point only if its slope stays inside the "door" left open by
+// every sample in between (each +/- tolerance), so no sample is reconstructed
+// more than tolerance counts away. With tolerance 0 only exactly collinear
+// samples are dropped and the codec is lossless.
+// Per archived point: exp-Golomb(gap - 1) + exp-Golomb(zigzag value delta).
+static void put_exp_golomb(bit_writer_t* writer, uint32_t value) {
+    uint32_t coded = value + 1;
+    uint8_t bits = 0;
+    while ((coded >> bits) > 1) {
+        bits++;
+    }
+    bit_writer_put(writer, 0, bits);
+    if (bits >= 16) {
+        bit_writer_put(writer, coded >> 16, bits + 1 - 16);
+        bit_writer_put(writer, coded & 0xFFFF, 16);
+    } else {
+        bit_writer_put(writer, coded, bits + 1);
+    }
+}
+
+static bool get_exp_golomb(bit_reader_t* reader, uint32_t* value) {
+    uint8_t bits = 0;
+    while (bit_reader_get(reader, 1) == 0) {
+        if (++bits > 24 || reader->overflow) {
+            return false;
+        }
+    }
+    uint32_t coded = 1;
+    if (bits > 16) {
+        coded = (coded << (bits - 16)) | bit_reader_get(reader, bits - 16);
+        coded = (coded << 16) | bit_reader_get(reader, 16);
+    } else {
+        coded = (coded << bits) | bit_reader_get(reader, bits);
+    }
+    *value = coded - 1;
+    return !reader->overflow;
+}
+
+// a/b < c/d for positive denominators
+static bool slope_less(int32_t a, int32_t b, int32_t c, int32_t d) {
+    return (int64_t)a * d < (int64_t)c * b;
+}
+
+static void door_open(column_encoder_t* encoder) {
+    encoder->up_num = INT32_MAX;
+    encoder->up_den = 1;
+    encoder->low_num = INT32_MIN;
+    encoder->low_den = 1;
+}
+
+static void door_archive(column_encoder_t* encoder, bit_writer_t* writer, size_t index, uint16_t value) {
+    put_exp_golomb(writer, (uint32_t)(index - encoder->anchor_index - 1));
+    put_exp_golomb(writer, zigzag_encode16((int16_t)(uint16_t)(value - encoder->anchor)));
+    encoder->anchor_index = index;
+    encoder->anchor = value;
+    door_open(encoder);
+}
+
+// Narrow the door with a sample that lies strictly inside the current segment
+static void door_narrow(column_encoder_t* encoder, size_t index, uint16_t value) {
+    int32_t den = (int32_t)(index - encoder->anchor_index);
+    int32_t up = (int32_t)value + encoder->tolerance - encoder->anchor;
+    int32_t low = (int32_t)value - encoder->tolerance - encoder->anchor;
+    if (slope_less(up, den, encoder->up_num, encoder->up_den)) {
+        encoder->up_num = up;
+        encoder->up_den = den;
+    }
+    if (slope_less(encoder->low_num, encoder->low_den, low, den)) {
+        encoder->low_num = low;
+        encoder->low_den = den;
+    }
+}
+
+static void door_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    if (push_first(encoder, writer, value)) {
+        encoder->anchor_index = 0;
+        encoder->anchor = value;
+        door_open(encoder);
+        return;
+    }
+
+    size_t index = encoder->samples;
+
+    // With samples between the anchor and here, the segment may only end here
+    // if its slope is still inside the door; otherwise it ends at the previous sample
+    if (index - 1 > encoder->anchor_index) {
+        int32_t den = (int32_t)(index - encoder->anchor_index);
+        int32_t slope = (int32_t)value - encoder->anchor;
+        bool inside = !slope_less(slope, den, encoder->low_num, encoder->low_den) &&
+                      !slope_less(encoder->up_num, encoder->up_den, slope, den);
+        if (!inside) {
+            door_archive(encoder, writer, index - 1, encoder->prev);
+        }
+    }
+
+    // This sample lies between the anchor and every later end point
+    door_narrow(encoder, index, value);
+
+    encoder->prev = value;
+    encoder->samples++;
+}
+
+static void door_finish(column_encoder_t* encoder, bit_writer_t* writer) {
+    size_t last = encoder->samples - 1;
+    if (encoder->samples > 1 && last > encoder->anchor_index) {
+        door_archive(encoder, writer, last, encoder->prev);
+    }
+}
+
+// Rounded a / b (b > 0), half away from zero
+static int32_t div_round(int64_t a, int64_t b) {
+    return (int32_t)(a >= 0 ? (a + b / 2) / b : -((-a + b / 2) / b));
+}
+
+static bool door_decode(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    size_t anchor_index = 0;
+    uint16_t anchor = (uint16_t)bit_reader_get(reader, 16);
+    values[0] = anchor;
+
+    while (anchor_index + 1 < count) {
+        uint32_t gap_minus_one;
+        uint32_t zigzag;
+        if (!get_exp_golomb(reader, &gap_minus_one) || !get_exp_golomb(reader, &zigzag) || zigzag > 0xFFFF) {
+            return false;
+        }
+        size_t gap = (size_t)gap_minus_one + 1;
+        if (anchor_index + gap > count - 1) {
+            return false;
+        }
+
+        uint16_t end = (uint16_t)(anchor + zigzag_decode16((uint16_t)zigzag));
+        int32_t rise = (int32_t)end - anchor;
+        for (size_t k = 1; k < gap; k++) {
+            values[(anchor_index + k) * stride] = (uint16_t)(anchor + div_round((int64_t)rise * k, gap));
+        }
+        anchor_index += gap;
+        anchor = end;
+        values[anchor_index * stride] = end;
+    }
+    return true;
+}
+
+// ---------------- Static Huffman ----------------
+// First-order zigzag deltas coded with the fixed canonical table of
+// entropy_table.h, trained offline from register traces. Codes are at most
+// ENTROPY_MAX_CODE_LEN bits plus at most 15 extra bits, so encoding is one
+// table lookup and decoding at most ENTROPY_MAX_CODE_LEN steps per sample.
+static void huffman_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    if (push_first(encoder, writer, value)) {
+        return;
+    }
+
+    uint16_t zigzag = zigzag_encode16((int16_t)(uint16_t)(value - encoder->prev));
+    encoder->prev = value;
+    encoder->samples++;
+
+    uint8_t symbol = entropy_symbol(zigzag);
+    bit_writer_put(writer, ENTROPY_CODES[symbol], ENTROPY_CODE_LENGTHS[symbol]);
+    if (symbol >= ENTROPY_DIRECT_SYMBOLS) {
+        uint8_t extra = (uint8_t)(bit_width16(zigzag) - 1);
+        bit_writer_put(writer, zigzag & ((1u << extra) - 1), extra);
+    }
+}
+
+// Canonical decoding: codes of one length are consecutive, starting at first
+static bool huffman_read_symbol(bit_reader_t* reader, uint8_t* symbol) {
+    uint32_t code = 0;
+    uint32_t first = 0;
+    size_t index = 0;
+    for (uint8_t len = 1; len <= ENTROPY_MAX_CODE_LEN; len++) {
+        code = (code << 1) | bit_reader_get(reader, 1);
+        uint32_t count = ENTROPY_LENGTH_COUNTS[len];
+        if (code < first + count) {
+            *symbol = ENTROPY_SORTED_SYMBOLS[index + (code - first)];
+            return true;
+        }
+        index += count;
+        first = (first + count) << 1;
+    }
+    return false;
+}
+
+static bool huffman_decode(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    uint16_t prev = (uint16_t)bit_reader_get(reader, 16);
+    values[0] = prev;
+
+    for (size_t i = 1; i < count; i++) {
+        uint8_t symbol;
+        if (!huffman_read_symbol(reader, &symbol) || reader->overflow) {
+            return false;
+        }
+
+        uint16_t zigzag = symbol;
+        if (symbol >= ENTROPY_DIRECT_SYMBOLS) {
+            uint8_t extra = (uint8_t)(symbol - ENTROPY_DIRECT_SYMBOLS + 4);
+            zigzag = (uint16_t)((1u << extra) | bit_reader_get(reader, extra));
+        }
+        prev = (uint16_t)(prev + zigzag_decode16(zigzag));
+        values[i * stride] = prev;
+    }
+    return true;
+}
+
+// ---------------- Sign-sign LMS prediction ----------------
+// Each delta is predicted from the previous LMS_ORDER deltas with adaptive
+// Q12 weights; the prediction residual is bit-packed like Delta+BitPack.
+// After every sample each weight moves LMS_STEP towards sign(error) *
+// sign(history), integer-only, so the decoder replays the same weights.
+// Weights start at zero, so the codec begins as plain delta coding.
+static int16_t lms_predict(const lms_state_t* lms) {
+    int32_t sum = 0;
+    for (uint8_t i = 0; i < LMS_ORDER; i++) {
+        sum += lms->weights[i] * lms->history[i];
+    }
+    sum = (sum + (1 << (LMS_WEIGHT_SHIFT - 1))) >> LMS_WEIGHT_SHIFT;
+    if (sum > INT16_MAX) sum = INT16_MAX;
+    if (sum < INT16_MIN) sum = INT16_MIN;
+    return (int16_t)sum;
+}
+
+static int32_t sign32(int32_t value) {
+    return (value > 0) - (value < 0);
+}
+
+static void lms_update(lms_state_t* lms, int16_t delta, int16_t prediction) {
+    int32_t error_sign = sign32((int32_t)delta - prediction);
+    for (uint8_t i = 0; i < LMS_ORDER; i++) {
+        int32_t weight = lms->weights[i] + LMS_STEP * error_sign * sign32(lms->history[i]);
+        if (weight > LMS_WEIGHT_LIMIT) weight = LMS_WEIGHT_LIMIT;
+        if (weight < -LMS_WEIGHT_LIMIT) weight = -LMS_WEIGHT_LIMIT;
+        lms->weights[i] = weight;
+    }
+    for (uint8_t i = LMS_ORDER - 1; i > 0; i--) {
+        lms->history[i] = lms->history[i - 1];
+    }
+    lms->history[0] = delta;
+}
+
+static void lms_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    if (push_first(encoder, writer, value)) {
+        return;
+    }
+
+    int16_t delta = (int16_t)(value - encoder->prev);
+    int16_t prediction = lms_predict(&encoder->lms);
+    encoder->prev = value;
+    encoder->samples++;
+    push_residual(encoder, writer, zigzag_encode16((int16_t)(uint16_t)(delta - prediction)));
+    lms_update(&encoder->lms, delta, prediction);
+}
+
+static bool lms_decode(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    uint16_t prev = (uint16_t)bit_reader_get(reader, 16);
+    values[0] = prev;
+
+    lms_state_t lms;
+    memset(&lms, 0, sizeof(lms));
+    for (size_t block_start = 1; block_start < count; block_start += BITPACK_BLOCK_SIZE) {
+        size_t block_end = block_start + BITPACK_BLOCK_SIZE;
+        if (block_end > count) block_end = count;
+
+        uint8_t width;
+        if (!read_block_width(reader, &width)) {
+            return false;
+        }
+        for (size_t i = block_start; i < block_end; i++) {
+            int16_t prediction = lms_predict(&lms);
+            int16_t residual = zigzag_decode16((uint16_t)bit_reader_get(reader, width));
+            int16_t delta = (int16_t)(uint16_t)(prediction + residual);
+            lms_update(&lms, delta, prediction);
+            prev = (uint16_t)(prev + delta);
+            values[i * stride] = prev;
+        }
+    }
+    return true;
+}
+
+// ---------------- Registry ----------------
+static const column_codec_t CODEC_REGISTRY[COLUMN_CODEC_COUNT] = {
+    {COLUMN_CODEC_RAW, "Raw", raw_push, raw_finish, raw_decode, true},
+    {COLUMN_CODEC_DELTA_RLE, "Delta+RLE", rle_push, rle_finish, rle_decode, true},
+    {COLUMN_CODEC_BITPACK, "Delta+BitPack", bitpack_push, bitpack_finish, bitpack_decode, true},
+    {COLUMN_CODEC_DELTA_OF_DELTA, "DeltaOfDelta", dod_push, bitpack_finish, dod_decode, true},
+    {COLUMN_CODEC_XOR, "XOR", xor_push, raw_finish, xor_decode, true},
+    {COLUMN_CODEC_DOD_RLE, "DoD+RLE", dod_rle_push, rle_finish, dod_rle_decode, true},
+    {COLUMN_CODEC_SWING_DOOR, "SwingDoor", door_push, door_finish, door_decode, true},
+    // Frames carry no table version: kept out of AUTO until a table trained on recorded traces ships
+    {COLUMN_CODEC_HUFFMAN, "Huffman", huffman_push, raw_finish, huffman_decode, false},
+    {COLUMN_CODEC_LMS, "LMS", lms_push, bitpack_finish, lms_decode, true},
+};
+
+const column_codec_t* column_codec_get(uint8_t codec) {
+    if (codec >= COLUMN_CODEC_COUNT) {
+        return nullptr;
+    }
+    return &CODEC_REGISTRY[codec];
+}
+
+const char* column_codec_name(uint8_t codec) {
+    const column_codec_t* entry = column_codec_get(codec);
+    return entry ? entry->name : "Unknown";
+}
+
+bool column_codec_auto_select(uint8_t codec) {
+    const column_codec_t* entry = column_codec_get(codec);
+    return entry && entry->auto_select;
+}
+
+void column_encoder_init(column_encoder_t* encoder, uint8_t codec, uint16_t tolerance) {
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->codec = codec;
+    encoder->tolerance = tolerance;
+}
+
+void column_encoder_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value) {
+    const column_codec_t* entry = column_codec_get(encoder->codec);
+    if (entry) {
+        entry->push(encoder, writer, value);
+    }
+}
+
+void column_encoder_finish(column_encoder_t* encoder, bit_writer_t* writer) {
+    const column_codec_t* entry = column_codec_get(encoder->codec);
+    if (entry) {
+        entry->finish(encoder, writer);
+    }
+    bit_writer_align(writer);
+}
+
+size_t column_encode(uint8_t codec, const uint16_t* values, size_t stride, size_t count, bit_writer_t* writer,
+                     uint16_t tolerance) {
+    size_t start = bit_writer_bytes(writer);
+
+    column_encoder_t encoder;
+    column_encoder_init(&encoder, codec, tolerance);
+    for (size_t i = 0; i < count; i++) {
+        column_encoder_push(&encoder, writer, values[i * stride]);
+    }
+    column_encoder_finish(&encoder, writer);
+
+    return bit_writer_bytes(writer) - start;
+}
+
+bool column_decode(uint8_t codec, bit_reader_t* reader, uint16_t* values, size_t stride, size_t count) {
+    const column_codec_t* entry = column_codec_get(codec);
+    if (!entry || count == 0) {
+        return false;
+    }
+
+    bool ok = entry->decode(reader, values, stride, count);
+    bit_reader_align(reader);
+    return ok && !reader->overflow;
+}
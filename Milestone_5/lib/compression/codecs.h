@@ -0,0 +1,76 @@
+#ifndef CODECS_H
+#define CODECS_H
+
+#include <cstdint>
+#include <cstddef>
+#include "bitstream.h"
+#include "frame_format.h"
+
+// Per-column codec registry. Every codec encodes one register column
+// incrementally (one value per push) and decodes it back from a bit reader.
+// Portable: no Arduino dependencies.
+
+// Adaptive predictor of the LMS codec, shared by encoder and decoder
+typedef struct {
+    int16_t history[LMS_ORDER];  // Previous deltas, most recent first
+    int32_t weights[LMS_ORDER];  // Q(LMS_WEIGHT_SHIFT)
+} lms_state_t;
+
+// Incremental encoder state for one register column
+typedef struct {
+    uint8_t codec;              // COLUMN_CODEC_* id
+    size_t samples;             // Values pushed so far
+    uint16_t prev;              // Previous value
+    uint16_t prev_delta;        // Previous first-order delta (delta-of-delta)
+    uint16_t run;               // Pending zero-delta run (Delta+RLE)
+    uint16_t block[BITPACK_BLOCK_SIZE]; // Pending zigzag residuals (bit-packed codecs)
+    uint8_t block_len;
+    uint8_t xor_lead;           // Current XOR window (leading zeros, meaningful bits)
+    uint8_t xor_len;
+    uint16_t tolerance;         // Swinging door: max absolute reconstruction error
+    size_t anchor_index;        // Swinging door: last archived point
+    uint16_t anchor;
+    int32_t up_num;             // Swinging door: tightest upper/lower slopes seen from the
+    int32_t up_den;             // anchor, as fractions (den = sample distance)
+    int32_t low_num;
+    int32_t low_den;
+    lms_state_t lms;            // LMS: predictor state
+} column_encoder_t;
+
+// Registry entry
+typedef struct {
+    uint8_t id;
+    const char* name;
+    void (*push)(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value);
+    void (*finish)(column_encoder_t* encoder, bit_writer_t* writer);
+    bool (*decode)(bit_reader_t* reader, uint16_t* values, size_t stride, size_t count);
+    bool auto_select;  // AUTO may pick it for unpinned registers (otherwise pinning only)
+} column_codec_t;
+
+// Huffman alphabet symbol of a zigzag delta (layout in frame_format.h)
+inline uint8_t entropy_symbol(uint16_t zigzag) {
+    if (zigzag < ENTROPY_DIRECT_SYMBOLS) {
+        return (uint8_t)zigzag;
+    }
+    return (uint8_t)(ENTROPY_DIRECT_SYMBOLS + bit_width16(zigzag) - 5);
+}
+
+// Registry lookup (nullptr for unknown ids)
+const column_codec_t* column_codec_get(uint8_t codec);
+const char* column_codec_name(uint8_t codec);
+bool column_codec_auto_select(uint8_t codec);
+
+// Encoder API
+void column_encoder_init(column_encoder_t* encoder, uint8_t codec, uint16_t tolerance = 0);
+void column_encoder_push(column_encoder_t* encoder, bit_writer_t* writer, uint16_t value);
+void column_encoder_finish(column_encoder_t* encoder, bit_writer_t* writer); // Flushes and byte-aligns
+
+// Encode a strided column in one call; returns bytes written (writer may be counting-only).
+// tolerance only affects lossy codecs (swinging door).
+size_t column_encode(uint8_t codec, const uint16_t* values, size_t stride, size_t count, bit_writer_t* writer,
+                     uint16_t tolerance = 0);
+
+// Decode count values into values[i * stride]; consumes a byte-aligned column
+bool column_decode(uint8_t codec, bit_reader_t* reader, uint16_t* values, size_t stride, size_t count);
+
+#endif // CODECS_H
@@ -1,75 +1,370 @@
 #include "compressor.h"
 #include "config.h"  // For READ_REGISTER_COUNT, MEMORY_BUFFER_SIZE
+#include "bitstream.h"
+#include "codecs.h"
+#include "predictor.h"
+
+// Write the 5-byte frame header (count + reg count + size)
+void write_frame_header(uint8_t* output, size_t count, size_t data_len) {
+    output[0] = (uint8_t)((count >> 8) & 0xFF);
+    output[1] = (uint8_t)(count & 0xFF);
+    output[2] = READ_REGISTER_COUNT;
+    output[3] = (uint8_t)((data_len >> 8) & 0xFF);
+    output[4] = (uint8_t)(data_len & 0xFF);
+}
+
+void init_compression_metrics(compression_metrics_t* metrics, uint8_t method_id, const char* name, size_t count) {
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->compression_method = name;
+    metrics->method_id = method_id;
+    metrics->num_samples = count;
+    metrics->original_payload_size = count * READ_REGISTER_COUNT * sizeof(uint16_t);
+}
+
+// Header, final size and ratio once the column data is written
+void finish_compression_metrics(compression_metrics_t* metrics, uint8_t* output, size_t data_len, unsigned long start) {
+    write_frame_header(output, metrics->num_samples, data_len);
+
+    metrics->cpu_time_us += micros() - start;
+    metrics->compressed_payload_size = FRAME_HEADER_SIZE + data_len;
+
+    if (data_len > 0) {
+        metrics->compression_ratio = (float)metrics->original_payload_size / (float)data_len;
+    } else {
+        metrics->compression_ratio = 0.0f;
+    }
+}
+
+// Swinging-door tolerances (raw counts) from the runtime configuration
+static uint16_t register_tolerances[READ_REGISTER_COUNT] = {0};
+
+void compression_set_tolerances(const uint16_t* tolerances) {
+    memcpy(register_tolerances, tolerances, sizeof(register_tolerances));
+}
+
+uint16_t register_tolerance(size_t reg) {
+    return (reg < READ_REGISTER_COUNT) ? register_tolerances[reg] : 0;
+}
+
+bool compression_is_lossy(void) {
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        if (register_tolerances[reg] > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t register_codec_preference(size_t reg) {
+    if (reg >= READ_REGISTER_COUNT) {
+        return COLUMN_CODEC_ANY;
+    }
+    if (register_tolerances[reg] > 0) {
+        return COLUMN_CODEC_SWING_DOOR;
+    }
+    uint8_t codec = pgm_read_byte(&REGISTER_COLUMN_CODECS[reg]);
+    return (codec < COLUMN_CODEC_COUNT) ? codec : COLUMN_CODEC_ANY;
+}
+
+// Prediction needs a scratch column, so it is limited to buffer-sized batches.
+// Predictions are made from exact source values, so lossy frames skip it.
+static bool use_predictor(size_t count) {
+    return PREDICTOR_ENABLED && count <= MAX_BUFFER_SAMPLES && !compression_is_lossy();
+}
+
+// Column handed to the codecs: the register column of the store, or the
+// prediction residuals / quantized values of the register in scratch
+static const uint16_t* codec_input(const sample_store_t* samples, size_t count, size_t reg,
+                                   bool predict, uint8_t shift) {
+    static uint16_t scratch[MAX_BUFFER_SAMPLES];
+
+    const uint16_t* column = sample_store_column(samples, reg);
+    bool predicted = predict && predictor_for(reg);
+    if ((!predicted && shift == 0) || count > MAX_BUFFER_SAMPLES) {
+        return column;
+    }
+
+    if (predicted) {
+        uint16_t row[READ_REGISTER_COUNT];
+        for (size_t i = 0; i < count; i++) {
+            sample_store_get_row(samples, i, row);
+            scratch[i] = (uint16_t)(predictor_residual(row, reg) >> shift);
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            scratch[i] = (uint16_t)(column[i] >> shift);
+        }
+    }
+    return scratch;
+}
+
+// Encode every register with the same column codec
+static compression_metrics_t compress_fixed(uint8_t method_id, uint8_t codec, const sample_store_t* samples,
+                                            size_t count, uint8_t* output, size_t output_capacity, bool predict) {
+    compression_metrics_t metrics;
+    init_compression_metrics(&metrics, method_id, column_codec_name(codec), count);
+    metrics.predicted = predict;
+
+    if (count == 0 || output_capacity < FRAME_HEADER_SIZE) {
+        return metrics;
+    }
+
+    unsigned long start = micros();
+
+    bit_writer_t writer;
+    bit_writer_init(&writer, output + FRAME_HEADER_SIZE, output_capacity - FRAME_HEADER_SIZE);
+
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        const uint16_t* column = codec_input(samples, count, reg, predict, 0);
+        size_t column_len = column_encode(codec, column, 1, count, &writer);
+        metrics.column_codecs[reg] = codec;
+        metrics.codec_sizes[codec] += column_len;
+    }
+
+    if (writer.overflow) {
+        log_error(ERROR_COMPRESSION_FAILED, "Compressed output exceeds buffer");
+        return metrics;
+    }
+
+    finish_compression_metrics(&metrics, output, bit_writer_bytes(&writer), start);
+    return metrics;
+}
 
 // ---------------- Compression: Delta + RLE ----------------
-compression_metrics_t compress_raw(const register_reading_t* buffer, size_t count, uint8_t* output) {
-    compression_metrics_t metrics = {0};
-    metrics.compression_method = "Delta+RLE";
-    metrics.num_samples = count;
-    metrics.original_payload_size = count * READ_REGISTER_COUNT * sizeof(uint16_t);
+// Per register: first absolute value, then 0x00 <run> for zero deltas and
+// 0x01 <int16> for every other delta. Never predicted (legacy layout).
+compression_metrics_t compress_raw(const sample_store_t* samples, size_t count, uint8_t* output) {
+    return compress_fixed(COMPRESSION_METHOD_DELTA_RLE, COLUMN_CODEC_DELTA_RLE, samples, count, output, MAX_COMPRESSION_SIZE, false);
+}
+
+// ---------------- Compression: Zigzag delta, bit-packed blocks ----------------
+// Per register: first absolute value (16 bits), then the deltas in blocks of
+// BITPACK_BLOCK_SIZE. Each block stores a 5-bit width followed by every zigzag
+// delta in that many bits, so a flat block costs 5 bits and a +/-20 count
+// block 6 bits per sample. Each register column is byte aligned.
+compression_metrics_t compress_bitpack(const sample_store_t* samples, size_t count, uint8_t* output, size_t output_capacity) {
+    return compress_fixed(COMPRESSION_METHOD_BITPACK, COLUMN_CODEC_BITPACK, samples, count, output, output_capacity, use_predictor(count));
+}
+
+// ---------------- Compression: per-register codec selection ----------------
+// Smallest codec for one register column (size-only trials); every trial size
+// is added to codec_sizes unless it is nullptr. Registers pinned in REGISTER_COLUMN_CODECS skip the trials;
+// codecs without auto_select are trialled (sizes reported) but never picked.
+static size_t select_column_codec(const sample_store_t* samples, size_t count, size_t reg,
+                                  bool predict, uint8_t shift, uint8_t* best_codec, size_t* codec_sizes) {
+    const uint16_t* column = codec_input(samples, count, reg, predict, shift);
+
+    uint8_t pinned = register_codec_preference(reg);
+    size_t best_len = SIZE_MAX;
+    for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+        if (pinned != COLUMN_CODEC_ANY && codec != pinned) {
+            continue;
+        }
+
+        bit_writer_t counter;
+        bit_writer_init(&counter, nullptr, 0);
+        size_t column_len = column_encode(codec, column, 1, count, &counter, register_tolerance(reg) >> shift);
+
+        if (codec_sizes) {
+            codec_sizes[codec] += column_len;
+        }
+        if (column_len < best_len && (pinned != COLUMN_CODEC_ANY || column_codec_auto_select(codec))) {
+            best_len = column_len;
+            *best_codec = codec;
+        }
+    }
+    return best_len;
+}
+
+// Tag table (+ shift table when quantized) and the winning columns
+static void write_auto_frame(compression_metrics_t* metrics, const sample_store_t* samples, size_t count,
+                             uint8_t* output, size_t output_capacity, unsigned long start) {
+    bit_writer_t writer;
+    bit_writer_init(&writer, output + FRAME_HEADER_SIZE, output_capacity - FRAME_HEADER_SIZE);
+
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        bit_writer_put(&writer, metrics->column_codecs[reg], 4);
+    }
+    bit_writer_align(&writer);
+
+    if (metrics->quantized) {
+        for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+            bit_writer_put(&writer, metrics->quant_shifts[reg], QUANT_SHIFT_BITS);
+        }
+        bit_writer_align(&writer);
+    }
+
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        const uint16_t* column = codec_input(samples, count, reg, metrics->predicted, metrics->quant_shifts[reg]);
+        column_encode(metrics->column_codecs[reg], column, 1, count, &writer,
+                      register_tolerance(reg) >> metrics->quant_shifts[reg]);
+    }
+
+    if (writer.overflow) {
+        log_error(ERROR_COMPRESSION_FAILED, "Compressed output exceeds buffer");
+        return;
+    }
+
+    finish_compression_metrics(metrics, output, bit_writer_bytes(&writer), start);
+}
+
+// Every column is trial-encoded with each registered codec, the smallest wins
+// and its id is written to the nibble tag table in front of the columns.
+// Registers with a tolerance always use the (lossy) swinging-door codec.
+compression_metrics_t compress_auto(const sample_store_t* samples, size_t count, uint8_t* output, size_t output_capacity) {
+    compression_metrics_t metrics;
+    init_compression_metrics(&metrics, COMPRESSION_METHOD_AUTO, "Auto", count);
+    metrics.predicted = use_predictor(count);
+
+    if (count == 0 || output_capacity < FRAME_HEADER_SIZE) {
+        return metrics;
+    }
 
     unsigned long start = micros();
 
-    uint8_t temp[MAX_COMPRESSION_SIZE];
-    size_t temp_index = 0;
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        select_column_codec(samples, count, reg, metrics.predicted, 0, &metrics.column_codecs[reg], metrics.codec_sizes);
+    }
+
+    write_auto_frame(&metrics, samples, count, output, output_capacity, start);
+    return metrics;
+}
 
-    // Compress each register independently
+// ---------------- Compression: bounded output ----------------
+// AUTO frame that fits in budget bytes (header included). While it does not,
+// one more low bit is dropped from the register with the lowest
+// importance + current shift (ties: the largest, i.e. noisiest, column), up to
+// its REGISTER_MAX_QUANT_SHIFT. Quantized frames carry a 4-bit shift per
+// register and are not predicted. Returns an empty result if nothing fits.
+compression_metrics_t compress_bounded(const sample_store_t* samples, size_t count, uint8_t* output,
+                                       size_t output_capacity, size_t budget) {
+    compression_metrics_t metrics = compress_auto(samples, count, output, output_capacity);
+    if (metrics.compressed_payload_size >= FRAME_HEADER_SIZE && metrics.compressed_payload_size <= budget) {
+        return metrics;
+    }
+    unsigned long elapsed = metrics.cpu_time_us;
+
+    init_compression_metrics(&metrics, COMPRESSION_METHOD_AUTO, "Auto (bounded)", count);
+    metrics.quantized = true;
+    metrics.cpu_time_us = elapsed;
+
+    if (count == 0 || count > MAX_BUFFER_SAMPLES || output_capacity < FRAME_HEADER_SIZE) {
+        return metrics;
+    }
+
+    unsigned long start = micros();
+
+    const size_t table_bytes = (READ_REGISTER_COUNT * 4 + 7) / 8 + (READ_REGISTER_COUNT * QUANT_SHIFT_BITS + 7) / 8;
+    size_t column_sizes[READ_REGISTER_COUNT];
     for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
-        uint16_t prev_val = buffer[0].values[reg];
-        // Store first absolute value (no flag)
-        temp[temp_index++] = (uint8_t)(prev_val >> 8);
-        temp[temp_index++] = (uint8_t)(prev_val & 0xFF);
-
-        size_t run = 0;
-        for (size_t i = 1; i < count; i++) {
-            int16_t delta = (int16_t)(buffer[i].values[reg] - prev_val);
-            prev_val = buffer[i].values[reg];
-
-            if (delta == 0) {
-                run++;
-                if (run == 255) {
-                    temp[temp_index++] = 0x00;
-                    temp[temp_index++] = (uint8_t)run;
-                    run = 0;
-                }
-            } else {
-                if (run > 0) {
-                    // Flush run
-                    temp[temp_index++] = 0x00;
-                    temp[temp_index++] = (uint8_t)run;
-                    run = 0;
-                }
-                // Write delta
-                temp[temp_index++] = 0x01;
-                temp[temp_index++] = (uint8_t)(delta >> 8);
-                temp[temp_index++] = (uint8_t)(delta & 0xFF);
+        column_sizes[reg] = select_column_codec(samples, count, reg, false, 0, &metrics.column_codecs[reg], nullptr);
+    }
+
+    while (true) {
+        size_t total = FRAME_HEADER_SIZE + table_bytes;
+        for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+            total += column_sizes[reg];
+        }
+        if (total <= budget) {
+            break;
+        }
+
+        // Next register to lose a bit
+        size_t victim = READ_REGISTER_COUNT;
+        uint16_t victim_rank = UINT16_MAX;
+        for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+            if (metrics.quant_shifts[reg] >= pgm_read_byte(&REGISTER_MAX_QUANT_SHIFT[reg])) {
+                continue;
+            }
+            uint16_t rank = pgm_read_byte(&REGISTER_QUANT_IMPORTANCE[reg]) + metrics.quant_shifts[reg];
+            if (rank < victim_rank || (rank == victim_rank && column_sizes[reg] > column_sizes[victim])) {
+                victim = reg;
+                victim_rank = rank;
             }
         }
+        if (victim == READ_REGISTER_COUNT) {
+            log_error(ERROR_COMPRESSION_FAILED, "Bounded compression cannot meet budget");
+            return metrics;
+        }
+
+        metrics.quant_shifts[victim]++;
+        column_sizes[victim] = select_column_codec(samples, count, victim, false, metrics.quant_shifts[victim],
+                                                   &metrics.column_codecs[victim], nullptr);
+    }
 
-        // Flush remaining run if any
-        if (run > 0) {
-            temp[temp_index++] = 0x00;
-            temp[temp_index++] = (uint8_t)run;
+    // Report the trial sizes of the final columns
+    metrics.quantized = false;
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        select_column_codec(samples, count, reg, false, metrics.quant_shifts[reg], &metrics.column_codecs[reg], metrics.codec_sizes);
+        if (metrics.quant_shifts[reg] > 0) {
+            metrics.quantized = true;
         }
     }
 
-    // Header (5 bytes: count + reg count + size)
-    output[0] = (uint8_t)((count >> 8) & 0xFF);
-    output[1] = (uint8_t)(count & 0xFF);
-    output[2] = READ_REGISTER_COUNT;
-    output[3] = (uint8_t)((temp_index >> 8) & 0xFF);
-    output[4] = (uint8_t)(temp_index & 0xFF);
+    write_auto_frame(&metrics, samples, count, output, output_capacity, start);
+    return metrics;
+}
 
-    memcpy(output + 5, temp, temp_index);
+// Dispatch to the selected compression method
+compression_metrics_t compress_buffer(uint8_t method, const sample_store_t* samples, size_t count, uint8_t* output, size_t output_capacity) {
+    switch (method) {
+        case COMPRESSION_METHOD_AUTO:
+            return compress_auto(samples, count, output, output_capacity);
+        case COMPRESSION_METHOD_BITPACK:
+            return compress_bitpack(samples, count, output, output_capacity);
+        case COMPRESSION_METHOD_DELTA_RLE:
+        default:
+            return compress_fixed(COMPRESSION_METHOD_DELTA_RLE, COLUMN_CODEC_DELTA_RLE, samples, count, output, output_capacity, use_predictor(count));
+    }
+}
 
-    metrics.cpu_time_us = micros() - start;
+// Print the per-codec trial sizes and the winner of every register
+void print_compression_metrics(const compression_metrics_t* metrics) {
+    Serial.print(F("[COMPRESSION] Method: "));
+    Serial.print(metrics->compression_method);
+    Serial.print(F(", Samples: "));
+    Serial.print(metrics->num_samples);
+    Serial.print(F(", Size: "));
+    Serial.print(metrics->compressed_payload_size);
+    Serial.print(F("/"));
+    Serial.println(metrics->original_payload_size);
 
-    metrics.compressed_payload_size = 5 + temp_index;
+    if (metrics->num_samples > 0) {
+        Serial.print(F("[COMPRESSION] Per sample: "));
+        Serial.print((float)metrics->compressed_payload_size / metrics->num_samples);
+        Serial.print(F(" bytes, "));
+        Serial.print((float)metrics->cpu_time_us / metrics->num_samples);
+        Serial.print(F(" us, Ratio: "));
+        Serial.println(metrics->compression_ratio);
+    }
 
-    if (metrics.compressed_payload_size > 0) {
-        metrics.compression_ratio = (float)metrics.original_payload_size / (float)(metrics.compressed_payload_size - 5);
-    } else {
-        metrics.compression_ratio = 0.0f;
+    Serial.print(F("[COMPRESSION] Codec sizes:"));
+    for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+        if (metrics->codec_sizes[codec] == 0) continue;
+        Serial.print(F(" "));
+        Serial.print(column_codec_name(codec));
+        Serial.print(F("="));
+        Serial.print(metrics->codec_sizes[codec]);
     }
-    return metrics;
-}
\ No newline at end of file
+    Serial.println();
+
+    Serial.print(F("[COMPRESSION] Column codecs:"));
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        Serial.print(F(" R"));
+        Serial.print(reg);
+        Serial.print(F("="));
+        Serial.print(column_codec_name(metrics->column_codecs[reg]));
+    }
+    Serial.println();
+
+    if (metrics->quantized) {
+        Serial.print(F("[COMPRESSION] Dropped bits:"));
+        for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+            Serial.print(F(" R"));
+            Serial.print(reg);
+            Serial.print(F("="));
+            Serial.print(metrics->quant_shifts[reg]);
+        }
+        Serial.println();
+    }
+}
@@ -2,20 +2,48 @@
 #define COMPRESSOR_H
 #include <Arduino.h>
 #include "scheduler.h"  // Include your register_reading_t and buffers
+#include "sample_store.h"  // Column-major sample buffers
 #include "error_handler.h"  // For log_error
+#include "frame_format.h"  // Compression method ids and frame flags
 
 // Compression metrics structure for benchmark reporting
 typedef struct {
     const char* compression_method;
+    uint8_t method_id;  // COMPRESSION_METHOD_* tag written into the frame flags
+    bool predicted;     // Predicted registers were encoded as residuals (FRAME_FLAG_PREDICTED)
+    bool quantized;     // Low bits dropped per quant_shifts (FRAME_FLAG_QUANTIZED)
+    uint8_t quant_shifts[READ_REGISTER_COUNT];   // Low bits dropped per register
     size_t num_samples;
     size_t original_payload_size;
     size_t compressed_payload_size;
     float compression_ratio;
     unsigned long cpu_time_us;
+    uint8_t column_codecs[READ_REGISTER_COUNT];  // COLUMN_CODEC_* used for each register
+    size_t codec_sizes[COLUMN_CODEC_COUNT];      // Total column bytes per codec (trial sizes in AUTO)
 } compression_metrics_t;
 
 
 // Compression functions
-compression_metrics_t compress_raw(const register_reading_t* buffer, size_t count, uint8_t* output);
+compression_metrics_t compress_raw(const sample_store_t* samples, size_t count, uint8_t* output);
+compression_metrics_t compress_bitpack(const sample_store_t* samples, size_t count, uint8_t* output, size_t output_capacity);
+compression_metrics_t compress_auto(const sample_store_t* samples, size_t count, uint8_t* output, size_t output_capacity);
+compression_metrics_t compress_bounded(const sample_store_t* samples, size_t count, uint8_t* output, size_t output_capacity, size_t budget);
+compression_metrics_t compress_buffer(uint8_t method, const sample_store_t* samples, size_t count, uint8_t* output, size_t output_capacity);
+
+// Frame building helpers shared with the streaming encoder
+void write_frame_header(uint8_t* output, size_t count, size_t data_len);
+void init_compression_metrics(compression_metrics_t* metrics, uint8_t method_id, const char* name, size_t count);
+void finish_compression_metrics(compression_metrics_t* metrics, uint8_t* output, size_t data_len, unsigned long start);
+
+// Codec pinned for a register in AUTO frames, or COLUMN_CODEC_ANY
+uint8_t register_codec_preference(size_t reg);
+
+// Per-register swinging-door tolerances (raw counts, 0 = lossless), AUTO frames only
+void compression_set_tolerances(const uint16_t* tolerances);
+uint16_t register_tolerance(size_t reg);
+bool compression_is_lossy(void);
+
+// Metrics reporting
+void print_compression_metrics(const compression_metrics_t* metrics);
 
 #endif // COMPRESSOR_H
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "decompressor.h"
+#include "bitstream.h"
+#include "codecs.h"
+#include "predictor.h"
+#include "calculateCRC.h"
+#include <cstring>
+
+// Parse and validate the 5-byte header shared by all methods
+static bool read_frame_header(const uint8_t* frame, size_t frame_len, size_t max_values,
+                              size_t* sample_count, uint8_t* register_count, size_t* data_len) {
+    if (frame_len < FRAME_HEADER_SIZE) {
+        return false;
+    }
+
+    *sample_count = ((size_t)frame[0] << 8) | frame[1];
+    *register_count = frame[2];
+    *data_len = ((size_t)frame[3] << 8) | frame[4];
+
+    if (*sample_count == 0 || *register_count == 0 || *sample_count * *register_count > max_values) {
+        return false;
+    }
+    return FRAME_HEADER_SIZE + *data_len <= frame_len;
+}
+
+// Decode the payload; quantized columns are scaled back to the middle of their step
+static bool decode_payload(uint8_t method, uint8_t flags, const uint8_t* frame, size_t frame_len,
+                           uint16_t* values, size_t max_values,
+                           size_t* sample_count, uint8_t* register_count) {
+    size_t count = 0;
+    uint8_t regs = 0;
+    size_t data_len = 0;
+    if (!read_frame_header(frame, frame_len, max_values, &count, &regs, &data_len)) {
+        return false;
+    }
+
+    bit_reader_t reader;
+    bit_reader_init(&reader, frame + FRAME_HEADER_SIZE, data_len);
+
+    // Resolve the codec of every column
+    uint8_t codecs[256];
+    switch (method) {
+        case COMPRESSION_METHOD_DELTA_RLE:
+            memset(codecs, COLUMN_CODEC_DELTA_RLE, regs);
+            break;
+        case COMPRESSION_METHOD_BITPACK:
+            memset(codecs, COLUMN_CODEC_BITPACK, regs);
+            break;
+        case COMPRESSION_METHOD_AUTO:
+            for (size_t reg = 0; reg < regs; reg++) {
+                codecs[reg] = (uint8_t)bit_reader_get(&reader, 4);
+            }
+            bit_reader_align(&reader);
+            break;
+        default:
+            return false;
+    }
+
+    uint8_t shifts[256];
+    memset(shifts, 0, regs);
+    if (flags & FRAME_FLAG_QUANTIZED) {
+        if (method != COMPRESSION_METHOD_AUTO) {
+            return false;
+        }
+        for (size_t reg = 0; reg < regs; reg++) {
+            shifts[reg] = (uint8_t)bit_reader_get(&reader, QUANT_SHIFT_BITS);
+        }
+        bit_reader_align(&reader);
+    }
+
+    for (size_t reg = 0; reg < regs; reg++) {
+        if (!column_decode(codecs[reg], &reader, values + reg, regs, count)) {
+            return false;
+        }
+        if (shifts[reg] > 0) {
+            uint16_t half_step = (uint16_t)(1u << (shifts[reg] - 1));
+            for (size_t i = 0; i < count; i++) {
+                uint16_t* value = &values[i * regs + reg];
+                *value = (uint16_t)((*value << shifts[reg]) | half_step);
+            }
+        }
+    }
+
+    *sample_count = count;
+    *register_count = regs;
+    return true;
+}
+
+bool decompress_payload(uint8_t method, const uint8_t* frame, size_t frame_len,
+                        uint16_t* values, size_t max_values,
+                        size_t* sample_count, uint8_t* register_count) {
+    return decode_payload(method, 0, frame, frame_len, values, max_values, sample_count, register_count);
+}
+
+bool decompress_bitpack(const uint8_t* frame, size_t frame_len,
+                        uint16_t* values, size_t max_values,
+                        size_t* sample_count, uint8_t* register_count) {
+    return decompress_payload(COMPRESSION_METHOD_BITPACK, frame, frame_len, values, max_values, sample_count, register_count);
+}
+
+bool decompress_frame(const uint8_t* frame, size_t frame_len,
+                      uint16_t* values, size_t max_values,
+                      size_t* sample_count, uint8_t* register_count) {
+    if (frame_len < 1) {
+        return false;
+    }
+
+    size_t prefix_len = (frame[0] & FRAME_FLAG_AGGREGATED) ? 2 : 1;
+    if (frame_len < prefix_len) {
+        return false;
+    }
+
+    uint8_t method = frame[0] >> FRAME_METHOD_SHIFT;
+    if (!decode_payload(method, frame[0], frame + prefix_len, frame_len - prefix_len, values, max_values, sample_count, register_count)) {
+        return false;
+    }
+
+    if (frame[0] & FRAME_FLAG_PREDICTED) {
+        for (size_t i = 0; i < *sample_count; i++) {
+            predictor_restore_row(values + i * *register_count, *register_count);
+        }
+    }
+    return true;
+}
+
+size_t frame_aggregation_window(const uint8_t* frame, size_t frame_len) {
+    if (frame_len < 2 || !(frame[0] & FRAME_FLAG_AGGREGATED)) {
+        return 0;
+    }
+    return frame[1];
+}
+
+const uint8_t* frame_trailer(const uint8_t* frame, size_t frame_len, size_t* trailer_len) {
+    if (frame_len < 1 || !(frame[0] & FRAME_FLAG_TRAILER)) {
+        return nullptr;
+    }
+    size_t payload_start = (frame[0] & FRAME_FLAG_AGGREGATED) ? 2 : 1;
+    if (frame_len < payload_start + FRAME_HEADER_SIZE) {
+        return nullptr;
+    }
+    const uint8_t* payload = frame + payload_start;
+    size_t payload_len = FRAME_HEADER_SIZE + (((size_t)payload[3] << 8) | payload[4]);
+    if (payload_start + payload_len > frame_len) {
+        return nullptr;
+    }
+    *trailer_len = frame_len - payload_start - payload_len;
+    return payload + payload_len;
+}
+
+const uint8_t* frame_tlv_find(const uint8_t* trailer, size_t trailer_len, uint8_t type, size_t* value_len) {
+    size_t pos = 0;
+    while (pos + 2 <= trailer_len) {
+        size_t length = trailer[pos + 1];
+        if (pos + 2 + length > trailer_len) {
+            return nullptr;
+        }
+        if (trailer[pos] == type) {
+            *value_len = length;
+            return trailer + pos + 2;
+        }
+        pos += 2 + length;
+    }
+    return nullptr;
+}
+
+bool decompress_upload_frame(const uint8_t* frame, size_t frame_len,
+                             uint16_t* values, size_t max_values,
+                             size_t* sample_count, uint8_t* register_count) {
+    if (frame_len < 3) {
+        return false;
+    }
+
+    size_t data_len = frame_len - 2;
+    uint16_t crc = (uint16_t)(frame[data_len] | (frame[data_len + 1] << 8));
+    if (calculateCRC(frame, (int)data_len) != crc) {
+        return false;
+    }
+    return decompress_frame(frame, data_len, values, max_values, sample_count, register_count);
+}
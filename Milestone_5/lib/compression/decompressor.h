@@ -0,0 +1,50 @@
+#ifndef DECOMPRESSOR_H
+#define DECOMPRESSOR_H
+
+#include <cstdint>
+#include <cstddef>
+#include "frame_format.h"
+
+// Decoders for the compressed payload produced by compressor.cpp.
+// Portable (no Arduino dependencies) so they can also be built on a host:
+//   g++ -std=c++11 -Ilib/compression -Ilib/calculateCRC
+//       lib/compression/{decompressor,codecs,bitstream,predictor}.cpp
+//       lib/calculateCRC/calculateCRC.cpp <decoder main>.cpp
+//
+// frame: compressed payload starting at the 5-byte header (flags byte excluded,
+//        so prediction residuals are returned as is)
+// values: output, row-major [sample][register], capacity of max_values entries
+// Returns false on truncated or inconsistent input.
+
+bool decompress_payload(uint8_t method, const uint8_t* frame, size_t frame_len,
+                        uint16_t* values, size_t max_values,
+                        size_t* sample_count, uint8_t* register_count);
+
+// Full upload frame including the leading flags byte; method, prediction and
+// quantization are taken from the flags. Quantized registers come back at the
+// middle of their quantization step. Aggregated frames return their stat-major
+// window rows (see frame_format.h).
+bool decompress_frame(const uint8_t* frame, size_t frame_len,
+                      uint16_t* values, size_t max_values,
+                      size_t* sample_count, uint8_t* register_count);
+
+// Window size in samples of an aggregated frame, 0 if the frame is not aggregated
+size_t frame_aggregation_window(const uint8_t* frame, size_t frame_len);
+
+// TLV trailer of a FRAME_FLAG_TRAILER frame; nullptr if there is none
+const uint8_t* frame_trailer(const uint8_t* frame, size_t frame_len, size_t* trailer_len);
+
+// Value of the first trailer record of the given type; nullptr if absent or malformed
+const uint8_t* frame_tlv_find(const uint8_t* trailer, size_t trailer_len, uint8_t type, size_t* value_len);
+
+bool decompress_bitpack(const uint8_t* frame, size_t frame_len,
+                        uint16_t* values, size_t max_values,
+                        size_t* sample_count, uint8_t* register_count);
+
+// Decrypted upload frame as sent to the cloud: [flags][payload][CRC-16 LE].
+// Rejects the frame when the Modbus CRC-16 does not match.
+bool decompress_upload_frame(const uint8_t* frame, size_t frame_len,
+                             uint16_t* values, size_t max_values,
+                             size_t* sample_count, uint8_t* register_count);
+
+#endif // DECOMPRESSOR_H
@@ -0,0 +1,45 @@
+#include "downsampler.h"
+#include "config.h"  // For READ_REGISTER_COUNT
+
+size_t downsample_window_count(size_t count, size_t window) {
+    if (window == 0) {
+        return 0;
+    }
+    return (count + window - 1) / window;
+}
+
+size_t downsample_min_max_mean_last(const sample_store_t* samples, size_t count, size_t window,
+                                    sample_store_t* out) {
+    size_t windows = downsample_window_count(count, window);
+    size_t rows = windows * AGG_STAT_COUNT;
+    if (windows == 0 || rows > out->capacity) {
+        return 0;
+    }
+
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        const uint16_t* column = sample_store_column(samples, reg);
+        uint16_t* stats = sample_store_column(out, reg);
+
+        for (size_t w = 0; w < windows; w++) {
+            size_t first = w * window;
+            size_t end = (first + window < count) ? first + window : count;
+            size_t actual = end - first;
+
+            uint16_t min_val = column[first];
+            uint16_t max_val = min_val;
+            uint32_t sum = 0;
+            for (size_t j = first; j < end; j++) {
+                uint16_t v = column[j];
+                if (v < min_val) min_val = v;
+                if (v > max_val) max_val = v;
+                sum += v;
+            }
+
+            stats[AGG_STAT_MIN * windows + w] = min_val;
+            stats[AGG_STAT_MAX * windows + w] = max_val;
+            stats[AGG_STAT_MEAN * windows + w] = (uint16_t)((sum + actual / 2) / actual);
+            stats[AGG_STAT_LAST * windows + w] = column[end - 1];
+        }
+    }
+    return rows;
+}
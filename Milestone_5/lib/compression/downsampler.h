@@ -0,0 +1,20 @@
+#ifndef DOWNSAMPLER_H
+#define DOWNSAMPLER_H
+
+#include <Arduino.h>
+#include "sample_store.h"  // Column-major sample buffers
+#include "frame_format.h"  // AGG_STAT_* row blocks
+
+// Peak-preserving downsampling for aggregated frames. Every window of
+// `window` samples is reduced to its min, max, mean and last value per
+// register, so power peaks survive aggregation.
+
+// Windows needed for count samples
+size_t downsample_window_count(size_t count, size_t window);
+
+// Writes AGG_STAT_COUNT * windows rows to out in the stat-major order of
+// frame_format.h. Returns the number of rows, 0 if out is too small.
+size_t downsample_min_max_mean_last(const sample_store_t* samples, size_t count, size_t window,
+                                    sample_store_t* out);
+
+#endif // DOWNSAMPLER_H
@@ -0,0 +1,29 @@
+#ifndef ENTROPY_TABLE_H
+#define ENTROPY_TABLE_H
+
+#include <cstdint>
+#include "frame_format.h"
+
+// Generated by tools/entropy_train.cpp from 89970 deltas - do not edit.
+// Part of the frame format: replacing it breaks decoding of older frames, so a retrained
+// table ships under a new codec id (see tools/entropy_train.cpp).
+
+static const uint16_t ENTROPY_CODES[ENTROPY_SYMBOLS] = {
+    0, 2, 3, 8, 9, 24, 25, 26, 27, 58, 59, 60, 61, 124,
+    125, 254, 10, 11, 28, 126, 510, 2044, 4090, 4091, 4092, 4093, 4094, 4095
+};
+static const uint8_t ENTROPY_CODE_LENGTHS[ENTROPY_SYMBOLS] = {
+    2, 3, 3, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7,
+    7, 8, 4, 4, 5, 7, 9, 11, 12, 12, 12, 12, 12, 12
+};
+
+// Canonical decoding: number of codes of every length, symbols in code order
+static const uint8_t ENTROPY_LENGTH_COUNTS[ENTROPY_MAX_CODE_LEN + 1] = {
+    0, 0, 1, 2, 4, 5, 4, 3, 1, 1, 0, 1, 6
+};
+static const uint8_t ENTROPY_SORTED_SYMBOLS[ENTROPY_SYMBOLS] = {
+    0, 1, 2, 3, 4, 16, 17, 5, 6, 7, 8, 18, 9, 10,
+    11, 12, 13, 14, 19, 15, 20, 21, 22, 23, 24, 25, 26, 27
+};
+
+#endif // ENTROPY_TABLE_H
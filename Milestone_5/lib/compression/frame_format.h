@@ -0,0 +1,100 @@
+#ifndef FRAME_FORMAT_H
+#define FRAME_FORMAT_H
+
+#include <cstdint>
+
+// Shared definitions of the compressed upload frame. Kept free of Arduino
+// dependencies so the same constants can be used by host-side decoders.
+//
+// Upload frame layout:
+//   [flags(1)] [count(2)] [register count(1)] [data size(2)] [data(n)]
+//
+// flags: low nibble carries frame flags, high nibble the compression method.
+//
+// Fixed methods store the register columns back to back in data.
+// COMPRESSION_METHOD_AUTO prefixes data with one 4-bit column codec tag per
+// register (high nibble first, padded to a byte), followed by the columns.
+// With FRAME_FLAG_QUANTIZED (AUTO only) a second nibble table holds the
+// number of low bits dropped from each register before the columns.
+// Every column is byte aligned.
+//
+// FRAME_FLAG_AGGREGATED frames carry one extra byte after the flags, the
+// window size in samples: [flags(1)] [window(1)] [payload]. The payload rows
+// are stat-major: AGG_STAT_COUNT blocks of count / AGG_STAT_COUNT window rows,
+// in AGG_STAT_* order. The last window may cover fewer samples.
+//
+// FRAME_FLAG_TRAILER frames append TLV records after the payload (whose
+// length is FRAME_HEADER_SIZE + data size): [type(1)] [length(1)] [value],
+// repeated to the end of the frame. Decoders skip unknown types.
+
+// Compression method identifiers (high nibble of the frame flags byte)
+#define COMPRESSION_METHOD_DELTA_RLE 0  // Absolute value + 0x00 run / 0x01 int16 delta tokens
+#define COMPRESSION_METHOD_BITPACK 1    // Zigzag deltas, frame-of-reference bit-packed blocks
+#define COMPRESSION_METHOD_AUTO 2       // Smallest column codec chosen per register
+
+// Column codec identifiers (4-bit tags in AUTO frames, see codecs.h)
+#define COLUMN_CODEC_RAW 0
+#define COLUMN_CODEC_DELTA_RLE 1
+#define COLUMN_CODEC_BITPACK 2
+#define COLUMN_CODEC_DELTA_OF_DELTA 3
+#define COLUMN_CODEC_XOR 4
+#define COLUMN_CODEC_DOD_RLE 5
+#define COLUMN_CODEC_SWING_DOOR 6  // Lossy when the register has a tolerance (exact at 0)
+#define COLUMN_CODEC_HUFFMAN 7     // Static-table Huffman over zigzag deltas (entropy_table.h);
+                                   // pinned registers only, AUTO does not pick it
+#define COLUMN_CODEC_LMS 8         // Sign-sign LMS prediction of deltas, bit-packed residuals
+#define COLUMN_CODEC_COUNT 9
+#define COLUMN_CODEC_ANY 0xFF  // Register preference only (never on the wire): let AUTO pick
+
+// Frame flags (low nibble of the frame flags byte)
+#define FRAME_FLAG_AGGREGATED 0x01
+#define FRAME_FLAG_PREDICTED 0x02  // Predicted registers carry residuals (see predictor.h)
+#define FRAME_FLAG_QUANTIZED 0x04  // Per-register quantization shift table present
+#define FRAME_FLAG_TRAILER 0x08    // TLV records follow the payload
+#define FRAME_METHOD_SHIFT 4
+
+// Compressed payload header: count(2) + register count(1) + data size(2)
+#define FRAME_HEADER_SIZE 5
+
+// Trailer records (FRAME_FLAG_TRAILER)
+#define FRAME_TRAILER_MAX 128       // Trailer bytes a frame may carry
+#define FRAME_TLV_TASK_TIMING 0x01  // Scheduler timing since the previous frame (timing_stats.h)
+#define FRAME_TLV_SAMPLE_TIMES 0x02 // Time of every raw sample in the batch (sample_times.h);
+                                    // aggregated row k covers samples [k * window, (k + 1) * window)
+#define FRAME_TLV_SAMPLING 0x03     // Effective read interval of the batch (adaptive_sampler.h)
+#define FRAME_TLV_ALARM 0x04        // Alarm rules fired by the frame's single sample (alarm_rules.h)
+#define FRAME_TLV_CAPTURE 0x05      // Part of an event capture (lossless samples around an alarm):
+                                    // [capture id] [part] [flags: bit0 last part] [first sample varint]
+                                    // [trigger sample varint] [fired rules varint]; sample indexes
+                                    // count from the start of the whole capture
+
+// Bit-packed codec: deltas are packed in blocks of this many samples, each
+// prefixed by a 5-bit width (0..16 bits per zigzag delta)
+#define BITPACK_BLOCK_SIZE 16
+#define BITPACK_WIDTH_BITS 5
+
+// Per-window statistics of aggregated frames, in row block order
+#define AGG_STAT_MIN 0
+#define AGG_STAT_MAX 1
+#define AGG_STAT_MEAN 2  // Rounded to nearest
+#define AGG_STAT_LAST 3
+#define AGG_STAT_COUNT 4
+
+// Huffman codec alphabet: zigzag deltas below ENTROPY_DIRECT_SYMBOLS are their
+// own symbol; larger ones use the symbol of their bit width (5..16) followed
+// by the width - 1 bits below the leading one
+#define ENTROPY_DIRECT_SYMBOLS 16
+#define ENTROPY_SYMBOLS (ENTROPY_DIRECT_SYMBOLS + 12)
+#define ENTROPY_MAX_CODE_LEN 12
+
+// LMS codec: order, fixed-point weight scale (Q12) and sign-sign update step.
+// Weights start at zero (plain delta) and are clamped to +/-LMS_WEIGHT_LIMIT.
+#define LMS_ORDER 4
+#define LMS_WEIGHT_SHIFT 12
+#define LMS_STEP 128
+#define LMS_WEIGHT_LIMIT (2 << LMS_WEIGHT_SHIFT)
+
+// Quantization shift per register in FRAME_FLAG_QUANTIZED frames
+#define QUANT_SHIFT_BITS 4
+
+#endif // FRAME_FORMAT_H
@@ -0,0 +1,43 @@
+#include "predictor.h"
+
+// Register scaling (see REGISTER_GAINS): R0 Vac1 in 0.1 V, R1 Iac1 in 0.1 A,
+// R9 Pac in W, so Pac ~= R0 * R1 / 100.
+// Part of the frame format: changing an entry breaks decoding of old frames.
+static const register_predictor_t PREDICTOR_TABLE[] = {
+    {9, 0, 1, 100},
+};
+
+#define PREDICTOR_TABLE_SIZE (sizeof(PREDICTOR_TABLE) / sizeof(PREDICTOR_TABLE[0]))
+
+static uint16_t predict(const register_predictor_t* predictor, const uint16_t* row) {
+    uint32_t product = (uint32_t)row[predictor->source_a] * row[predictor->source_b];
+    return (uint16_t)(product / predictor->divisor);
+}
+
+const register_predictor_t* predictor_for(size_t reg) {
+    for (size_t i = 0; i < PREDICTOR_TABLE_SIZE; i++) {
+        if (PREDICTOR_TABLE[i].target == reg) {
+            return &PREDICTOR_TABLE[i];
+        }
+    }
+    return nullptr;
+}
+
+uint16_t predictor_residual(const uint16_t* row, size_t reg) {
+    const register_predictor_t* predictor = predictor_for(reg);
+    if (!predictor) {
+        return row[reg];
+    }
+    return (uint16_t)(row[reg] - predict(predictor, row));
+}
+
+void predictor_restore_row(uint16_t* row, size_t register_count) {
+    for (size_t i = 0; i < PREDICTOR_TABLE_SIZE; i++) {
+        const register_predictor_t* predictor = &PREDICTOR_TABLE[i];
+        if (predictor->target >= register_count || predictor->source_a >= register_count ||
+            predictor->source_b >= register_count) {
+            continue;
+        }
+        row[predictor->target] = (uint16_t)(row[predictor->target] + predict(predictor, row));
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef PREDICTOR_H
+#define PREDICTOR_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Cross-register prediction. A predicted register is encoded as the residual
+// (value - prediction, modulo 2^16) against a prediction computed from other
+// registers of the same sample. Integer-only and portable, so the decoder can
+// undo it on a host. Frames using it carry FRAME_FLAG_PREDICTED.
+//
+// Source registers are never predicted themselves, so a decoder can restore
+// every target once all columns of a sample are decoded.
+
+// prediction = (row[source_a] * row[source_b]) / divisor
+typedef struct {
+    uint8_t target;
+    uint8_t source_a;
+    uint8_t source_b;
+    uint16_t divisor;
+} register_predictor_t;
+
+// Predictor of a register, nullptr if it is encoded as is
+const register_predictor_t* predictor_for(size_t reg);
+
+// Residual to encode for row[reg] (row[reg] itself when not predicted)
+uint16_t predictor_residual(const uint16_t* row, size_t reg);
+
+// Replace the residuals of a decoded row with the original values
+void predictor_restore_row(uint16_t* row, size_t register_count);
+
+#endif // PREDICTOR_H
@@ -0,0 +1,141 @@
+#include "sample_times.h"
+#include "bitstream.h"
+#include "varint.h"
+
+#define SAMPLE_TIMES_FIXED_SIZE 7  // flags + 48-bit base
+
+// Offset from the first sample in resolution units, rounded to nearest
+static int32_t quantize(int32_t offset_ms, uint32_t resolution_ms) {
+    int64_t half = resolution_ms / 2;
+    int64_t offset = offset_ms;
+    return (int32_t)(offset >= 0 ? (offset + half) / (int64_t)resolution_ms
+                                 : -((-offset + half) / (int64_t)resolution_ms));
+}
+
+static bool put_dod(bit_writer_t* writer, int64_t dod) {
+    if (dod == 0) {
+        bit_writer_put(writer, 0, 1);
+        return true;
+    }
+    if (dod < INT32_MIN || dod > INT32_MAX) {
+        return false;
+    }
+    int32_t value = (int32_t)dod;
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    uint32_t code = zigzag - 1;
+    if (code < (1u << 3)) {
+        bit_writer_put(writer, 0x2, 2);
+        bit_writer_put(writer, code, 3);
+    } else if (code < (1u << 7)) {
+        bit_writer_put(writer, 0x6, 3);
+        bit_writer_put(writer, code, 7);
+    } else if (code < (1u << 12)) {
+        bit_writer_put(writer, 0xE, 4);
+        bit_writer_put(writer, code, 12);
+    } else {
+        bit_writer_put(writer, 0xF, 4);
+        bit_writer_put(writer, code >> 16, 16);
+        bit_writer_put(writer, code & 0xFFFF, 16);
+    }
+    return true;
+}
+
+static int32_t get_dod(bit_reader_t* reader) {
+    uint32_t code;
+    if (!bit_reader_get(reader, 1)) {
+        return 0;
+    }
+    if (!bit_reader_get(reader, 1)) {
+        code = bit_reader_get(reader, 3);
+    } else if (!bit_reader_get(reader, 1)) {
+        code = bit_reader_get(reader, 7);
+    } else if (!bit_reader_get(reader, 1)) {
+        code = bit_reader_get(reader, 12);
+    } else {
+        code = bit_reader_get(reader, 16) << 16;
+        code |= bit_reader_get(reader, 16);
+    }
+    uint32_t zigzag = code + 1;
+    return (int32_t)((zigzag >> 1) ^ (uint32_t)-(int32_t)(zigzag & 1));
+}
+
+size_t sample_times_encode(const sample_times_header_t* header, const uint32_t* times_ms,
+                           uint8_t* out, size_t capacity) {
+    if (header->resolution_ms == 0 || capacity < SAMPLE_TIMES_FIXED_SIZE) {
+        return 0;
+    }
+    size_t pos = 0;
+    out[pos++] = header->unix_time ? SAMPLE_TIMES_FLAG_UNIX : 0;
+    for (int i = 0; i < 6; i++) {
+        out[pos++] = (uint8_t)(header->base_ms >> (8 * i));
+    }
+    if (!put_varint(out, capacity, &pos, header->resolution_ms) ||
+        !put_varint(out, capacity, &pos, header->interval) ||
+        !put_varint(out, capacity, &pos, (uint32_t)header->count)) {
+        return 0;
+    }
+
+    bit_writer_t writer;
+    bit_writer_init(&writer, out + pos, capacity - pos);
+    int32_t previous = 0;
+    for (size_t i = 1; i < header->count; i++) {
+        int32_t current = quantize((int32_t)(times_ms[i] - times_ms[0]), header->resolution_ms);
+        if (!put_dod(&writer, (int64_t)current - previous - header->interval)) {
+            return 0;
+        }
+        previous = current;
+    }
+    bit_writer_align(&writer);
+    if (writer.overflow || pos + bit_writer_bytes(&writer) > capacity) {
+        return 0;
+    }
+    return pos + bit_writer_bytes(&writer);
+}
+
+size_t sample_times_encode_fitted(sample_times_header_t* header, uint32_t interval_ms, uint32_t max_resolution_ms,
+                                  const uint32_t* times_ms, uint8_t* out, size_t capacity) {
+    for (; header->resolution_ms > 0 && header->resolution_ms <= max_resolution_ms; header->resolution_ms *= 2) {
+        header->interval = (interval_ms + header->resolution_ms / 2) / header->resolution_ms;
+        size_t value_len = sample_times_encode(header, times_ms, out, capacity);
+        if (value_len > 0) {
+            return value_len;
+        }
+    }
+    return 0;
+}
+
+bool sample_times_decode(const uint8_t* value, size_t length, sample_times_header_t* header,
+                         int32_t* offsets_ms, size_t max_offsets) {
+    if (length < SAMPLE_TIMES_FIXED_SIZE) {
+        return false;
+    }
+    size_t pos = 0;
+    header->unix_time = (value[pos++] & SAMPLE_TIMES_FLAG_UNIX) != 0;
+    header->base_ms = 0;
+    for (int i = 0; i < 6; i++) {
+        header->base_ms |= (uint64_t)value[pos++] << (8 * i);
+    }
+    uint32_t count;
+    if (!get_varint(value, length, &pos, &header->resolution_ms) ||
+        !get_varint(value, length, &pos, &header->interval) ||
+        !get_varint(value, length, &pos, &count) || header->resolution_ms == 0) {
+        return false;
+    }
+    header->count = count;
+
+    bit_reader_t reader;
+    bit_reader_init(&reader, value + pos, length - pos);
+    int64_t current = 0;
+    for (size_t i = 0; i < header->count; i++) {
+        if (i > 0) {
+            current += (int64_t)header->interval + get_dod(&reader);
+            if (reader.overflow) {
+                return false;
+            }
+        }
+        if (i < max_offsets) {
+            offsets_ms[i] = (int32_t)(current * header->resolution_ms);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef SAMPLE_TIMES_H
+#define SAMPLE_TIMES_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Per-sample timestamps of a frame, sent as the FRAME_TLV_SAMPLE_TIMES trailer
+// record (see frame_format.h). Portable so host-side decoders can use it.
+//
+// Times are quantized to `resolution_ms` relative to the first sample. Each
+// later sample is coded as delta-of-delta against the nominal interval:
+// d = (q[i] - q[i-1]) - interval, where q is in resolution units:
+//   0                   d == 0 (on time)
+//   10   + 3 bits       zigzag(d) - 1 < 8
+//   110  + 7 bits       zigzag(d) - 1 < 128
+//   1110 + 12 bits      zigzag(d) - 1 < 4096
+//   1111 + 32 bits      anything else
+//
+// Value: [flags] [base u48 LE] [resolution varint] [interval varint]
+//        [count varint] [codes, MSB first, zero padded]
+
+#define SAMPLE_TIMES_FLAG_UNIX 0x01  // base is Unix time in ms (otherwise device uptime in ms)
+
+typedef struct {
+    uint64_t base_ms;        // Time of the first sample
+    bool unix_time;          // base_ms is NTP time (see SAMPLE_TIMES_FLAG_UNIX)
+    uint32_t resolution_ms;  // Quantization step, > 0
+    uint32_t interval;       // Nominal interval in resolution units
+    size_t count;            // Samples covered
+} sample_times_header_t;
+
+// times_ms: monotonic ms of each sample (header->count entries, wrap-safe).
+// Returns the value length, 0 if it does not fit in capacity.
+size_t sample_times_encode(const sample_times_header_t* header, const uint32_t* times_ms,
+                           uint8_t* out, size_t capacity);
+
+// Encode at header->resolution_ms, doubling it up to max_resolution_ms until the
+// value fits (irregular times need coarser steps). header->resolution_ms and
+// header->interval (interval_ms rounded to the step) are left at the values used.
+// Returns the value length, 0 if it does not fit even at max_resolution_ms.
+size_t sample_times_encode_fitted(sample_times_header_t* header, uint32_t interval_ms, uint32_t max_resolution_ms,
+                                  const uint32_t* times_ms, uint8_t* out, size_t capacity);
+
+// Decode the header and up to max_offsets sample offsets from the base (ms,
+// a multiple of the resolution; negative when a sample predates the first).
+// False on malformed input.
+bool sample_times_decode(const uint8_t* value, size_t length, sample_times_header_t* header,
+                         int32_t* offsets_ms, size_t max_offsets);
+
+#endif // SAMPLE_TIMES_H
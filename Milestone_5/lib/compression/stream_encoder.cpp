@@ -0,0 +1,167 @@
+#include "stream_encoder.h"
+#include "predictor.h"
+
+// Pinned registers always use their configured codec and run no trials
+static bool is_pinned(size_t reg) {
+    return register_codec_preference(reg) != COLUMN_CODEC_ANY;
+}
+
+static void start_batch(stream_encoder_t* encoder) {
+    encoder->count = 0;
+    encoder->valid = true;
+    encoder->encode_time_us = 0;
+    encoder->predict = PREDICTOR_ENABLED && !compression_is_lossy();
+
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        // Pins (including tolerances) may have changed since the last batch
+        if (encoder->method == COMPRESSION_METHOD_AUTO && is_pinned(reg)) {
+            encoder->codecs[reg] = register_codec_preference(reg);
+        }
+        column_encoder_init(&encoder->columns[reg], encoder->codecs[reg], register_tolerance(reg));
+        bit_writer_init(&encoder->writers[reg], encoder->column_data[reg], STREAM_COLUMN_CAPACITY);
+
+        if (encoder->method == COMPRESSION_METHOD_AUTO) {
+            for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+                column_encoder_init(&encoder->trials[reg][codec], codec);
+                bit_writer_init(&encoder->trial_writers[reg][codec], nullptr, 0);
+            }
+        }
+    }
+}
+
+// Size of a column once its pending run/block is flushed (state untouched)
+static size_t finished_size(const column_encoder_t* column, const bit_writer_t* writer) {
+    column_encoder_t column_copy = *column;
+    bit_writer_t writer_copy = *writer;
+    writer_copy.data = nullptr;
+    column_encoder_finish(&column_copy, &writer_copy);
+    return bit_writer_bytes(&writer_copy);
+}
+
+void stream_encoder_init(stream_encoder_t* encoder, uint8_t method) {
+    encoder->method = method;
+
+    uint8_t codec = COLUMN_CODEC_BITPACK;
+    if (method == COMPRESSION_METHOD_DELTA_RLE) {
+        codec = COLUMN_CODEC_DELTA_RLE;
+    }
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        encoder->codecs[reg] = codec;
+    }
+
+    start_batch(encoder);
+}
+
+void stream_encoder_reset(stream_encoder_t* encoder) {
+    if (encoder->method == COMPRESSION_METHOD_AUTO && encoder->valid && encoder->count > 0) {
+        for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+            // Pinned during this batch: no trials ran
+            if (encoder->trials[reg][0].samples == 0) {
+                continue;
+            }
+            size_t best_len = SIZE_MAX;
+            for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+                if (!column_codec_auto_select(codec)) {
+                    continue;
+                }
+                size_t column_len = finished_size(&encoder->trials[reg][codec], &encoder->trial_writers[reg][codec]);
+                if (column_len < best_len) {
+                    best_len = column_len;
+                    encoder->codecs[reg] = codec;
+                }
+            }
+        }
+    }
+
+    start_batch(encoder);
+}
+
+void stream_encoder_push(stream_encoder_t* encoder, const uint16_t* values) {
+    if (!encoder->valid) {
+        return;
+    }
+    if (encoder->count >= MAX_BUFFER_SAMPLES) {
+        encoder->valid = false;
+        return;
+    }
+
+    unsigned long start = micros();
+
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        uint16_t value = encoder->predict ? predictor_residual(values, reg) : values[reg];
+        column_encoder_push(&encoder->columns[reg], &encoder->writers[reg], value);
+
+        if (encoder->method == COMPRESSION_METHOD_AUTO && !is_pinned(reg)) {
+            for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+                column_encoder_push(&encoder->trials[reg][codec], &encoder->trial_writers[reg][codec], value);
+            }
+        }
+
+        if (encoder->writers[reg].overflow) {
+            encoder->valid = false;
+        }
+    }
+    encoder->count++;
+
+    encoder->encode_time_us += micros() - start;
+}
+
+void stream_encoder_invalidate(stream_encoder_t* encoder) {
+    encoder->valid = false;
+}
+
+bool stream_encoder_ready(const stream_encoder_t* encoder, size_t expected_count) {
+    return encoder->valid && encoder->count > 0 && encoder->count == expected_count;
+}
+
+compression_metrics_t stream_encoder_finish(stream_encoder_t* encoder, uint8_t* output, size_t output_capacity) {
+    compression_metrics_t metrics;
+    const char* name = (encoder->method == COMPRESSION_METHOD_AUTO) ? "Auto (streamed)" : column_codec_name(encoder->codecs[0]);
+    init_compression_metrics(&metrics, encoder->method, name, encoder->count);
+    metrics.cpu_time_us = encoder->encode_time_us;
+    metrics.predicted = encoder->predict;
+
+    if (!stream_encoder_ready(encoder, encoder->count) || output_capacity < FRAME_HEADER_SIZE) {
+        return metrics;
+    }
+
+    unsigned long start = micros();
+
+    bit_writer_t writer;
+    bit_writer_init(&writer, output + FRAME_HEADER_SIZE, output_capacity - FRAME_HEADER_SIZE);
+
+    if (encoder->method == COMPRESSION_METHOD_AUTO) {
+        for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+            bit_writer_put(&writer, encoder->codecs[reg], 4);
+        }
+        bit_writer_align(&writer);
+    }
+
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        // Flush a copy of the column state; the live encoder keeps its pending
+        // run/block and rewrites the flushed tail bytes on its next push
+        column_encoder_t column_copy = encoder->columns[reg];
+        bit_writer_t column_writer = encoder->writers[reg];
+        column_encoder_finish(&column_copy, &column_writer);
+
+        size_t column_len = bit_writer_bytes(&column_writer);
+        if (column_writer.overflow || writer.byte_pos + column_len > writer.capacity) {
+            log_error(ERROR_COMPRESSION_FAILED, "Streamed output exceeds buffer");
+            return metrics;
+        }
+        memcpy(writer.data + writer.byte_pos, encoder->column_data[reg], column_len);
+        writer.byte_pos += column_len;
+
+        metrics.column_codecs[reg] = encoder->codecs[reg];
+        if (encoder->method == COMPRESSION_METHOD_AUTO && !is_pinned(reg)) {
+            for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+                metrics.codec_sizes[codec] += finished_size(&encoder->trials[reg][codec], &encoder->trial_writers[reg][codec]);
+            }
+        } else {
+            metrics.codec_sizes[encoder->codecs[reg]] += column_len;
+        }
+    }
+
+    finish_compression_metrics(&metrics, output, bit_writer_bytes(&writer), start);
+    return metrics;
+}
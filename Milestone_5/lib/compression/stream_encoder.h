@@ -0,0 +1,50 @@
+#ifndef STREAM_ENCODER_H
+#define STREAM_ENCODER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "codecs.h"
+#include "compressor.h"
+
+// Worst case per column over all codecs (swinging door: 34 bits per delta)
+#define STREAM_COLUMN_CAPACITY (2 + 5 * (MAX_BUFFER_SAMPLES - 1))
+
+// Incremental encoder fed one sample at a time from store_register_reading().
+// Each register column is encoded into its own slice as samples arrive, so the
+// upload path only has to stitch the header, tag table and columns together.
+// In AUTO mode every column also runs size-only shadow encoders for all
+// codecs; their winners become the column codecs of the next batch.
+typedef struct {
+    uint8_t method;                                     // COMPRESSION_METHOD_*
+    bool predict;                                       // Encode predicted registers as residuals
+    size_t count;                                       // Samples encoded in this batch
+    bool valid;                                         // False once the batch no longer matches the buffer
+    unsigned long encode_time_us;                       // Accumulated per-sample encode time
+    uint8_t codecs[READ_REGISTER_COUNT];                // Column codecs of this batch
+    column_encoder_t columns[READ_REGISTER_COUNT];
+    bit_writer_t writers[READ_REGISTER_COUNT];
+    uint8_t column_data[READ_REGISTER_COUNT][STREAM_COLUMN_CAPACITY];
+    column_encoder_t trials[READ_REGISTER_COUNT][COLUMN_CODEC_COUNT];
+    bit_writer_t trial_writers[READ_REGISTER_COUNT][COLUMN_CODEC_COUNT];
+} stream_encoder_t;
+
+// Set up for the given method; column codecs start as bit-packed deltas
+void stream_encoder_init(stream_encoder_t* encoder, uint8_t method);
+
+// Start a new batch (AUTO: adopt the smallest codec of the previous batch per column)
+void stream_encoder_reset(stream_encoder_t* encoder);
+
+// Encode one sample (READ_REGISTER_COUNT values)
+void stream_encoder_push(stream_encoder_t* encoder, const uint16_t* values);
+
+// Mark the batch as out of sync with the sample buffer (e.g. circular overwrite)
+void stream_encoder_invalidate(stream_encoder_t* encoder);
+
+// True when the encoded batch holds exactly expected_count samples
+bool stream_encoder_ready(const stream_encoder_t* encoder, size_t expected_count);
+
+// Build the compressed frame without advancing the batch, so a failed upload
+// can keep streaming into the same batch
+compression_metrics_t stream_encoder_finish(stream_encoder_t* encoder, uint8_t* output, size_t output_capacity);
+
+#endif // STREAM_ENCODER_H
@@ -0,0 +1,28 @@
+#include "varint.h"
+
+bool put_varint(uint8_t* out, size_t capacity, size_t* pos, uint32_t value) {
+    do {
+        if (*pos >= capacity) {
+            return false;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out[(*pos)++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    return true;
+}
+
+bool get_varint(const uint8_t* in, size_t length, size_t* pos, uint32_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (*pos >= length) {
+            return false;
+        }
+        uint8_t byte = in[(*pos)++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
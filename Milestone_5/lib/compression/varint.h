@@ -0,0 +1,14 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <cstdint>
+#include <cstddef>
+
+// LEB128 varints of the frame trailer records: 7 bits per byte, least
+// significant group first, bit 7 set on every byte but the last.
+// Both return false when the value does not fit / is cut off at `capacity` /
+// `length`; *pos is advanced past the bytes written or read.
+bool put_varint(uint8_t* out, size_t capacity, size_t* pos, uint32_t value);
+bool get_varint(const uint8_t* in, size_t length, size_t* pos, uint32_t* value);
+
+#endif // VARINT_H
@@ -7,7 +7,7 @@
 #define POWER_MANAGMENT 1
 #define DVFS 1
 #define LIGHT_SLEEP 1
-#define IDLE_DELAY 0
+#define LIGHT_SLEEP_MIN_MS 200  // Shorter idle gaps are spent in delay() (WiFi re-init costs more)
 #define SERIAL_GATING 0
 
 // WiFi credentials
@@ -34,6 +34,38 @@
 #define MAX_RETRIES 3
 #define RETRY_BASE_DELAY_MS 1000UL
 #define MAX_RETRY_DELAY_MS 8000UL
+#define WAIT_SAMPLING_STEP_MS 50UL  // Poll step for due reads during API retry waits
+
+// Acquisition task: reads run in their own FreeRTOS task on a fixed cadence and hand
+// samples to the loop through a lock-free ring, so uploads never delay sampling.
+// Manual light sleep in the loop is skipped while it runs (it would stall reads).
+#define ACQUISITION_TASK_ENABLED 0
+#define ACQUISITION_RING_CAPACITY 32  // Samples queued between the tasks (power of two)
+#define ACQUISITION_TASK_STACK 8192
+#define ACQUISITION_TASK_PRIORITY 2   // Above the Arduino loop task (1)
+#define ACQUISITION_TASK_CORE 0
+
+// Upload pipeline: CRC/AES/HMAC sealing runs in its own task on the other core, so the
+// next frame is sealed while the previous one is on the wire (see upload_pipeline.h)
+#define UPLOAD_PIPELINE_DEPTH 2       // Frames in flight between the stages
+#define UPLOAD_SEAL_TASK_STACK 8192
+#define UPLOAD_SEAL_TASK_PRIORITY 1
+#define UPLOAD_SEAL_TASK_CORE 0       // The Arduino loop (compress + network) runs on core 1
+#define UPLOAD_SEAL_TIMEOUT_MS 5000
+
+// Alarms: threshold rules (ALARM_RULES in scheduler.cpp) are checked on every sample; a rule
+// that fires sends a one-sample alarm frame right away, outside the upload cycle
+#define ALARM_ENABLED 1
+#define ALARM_QUEUE_DEPTH 4  // Alarm frames waiting to be sent (the oldest goes to history when full)
+
+// Event capture: on an alarm, the last CAPTURE_PRE_MS of samples plus CAPTURE_POST_MS of
+// burst-rate samples after it are frozen and uploaded losslessly as capture frames
+#define CAPTURE_ENABLED 1
+#define CAPTURE_PRE_MS 30000UL            // Pre-trigger window
+#define CAPTURE_POST_MS 15000UL           // Post-trigger window, sampled at the burst rate
+#define CAPTURE_BURST_INTERVAL_MS 500UL   // Read interval after the trigger
+#define CAPTURE_PRE_SAMPLES 32            // Pre-trigger ring (covers CAPTURE_PRE_MS at the adaptive floor)
+#define CAPTURE_MAX_SAMPLES 64            // Whole capture; it closes early when full
 
 // Timing configuration
 #define POLL_INTERVAL_MS 3000
@@ -43,6 +75,16 @@
 #define UPLOAD_INTERVAL_MS 15000 //900000; // 15 minutes
 // FOTA_INTERVAL_MS removed - FOTA now integrated into upload response (no polling)
 #define COMMAND_INTERVAL_MS 15000
+#define SCHEDULER_MAX_IDLE_MS ((WATCHDOG_TIMEOUT_S * 1000UL) / 2)  // Longest block between deadlines
+
+// Adaptive sampling: the read interval starts at the configured one, drops to the floor when
+// a register changes faster than its REGISTER_ACTIVITY_THRESHOLD and doubles towards the
+// ceiling after a run of quiet samples (see adaptive_sampler.h)
+#define ADAPTIVE_SAMPLING 1
+#define ADAPTIVE_MIN_INTERVAL_MS 1000UL    // Floor while registers are active
+#define ADAPTIVE_MAX_INTERVAL_MS 30000UL   // Ceiling when everything is flat
+#define ADAPTIVE_QUIET_PCT 50              // Below this % of the thresholds a sample is quiet
+#define ADAPTIVE_QUIET_SAMPLES 5           // Quiet samples in a row before the interval doubles
 
 // Modbus configuration
 #define SLAVE_ADDRESS 0x11
@@ -60,18 +102,53 @@ extern const PROGMEM uint16_t READ_REGISTERS[READ_REGISTER_COUNT];
 // System configuration
 #define SERIAL_BAUD_RATE 115200
 #define MEMORY_BUFFER_SIZE 30  // Default fallback buffer size when dynamic allocation fails
+#define MIN_BUFFER_SAMPLES 5    // Lower clamp for the dynamic buffer
+#define MAX_BUFFER_SAMPLES 100  // Upper clamp for the dynamic buffer
 
 // Compression configuration
-#define MAX_COMPRESSION_SIZE (MEMORY_BUFFER_SIZE * 2 * READ_REGISTER_COUNT + 5)
+// Worst case over all column codecs: 2-byte first value + up to 34 bits per delta
+// (swinging door) per register, plus one byte per register for the AUTO tables
+#define MAX_COMPRESSION_SIZE (READ_REGISTER_COUNT * (3 + 5 * (MAX_BUFFER_SAMPLES - 1)) + 5)
+#define COMPRESSION_METHOD COMPRESSION_METHOD_AUTO // See frame_format.h for method ids
 #define MAX_COMPRESSION_RETRIES 3 // Maximum number of compression retries
 #define MAX_PAYLOAD_SIZE 200 // Maximum allowed payload size before using aggregation
-#define AGG_WINDOW 10 // Samples per aggregation window
+#define AGG_WINDOW 10 // Samples per aggregation window (min/max/mean/last kept per window)
+#define AGG_MAX_WINDOW 255 // Widest window when the aggregated frame still does not fit (1-byte field)
+#define PREDICTOR_ENABLED 1 // Encode predicted registers (predictor.cpp table) as residuals
+#define MAX_REGISTER_TOLERANCE 1000 // Upper limit for cloud-set swinging-door tolerances (raw counts)
+#define SAMPLE_TIME_RESOLUTION_MS 100UL // Sample timestamp step in frames (on-time samples cost 1 bit)
+#define SAMPLE_TIME_MAX_RESOLUTION_MS 60000UL // Coarsest step tried when irregular times do not fit
+
+// Per-register column codec for AUTO frames (COLUMN_CODEC_ANY = smallest trial wins).
+// Cumulative energy counters should be pinned to COLUMN_CODEC_DOD_RLE.
+extern const PROGMEM uint8_t REGISTER_COLUMN_CODECS[READ_REGISTER_COUNT];
+
+// Bounded compression: when a batch exceeds MAX_PAYLOAD_SIZE, low bits are dropped
+// from the least important registers first (lower = degraded earlier), each up to
+// its max shift (0 = never quantized). Aggregation is only the last resort.
+extern const PROGMEM uint8_t REGISTER_QUANT_IMPORTANCE[READ_REGISTER_COUNT];
+extern const PROGMEM uint8_t REGISTER_MAX_QUANT_SHIFT[READ_REGISTER_COUNT];
 
 // Buffer behavior configuration
 #define BUFFER_FULL_BEHAVIOR_CIRCULAR 1  // Option A: Overwrite oldest data (circular buffer)
 #define BUFFER_FULL_BEHAVIOR_STOP 0     // Option B: Stop new acquisitions until space is free
 #define BUFFER_FULL_BEHAVIOR BUFFER_FULL_BEHAVIOR_STOP  // Choose behavior when buffer is full
 
+// Compressed history configuration (full batches are sealed here while uploads fail)
+#define HISTORY_ARENA_SIZE 16384        // Bytes of compressed frames kept in RAM (max 65535)
+#define HISTORY_MAX_BLOCKS 128          // Max sealed batches held
+#define HISTORY_BLOCKS_PER_UPLOAD 4     // Sealed batches drained per upload cycle
+
+// Flash spill queue (SPIFFS): sealed blocks the history has no room for while offline
+#define SPILL_ENABLED 1
+#define SPILL_SEGMENT_BYTES 16384       // Records per segment file before a new one starts
+#define SPILL_MAX_SEGMENTS 24           // Oldest segment is dropped beyond this (384 KB)
+#define SPILL_DRAIN_BATCH 4             // Flash records sent per upload cycle
+#define SPILL_DRAIN_GAP_MS 250UL        // Pause between drained records (keeps sampling)
+
+// Raw counts per second at which a register counts as active (0 = ignored by adaptive sampling)
+extern const PROGMEM uint16_t REGISTER_ACTIVITY_THRESHOLD[READ_REGISTER_COUNT];
+
 // Register gains (stored in PROGMEM)
 extern const PROGMEM float REGISTER_GAINS[MAX_REGISTERS];
 extern const PROGMEM char* REGISTER_UNITS[MAX_REGISTERS];
@@ -32,6 +32,7 @@ ConfigManager::ConfigManager() : initialized(false), config_mutex(nullptr), has_
     limits.min_upload_ms = 5000;       // 5 seconds minimum
     limits.max_upload_ms = 86400000;   // 24 hours maximum
     limits.max_register_count = MAX_REGISTERS;
+    limits.max_tolerance = MAX_REGISTER_TOLERANCE;
     
     set_default_config();
 }
@@ -55,6 +56,9 @@ void ConfigManager::set_default_config() {
     current_config.active_registers[2] = 0x0002; // power
     current_config.active_registers[3] = 0x0004; // frequency
     
+    // Lossless compression until the cloud sets tolerances
+    memset(current_config.tolerances, 0, sizeof(current_config.tolerances));
+    
     current_config.config_valid = true;
 }
 
@@ -107,6 +111,12 @@ bool ConfigManager::load_from_flash() {
             set_default_config();
         }
         
+        // Tolerances are optional (older NVS images don't have them)
+        size_t tol_size = sizeof(current_config.tolerances);
+        if (nvs.getBytes("tolerances", current_config.tolerances, tol_size) != tol_size) {
+            memset(current_config.tolerances, 0, tol_size);
+        }
+        
         current_config.config_valid = true;
         xSemaphoreGive(config_mutex);
         return true;
@@ -136,6 +146,7 @@ bool ConfigManager::save_to_flash_unlocked() {
     nvs.putUChar("slave_addr", current_config.slave_address);
     nvs.putUChar("reg_count", current_config.register_count);
     nvs.putBytes("registers", current_config.active_registers, sizeof(current_config.active_registers));
+    nvs.putBytes("tolerances", current_config.tolerances, sizeof(current_config.tolerances));
     
     return true;
 }
@@ -197,6 +208,13 @@ void ConfigManager::get_active_registers(uint16_t* registers, uint8_t max_count)
     }
 }
 
+void ConfigManager::get_tolerances(uint16_t* tolerances) {
+    if (xSemaphoreTake(config_mutex, CONFIG_MUTEX_TIMEOUT) == pdTRUE) {
+        memcpy(tolerances, current_config.tolerances, sizeof(current_config.tolerances));
+        xSemaphoreGive(config_mutex);
+    }
+}
+
 bool ConfigManager::is_initialized() {
     return initialized;
 }
@@ -228,6 +246,20 @@ bool ConfigManager::validate_registers(const JsonArray& registers) {
     return true;
 }
 
+bool ConfigManager::validate_tolerances(const JsonArray& tolerances) {
+    if (tolerances.size() == 0 || tolerances.size() > READ_REGISTER_COUNT) {
+        return false;
+    }
+    
+    for (JsonVariant tolerance : tolerances) {
+        if (!tolerance.is<uint16_t>() || tolerance.as<uint16_t>() > limits.max_tolerance) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
 uint16_t ConfigManager::get_register_address(const String& name) {
     for (size_t i = 0; i < REGISTER_MAP_SIZE; i++) {
         if (name.equals(REGISTER_MAP[i].name)) {
@@ -370,6 +402,27 @@ String ConfigManager::process_cloud_config_update(const String& response) {
             }
         }
         
+        // Per-register swinging-door tolerances in raw counts, indexed like READ_REGISTERS
+        if (config_update["tolerances"].is<JsonArray>()) {
+            JsonArray tolerances = config_update["tolerances"];
+            if (!validate_tolerances(tolerances)) {
+                rejected.add("tolerances");
+            } else {
+                uint16_t new_tolerances[READ_REGISTER_COUNT] = {0};
+                for (size_t i = 0; i < tolerances.size(); i++) {
+                    new_tolerances[i] = tolerances[i].as<uint16_t>();
+                }
+                
+                if (memcmp(new_tolerances, current_config.tolerances, sizeof(new_tolerances)) == 0) {
+                    unchanged.add("tolerances");
+                } else {
+                    memcpy(pending_config.tolerances, new_tolerances, sizeof(new_tolerances));
+                    accepted.add("tolerances");
+                    config_changed = true;
+                }
+            }
+        }
+        
         if (config_update["slave_address"].is<uint8_t>()) {
             uint8_t new_addr = config_update["slave_address"].as<uint8_t>();
             if (!validate_slave_address(new_addr)) {
@@ -474,6 +527,14 @@ void config_get_active_registers(uint16_t* registers, uint8_t max_count) {
     }
 }
 
+void config_get_tolerances(uint16_t* tolerances) {
+    if (g_config_manager) {
+        g_config_manager->get_tolerances(tolerances);
+    } else {
+        memset(tolerances, 0, sizeof(uint16_t) * READ_REGISTER_COUNT);
+    }
+}
+
 // Legacy config_apply_update function removed - configuration now handled through cloud integration
 
 String config_process_cloud_response(const String& response) {
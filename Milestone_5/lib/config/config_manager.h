@@ -13,6 +13,7 @@ typedef struct {
     uint8_t slave_address;
     uint8_t register_count;
     uint16_t active_registers[MAX_REGISTERS];
+    uint16_t tolerances[READ_REGISTER_COUNT];  // Swinging-door tolerance per register (raw counts, 0 = lossless)
     bool config_valid;
 } runtime_config_t;
 
@@ -23,6 +24,7 @@ typedef struct {
     uint32_t min_upload_ms;
     uint32_t max_upload_ms;
     uint8_t max_register_count;
+    uint16_t max_tolerance;
 } config_limits_t;
 
 class ConfigManager {
@@ -43,6 +45,7 @@ private:
     bool validate_upload_interval(uint32_t interval_ms);
     bool validate_slave_address(uint8_t addr);
     bool validate_registers(const JsonArray& registers);
+    bool validate_tolerances(const JsonArray& tolerances);
     uint16_t get_register_address(const String& name);
 
 public:
@@ -60,6 +63,7 @@ public:
     uint8_t get_slave_address();
     uint8_t get_register_count();
     void get_active_registers(uint16_t* registers, uint8_t max_count);
+    void get_tolerances(uint16_t* tolerances);
     
     // Initialization
     bool init();
@@ -88,6 +92,7 @@ uint32_t config_get_upload_interval_ms();
 uint8_t config_get_slave_address();
 uint8_t config_get_register_count();
 void config_get_active_registers(uint16_t* registers, uint8_t max_count);
+void config_get_tolerances(uint16_t* tolerances);  // READ_REGISTER_COUNT entries
 
 // Cloud integration functions
 String config_process_cloud_response(const String& response);
@@ -0,0 +1,187 @@
+#include "deadline_queue.h"
+
+// Wrap-safe: a is earlier than b (millis() wraps every ~49.7 days)
+static bool before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+static bool earlier(const deadline_queue_t* queue, size_t i, size_t j) {
+    return before(queue->entries[queue->heap[i]].next_due_ms, queue->entries[queue->heap[j]].next_due_ms);
+}
+
+static void swap_slots(deadline_queue_t* queue, size_t i, size_t j) {
+    uint8_t id = queue->heap[i];
+    queue->heap[i] = queue->heap[j];
+    queue->heap[j] = id;
+    queue->entries[queue->heap[i]].heap_index = (int8_t)i;
+    queue->entries[queue->heap[j]].heap_index = (int8_t)j;
+}
+
+static void sift_up(deadline_queue_t* queue, size_t i) {
+    while (i > 0 && earlier(queue, i, (i - 1) / 2)) {
+        swap_slots(queue, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void sift_down(deadline_queue_t* queue, size_t i) {
+    for (;;) {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        if (left < queue->heap_size && earlier(queue, left, smallest)) {
+            smallest = left;
+        }
+        if (right < queue->heap_size && earlier(queue, right, smallest)) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+        swap_slots(queue, i, smallest);
+        i = smallest;
+    }
+}
+
+// Restore heap order after the deadline of the entry at slot i changed
+static void fix(deadline_queue_t* queue, size_t i) {
+    size_t id = queue->heap[i];
+    sift_up(queue, i);
+    sift_down(queue, queue->entries[id].heap_index);
+}
+
+static void insert(deadline_queue_t* queue, size_t id) {
+    size_t i = queue->heap_size++;
+    queue->heap[i] = (uint8_t)id;
+    queue->entries[id].heap_index = (int8_t)i;
+    sift_up(queue, i);
+}
+
+static void remove_slot(deadline_queue_t* queue, size_t i) {
+    size_t id = queue->heap[i];
+    size_t last = --queue->heap_size;
+    if (i != last) {
+        swap_slots(queue, i, last);
+        fix(queue, i);
+    }
+    queue->entries[id].heap_index = -1;
+}
+
+// Next nominal slot strictly after the one that just ran; missed slots are skipped
+static void advance(deadline_entry_t* entry, uint32_t now, deadline_slot_t* slot) {
+    uint32_t missed = 0;
+    uint32_t due = entry->next_due_ms;
+    entry->next_due_ms += entry->period_ms;
+    if (!before(now, entry->next_due_ms)) {
+        missed = (now - entry->next_due_ms) / entry->period_ms + 1;
+        entry->next_due_ms += missed * entry->period_ms;
+        entry->skipped += missed;
+    }
+    if (slot) {
+        slot->due_ms = due;
+        slot->missed = missed;
+    }
+}
+
+void deadline_init(deadline_queue_t* queue) {
+    queue->heap_size = 0;
+    for (size_t i = 0; i < DEADLINE_MAX_ENTRIES; i++) {
+        queue->entries[i].period_ms = 0;
+        queue->entries[i].next_due_ms = 0;
+        queue->entries[i].skipped = 0;
+        queue->entries[i].heap_index = -1;
+    }
+}
+
+void deadline_start(deadline_queue_t* queue, size_t id, uint32_t period_ms, uint32_t first_due_ms) {
+    if (id >= DEADLINE_MAX_ENTRIES) {
+        return;
+    }
+    deadline_entry_t* entry = &queue->entries[id];
+    entry->period_ms = period_ms > 0 ? period_ms : 1;
+    entry->next_due_ms = first_due_ms;
+    if (entry->heap_index < 0) {
+        insert(queue, id);
+    } else {
+        fix(queue, entry->heap_index);
+    }
+}
+
+void deadline_set_active(deadline_queue_t* queue, size_t id, bool active, uint32_t now) {
+    if (id >= DEADLINE_MAX_ENTRIES) {
+        return;
+    }
+    deadline_entry_t* entry = &queue->entries[id];
+    if (!active) {
+        if (entry->heap_index >= 0) {
+            remove_slot(queue, entry->heap_index);
+        }
+        return;
+    }
+    if (entry->heap_index >= 0 || entry->period_ms == 0) {
+        return;  // Already active, or never started
+    }
+    if (before(entry->next_due_ms, now)) {
+        uint32_t behind = now - entry->next_due_ms;
+        entry->next_due_ms += ((behind + entry->period_ms - 1) / entry->period_ms) * entry->period_ms;
+    }
+    insert(queue, id);
+}
+
+bool deadline_is_active(const deadline_queue_t* queue, size_t id) {
+    return id < DEADLINE_MAX_ENTRIES && queue->entries[id].heap_index >= 0;
+}
+
+void deadline_set_period(deadline_queue_t* queue, size_t id, uint32_t period_ms, uint32_t now) {
+    if (id >= DEADLINE_MAX_ENTRIES || period_ms == 0) {
+        return;
+    }
+    deadline_entry_t* entry = &queue->entries[id];
+    if (entry->period_ms == period_ms) {
+        return;
+    }
+    uint32_t last_start = entry->next_due_ms - entry->period_ms;
+    entry->period_ms = period_ms;
+    entry->next_due_ms = last_start + period_ms;
+    if (before(entry->next_due_ms, now)) {
+        entry->next_due_ms = now;  // Shorter period: the next slot is already over, run it now
+    }
+    if (entry->heap_index >= 0) {
+        fix(queue, entry->heap_index);
+    }
+}
+
+int deadline_pop_due(deadline_queue_t* queue, uint32_t now, deadline_slot_t* slot) {
+    if (queue->heap_size == 0) {
+        return -1;
+    }
+    size_t id = queue->heap[0];
+    deadline_entry_t* entry = &queue->entries[id];
+    if (before(now, entry->next_due_ms)) {
+        return -1;
+    }
+    advance(entry, now, slot);
+    sift_down(queue, 0);
+    return (int)id;
+}
+
+bool deadline_take(deadline_queue_t* queue, size_t id, uint32_t now, deadline_slot_t* slot) {
+    if (!deadline_is_active(queue, id)) {
+        return false;
+    }
+    deadline_entry_t* entry = &queue->entries[id];
+    if (before(now, entry->next_due_ms)) {
+        return false;
+    }
+    advance(entry, now, slot);
+    fix(queue, entry->heap_index);
+    return true;
+}
+
+uint32_t deadline_wait_ms(const deadline_queue_t* queue, uint32_t now) {
+    if (queue->heap_size == 0) {
+        return DEADLINE_NONE;
+    }
+    uint32_t due = queue->entries[queue->heap[0]].next_due_ms;
+    return before(now, due) ? due - now : 0;
+}
@@ -0,0 +1,61 @@
+#ifndef DEADLINE_QUEUE_H
+#define DEADLINE_QUEUE_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Min-heap of periodic deadlines, earliest first. Clock-agnostic: every call
+// takes `now` in ms as a wrapping uint32_t (millis()), so the scheduler can be
+// driven by a virtual clock on a host.
+//
+// Periodic entries are rescheduled from their nominal start (next_due +=
+// period), so execution latency never accumulates as drift. An entry that
+// falls a whole period behind skips the missed slots instead of running back
+// to back.
+
+#define DEADLINE_MAX_ENTRIES 8
+#define DEADLINE_NONE UINT32_MAX  // deadline_wait_ms() with nothing scheduled
+
+typedef struct {
+    uint32_t period_ms;
+    uint32_t next_due_ms;
+    uint32_t skipped;    // Missed slots (overruns)
+    int8_t heap_index;   // -1 while inactive
+} deadline_entry_t;
+
+typedef struct {
+    deadline_entry_t entries[DEADLINE_MAX_ENTRIES];
+    uint8_t heap[DEADLINE_MAX_ENTRIES];  // Active entry ids
+    size_t heap_size;
+} deadline_queue_t;
+
+// The slot handed out by deadline_pop_due() / deadline_take()
+typedef struct {
+    uint32_t due_ms;  // Nominal start (lateness = start - due_ms)
+    uint32_t missed;  // Later slots skipped because this one ran too late
+} deadline_slot_t;
+
+void deadline_init(deadline_queue_t* queue);
+
+// Schedule id every period_ms, first due at first_due_ms
+void deadline_start(deadline_queue_t* queue, size_t id, uint32_t period_ms, uint32_t first_due_ms);
+
+// Pause / resume id; a resumed entry continues on its nominal grid (first slot at or after now)
+void deadline_set_active(deadline_queue_t* queue, size_t id, bool active, uint32_t now);
+bool deadline_is_active(const deadline_queue_t* queue, size_t id);
+
+// Change the period, keeping the last nominal start as the phase. The next slot is
+// never before now: shortening the period does not create overdue (missed) slots.
+void deadline_set_period(deadline_queue_t* queue, size_t id, uint32_t period_ms, uint32_t now);
+
+// Earliest entry whose deadline has passed, advanced to its next slot; -1 if none is due.
+// slot (optional) receives the nominal start and skipped count of the slot taken.
+int deadline_pop_due(deadline_queue_t* queue, uint32_t now, deadline_slot_t* slot);
+
+// Take id's slot if it is due (running one entry out of heap order)
+bool deadline_take(deadline_queue_t* queue, size_t id, uint32_t now, deadline_slot_t* slot);
+
+// ms until the earliest deadline: 0 when overdue, DEADLINE_NONE when nothing is active
+uint32_t deadline_wait_ms(const deadline_queue_t* queue, uint32_t now);
+
+#endif // DEADLINE_QUEUE_H
@@ -0,0 +1,126 @@
+#include "history_ring.h"
+
+static uint8_t arena[HISTORY_ARENA_SIZE];
+static history_block_t index_ring[HISTORY_MAX_BLOCKS];
+static size_t index_head = 0;   // Oldest block
+static size_t index_count = 0;
+static uint32_t next_sequence = 0;
+static history_stats_t stats = {0};
+static history_overflow_hook_t overflow_hook = nullptr;
+
+// Arena position where the next frame starts (right after the newest block)
+static size_t arena_write_pos(void) {
+    if (index_count == 0) {
+        return 0;
+    }
+    const history_block_t* newest = &index_ring[(index_head + index_count - 1) % HISTORY_MAX_BLOCKS];
+    return newest->offset + newest->length;
+}
+
+// True if [start, start + length) overlaps a stored block
+static bool overlaps_stored(size_t start, size_t length) {
+    for (size_t i = 0; i < index_count; i++) {
+        const history_block_t* block = &index_ring[(index_head + i) % HISTORY_MAX_BLOCKS];
+        if (start < (size_t)block->offset + block->length && (size_t)block->offset < start + length) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void evict_oldest(void) {
+    stats.evicted_blocks++;
+    stats.evicted_samples += index_ring[index_head].samples;
+    history_pop_oldest();
+}
+
+void history_init(void) {
+    index_head = 0;
+    index_count = 0;
+    next_sequence = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void history_set_overflow_hook(history_overflow_hook_t hook) {
+    overflow_hook = hook;
+}
+
+bool history_append(const uint8_t* frame, size_t length, uint16_t samples) {
+    if (length == 0 || length > HISTORY_ARENA_SIZE) {
+        stats.rejected_blocks++;
+        return false;
+    }
+
+    // Frames are stored contiguously; wrap to the start when the tail is too short
+    size_t start = arena_write_pos();
+    if (start + length > HISTORY_ARENA_SIZE) {
+        start = 0;
+    }
+
+    while (index_count == HISTORY_MAX_BLOCKS || overlaps_stored(start, length)) {
+        const history_block_t* oldest = &index_ring[index_head];
+        if (overflow_hook && overflow_hook(arena + oldest->offset, oldest)) {
+            stats.spilled_blocks++;
+            history_pop_oldest();
+            if (index_count == 0) {
+                start = 0;
+            }
+            continue;
+        }
+        #if BUFFER_FULL_BEHAVIOR == BUFFER_FULL_BEHAVIOR_STOP
+            stats.rejected_blocks++;
+            return false;
+        #else
+            evict_oldest();
+            if (index_count == 0) {
+                start = 0;
+            }
+        #endif
+    }
+
+    memcpy(arena + start, frame, length);
+
+    history_block_t* block = &index_ring[(index_head + index_count) % HISTORY_MAX_BLOCKS];
+    block->sequence = next_sequence++;
+    block->offset = (uint16_t)start;
+    block->length = (uint16_t)length;
+    block->samples = samples;
+    index_count++;
+
+    stats.blocks = index_count;
+    stats.samples += samples;
+    stats.bytes_used += length;
+    return true;
+}
+
+const uint8_t* history_get(size_t index, history_block_t* info) {
+    if (index >= index_count) {
+        return nullptr;
+    }
+
+    const history_block_t* block = &index_ring[(index_head + index) % HISTORY_MAX_BLOCKS];
+    if (info) {
+        *info = *block;
+    }
+    return arena + block->offset;
+}
+
+void history_pop_oldest(void) {
+    if (index_count == 0) {
+        return;
+    }
+
+    stats.samples -= index_ring[index_head].samples;
+    stats.bytes_used -= index_ring[index_head].length;
+    index_head = (index_head + 1) % HISTORY_MAX_BLOCKS;
+    index_count--;
+    stats.blocks = index_count;
+}
+
+size_t history_count(void) {
+    return index_count;
+}
+
+history_stats_t history_get_stats(void) {
+    return stats;
+}
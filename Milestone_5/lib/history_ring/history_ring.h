@@ -0,0 +1,48 @@
+#ifndef HISTORY_RING_H
+#define HISTORY_RING_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Compressed in-RAM history: every sealed batch is stored as a finished
+// upload frame ([flags][compressed payload]) in a fixed byte arena, with a
+// small block index for random access and oldest-first eviction.
+
+typedef struct {
+    uint32_t sequence;   // Monotonic block number
+    uint16_t offset;     // Start of the frame in the arena
+    uint16_t length;     // Frame length in bytes
+    uint16_t samples;    // Samples held by the frame
+} history_block_t;
+
+typedef struct {
+    size_t blocks;
+    size_t samples;
+    size_t bytes_used;
+    uint32_t evicted_blocks;
+    uint32_t evicted_samples;
+    uint32_t rejected_blocks;
+    uint32_t spilled_blocks;
+} history_stats_t;
+
+// Called with the oldest block when an append needs room. Return true if the
+// block was saved elsewhere; it is then dropped instead of evicted/rejected.
+typedef bool (*history_overflow_hook_t)(const uint8_t* frame, const history_block_t* info);
+
+void history_init(void);
+void history_set_overflow_hook(history_overflow_hook_t hook);
+
+// Store a finished frame; evicts the oldest blocks when full (circular
+// behavior) or rejects the frame (stop behavior). Returns false if not stored.
+bool history_append(const uint8_t* frame, size_t length, uint16_t samples);
+
+// Random access, index 0 = oldest. Returns nullptr when out of range.
+const uint8_t* history_get(size_t index, history_block_t* info);
+
+// Drop the oldest block (after it was uploaded)
+void history_pop_oldest(void);
+
+size_t history_count(void);
+history_stats_t history_get_stats(void);
+
+#endif // HISTORY_RING_H
@@ -0,0 +1,121 @@
+#include "modbus_frame.h"
+#include "calculateCRC.h"
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+size_t modbus_build_request(uint8_t* out, size_t capacity, uint8_t slave, uint8_t function,
+                            uint16_t start_reg, uint16_t count_or_value) {
+    if (capacity < MODBUS_REQUEST_SIZE) {
+        return 0;
+    }
+    out[0] = slave;
+    out[1] = function;
+    out[2] = (uint8_t)(start_reg >> 8);
+    out[3] = (uint8_t)start_reg;
+    out[4] = (uint8_t)(count_or_value >> 8);
+    out[5] = (uint8_t)count_or_value;
+    uint16_t crc = calculateCRC(out, 6);
+    out[6] = (uint8_t)crc;
+    out[7] = (uint8_t)(crc >> 8);
+    return MODBUS_REQUEST_SIZE;
+}
+
+modbus_frame_status_t modbus_parse_response(const uint8_t* frame, size_t length, modbus_response_t* response) {
+    // slave + function + CRC is the least any frame carries
+    if (length < 4) {
+        return MODBUS_FRAME_TOO_SHORT;
+    }
+    uint16_t received = frame[length - 2] | (uint16_t)(frame[length - 1] << 8);
+    if (calculateCRC(frame, (int)(length - 2)) != received) {
+        return MODBUS_FRAME_BAD_CRC;
+    }
+
+    response->slave = frame[0];
+    response->function = frame[1] & ~MODBUS_EXCEPTION_FLAG;
+    response->exception_code = 0;
+    response->data.data = frame + 2;
+    response->data.length = length - 4;
+
+    if (frame[1] & MODBUS_EXCEPTION_FLAG) {
+        // slave, function | 0x80, exception code, CRC
+        if (length != 5) {
+            return MODBUS_FRAME_BAD_LENGTH;
+        }
+        if (frame[2] == 0) {
+            return MODBUS_FRAME_BAD_EXCEPTION;
+        }
+        response->exception_code = frame[2];
+        response->data.length = 0;
+        return MODBUS_FRAME_OK;
+    }
+
+    switch (response->function) {
+        case 0x03:
+        case 0x04:
+            // slave, function, byte count, data, CRC
+            if (length < 5 || (size_t)frame[2] + 5 != length || (frame[2] & 1)) {
+                return MODBUS_FRAME_BAD_LENGTH;
+            }
+            response->data.data = frame + 3;
+            response->data.length = frame[2];
+            break;
+        case 0x06:
+            // Echo of the request
+            if (length != MODBUS_REQUEST_SIZE) {
+                return MODBUS_FRAME_BAD_LENGTH;
+            }
+            break;
+        default:
+            break;
+    }
+    return MODBUS_FRAME_OK;
+}
+
+size_t modbus_register_count(const modbus_response_t* response) {
+    return response->data.length / 2;
+}
+
+uint16_t modbus_register(const modbus_response_t* response, size_t index) {
+    const uint8_t* value = response->data.data + index * 2;
+    return (uint16_t)(value[0] << 8) | value[1];
+}
+
+size_t modbus_hex_encode(const uint8_t* bytes, size_t length, char* out, size_t capacity) {
+    if (capacity < length * 2 + 1) {
+        return 0;
+    }
+    for (size_t i = 0; i < length; i++) {
+        out[2 * i] = HEX_DIGITS[bytes[i] >> 4];
+        out[2 * i + 1] = HEX_DIGITS[bytes[i] & 0x0F];
+    }
+    out[length * 2] = '\0';
+    return length * 2;
+}
+
+size_t modbus_hex_decode(const char* hex, size_t length, uint8_t* out, size_t capacity) {
+    if (length % 2 != 0 || length / 2 > capacity) {
+        return 0;
+    }
+    for (size_t i = 0; i < length / 2; i++) {
+        int high = hex_value(hex[2 * i]);
+        int low = hex_value(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return 0;
+        }
+        out[i] = (uint8_t)((high << 4) | low);
+    }
+    return length / 2;
+}
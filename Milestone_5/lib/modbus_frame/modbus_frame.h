@@ -0,0 +1,54 @@
+#ifndef MODBUS_FRAME_H
+#define MODBUS_FRAME_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Binary Modbus RTU frames: requests are built into a caller buffer and responses
+// are parsed in place (the parsed data is a view into the frame, nothing is copied
+// or allocated). Hex only exists at the HTTP edge, converted in one pass by
+// modbus_hex_encode/decode. Portable so it can be exercised on a host.
+
+#define MODBUS_REQUEST_SIZE 8       // slave, function, register (2), count or value (2), CRC (2)
+#define MODBUS_MAX_FRAME 256        // Largest RTU frame
+#define MODBUS_EXCEPTION_FLAG 0x80  // Set in the function code of exception responses
+
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+} modbus_view_t;
+
+typedef enum {
+    MODBUS_FRAME_OK = 0,
+    MODBUS_FRAME_TOO_SHORT,
+    MODBUS_FRAME_BAD_CRC,
+    MODBUS_FRAME_BAD_LENGTH,    // Byte count or function layout disagrees with the frame length
+    MODBUS_FRAME_BAD_EXCEPTION  // Exception response with code 0, which would read as a normal response
+} modbus_frame_status_t;
+
+typedef struct {
+    uint8_t slave;
+    uint8_t function;        // Without MODBUS_EXCEPTION_FLAG
+    uint8_t exception_code;  // 0 unless the slave answered with an exception
+    modbus_view_t data;      // Read: register bytes; write: register + value; otherwise everything before the CRC
+} modbus_response_t;
+
+// Request with CRC (low byte first); returns its length, 0 if capacity is too small
+size_t modbus_build_request(uint8_t* out, size_t capacity, uint8_t slave, uint8_t function,
+                            uint16_t start_reg, uint16_t count_or_value);
+
+// Check length and CRC and split the response; the view points into frame
+modbus_frame_status_t modbus_parse_response(const uint8_t* frame, size_t length, modbus_response_t* response);
+
+// Registers carried by a read response, and register `index` (big-endian on the wire)
+size_t modbus_register_count(const modbus_response_t* response);
+uint16_t modbus_register(const modbus_response_t* response, size_t index);
+
+// Upper-case hex of bytes, NUL terminated; returns the characters written, 0 if it does not fit
+size_t modbus_hex_encode(const uint8_t* bytes, size_t length, char* out, size_t capacity);
+
+// Bytes of a hex string (either case); returns the byte count, 0 on odd length, a non-hex
+// character or not enough room
+size_t modbus_hex_decode(const char* hex, size_t length, uint8_t* out, size_t capacity);
+
+#endif // MODBUS_FRAME_H
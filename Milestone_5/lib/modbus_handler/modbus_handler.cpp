@@ -1,52 +1,33 @@
 #include "modbus_handler.h"
 #include "config.h"
 #include "calculateCRC.h"
-#include "checkCRC.h"
 #include "error_handler.h"
 
-bool validate_modbus_response(const String& response) {
-    // Check minimum length (slave_addr + function_code + data + CRC = minimum 6 chars)
-    if (response.length() < 6) {
-        log_error(ERROR_INVALID_RESPONSE, "Response too short");
-        return false;
-    }
-    
-    // Check if response length is even (hex pairs)
-    if (response.length() % 2 != 0) {
-        log_error(ERROR_INVALID_RESPONSE, "Invalid response length");
-        return false;
-    }
-    
-    // Verify CRC
-    if (!verify_frame_crc(response)) {
-        log_error(ERROR_CRC_FAILED, "CRC validation failed");
-        return false;
+bool validate_modbus_response(const uint8_t* frame, size_t length, modbus_response_t* response) {
+    switch (modbus_parse_response(frame, length, response)) {
+        case MODBUS_FRAME_OK:
+            return true;
+        case MODBUS_FRAME_TOO_SHORT:
+            log_error(ERROR_INVALID_RESPONSE, "Response too short");
+            return false;
+        case MODBUS_FRAME_BAD_CRC:
+            log_error(ERROR_CRC_FAILED, "CRC validation failed");
+            return false;
+        case MODBUS_FRAME_BAD_EXCEPTION:
+            log_error(ERROR_INVALID_RESPONSE, "Exception response without exception code");
+            return false;
+        default:
+            log_error(ERROR_INVALID_RESPONSE, "Invalid response length");
+            return false;
     }
-    
-    return true;
 }
 
-bool is_exception_response(const String& response) {
-    if (response.length() < 4) {
-        return false;
-    }
-    
-    // Extract function code (second byte)
-    String func_code_str = response.substring(2, 4);
-    uint8_t func_code = strtoul(func_code_str.c_str(), nullptr, 16);
-    
-    // Exception responses have bit 7 set (0x80 | original_function_code)
-    return (func_code & 0x80) != 0;
+bool is_exception_response(const modbus_response_t* response) {
+    return response->exception_code != 0;
 }
 
-uint8_t get_exception_code(const String& response) {
-    if (!is_exception_response(response) || response.length() < 6) {
-        return 0;
-    }
-    
-    // Exception code is in the third byte
-    String exception_str = response.substring(4, 6);
-    return strtoul(exception_str.c_str(), nullptr, 16);
+uint8_t get_exception_code(const modbus_response_t* response) {
+    return response->exception_code;
 }
 
 bool is_valid_register(uint16_t register_addr) {
@@ -67,95 +48,79 @@ bool is_valid_write_value(uint16_t register_addr, uint16_t value) {
     return true;
 }
 
-bool decode_response_registers(const String& response, uint16_t* values, size_t max_count, size_t* actual_count) {
+bool decode_response_registers(const uint8_t* frame, size_t length, uint16_t* values, size_t max_count, size_t* actual_count) {
     *actual_count = 0;
-    
-    if (!validate_modbus_response(response)) {
+
+    modbus_response_t response;
+    if (!validate_modbus_response(frame, length, &response)) {
         return false;
     }
-    
-    if (is_exception_response(response)) {
-        uint8_t exception_code = get_exception_code(response);
+
+    if (is_exception_response(&response)) {
         char error_msg[64];
-        snprintf(error_msg, sizeof(error_msg), "Modbus exception: 0x%02X", exception_code);
+        snprintf(error_msg, sizeof(error_msg), "Modbus exception: 0x%02X", get_exception_code(&response));
         log_error(ERROR_MODBUS_EXCEPTION, error_msg);
         return false;
     }
-    
+
     // Parse response: slave_addr(1) + func_code(1) + byte_count(1) + data(n) + crc(2)
-    if (response.length() < 8) { // Minimum for valid data response
-        log_error(ERROR_INVALID_RESPONSE, "Response too short for data");
+    if (response.function != FUNCTION_CODE_READ) {
+        log_error(ERROR_INVALID_RESPONSE, "Unexpected function code in response");
         return false;
     }
-    
-    // Extract byte count
-    String byte_count_str = response.substring(4, 6);
-    uint8_t byte_count = strtoul(byte_count_str.c_str(), nullptr, 16);
-    
-    // Calculate number of registers (each register is 2 bytes)
-    size_t register_count = byte_count / 2;
-    
+
+    size_t register_count = modbus_register_count(&response);
     if (register_count > max_count) {
         log_error(ERROR_INVALID_RESPONSE, "Too many registers in response");
         return false;
     }
-    
-    // Extract register values
+
     for (size_t i = 0; i < register_count; i++) {
-        int start_pos = 6 + (i * 4); // Start after header, each register is 4 hex chars
-        if (start_pos + 4 > response.length() - 4) { // -4 for CRC
-            break;
-        }
-        
-        String reg_str = response.substring(start_pos, start_pos + 4);
-        values[i] = strtoul(reg_str.c_str(), nullptr, 16);
-        (*actual_count)++;
+        values[i] = modbus_register(&response, i);
     }
-    
+    *actual_count = register_count;
+
     return true;
 }
 
-String format_request_frame(uint8_t slave_addr, uint8_t function_code, uint16_t start_reg, uint16_t count_or_value) {
-    char frame[17]; // 8 bytes = 16 hex chars + null terminator
-    
-    snprintf(frame, sizeof(frame), "%02X%02X%04X%04X", 
-             slave_addr, function_code, start_reg, count_or_value);
-    
-    return String(frame);
+size_t format_request_frame(uint8_t* frame, size_t capacity, uint8_t slave_addr, uint8_t function_code, uint16_t start_reg, uint16_t count_or_value) {
+    return modbus_build_request(frame, capacity, slave_addr, function_code, start_reg, count_or_value);
 }
 
 String append_crc_to_frame(const String& frame_without_crc) {
-    int frame_length = frame_without_crc.length() / 2;
-    uint8_t frame_bytes[frame_length];
-    
-    // Convert hex string to bytes
-    for (int i = 0; i < frame_length; i++) {
-        String byte_str = frame_without_crc.substring(i * 2, i * 2 + 2);
-        frame_bytes[i] = strtoul(byte_str.c_str(), nullptr, 16);
+    // One pass over the hex pairs, CRC updated as they are read. A pair that is not
+    // hex keeps its leading digit or counts as 0, as the strtoul() parsing did.
+    const char* text = frame_without_crc.c_str();
+    size_t frame_length = frame_without_crc.length() / 2;
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < frame_length; i++) {
+        uint8_t byte = 0;
+        if (modbus_hex_decode(text + i * 2, 2, &byte, 1) == 0) {
+            const char leading[2] = {'0', text[i * 2]};
+            modbus_hex_decode(leading, 2, &byte, 1);  // Leaves byte at 0 when this is not hex either
+        }
+        crc = updateCRC(crc, &byte, 1);
     }
-    
-    // Calculate CRC
-    uint16_t crc = calculateCRC(frame_bytes, frame_length);
-    
+
     // Append CRC (low byte first)
     char crc_hex[5];
     snprintf(crc_hex, sizeof(crc_hex), "%02X%02X", crc & 0xFF, (crc >> 8) & 0xFF);
-    
-    return frame_without_crc + String(crc_hex);
-}
 
-bool verify_frame_crc(const String& frame_with_crc) {
-    return checkCRC(frame_with_crc);
+    String frame;
+    frame.reserve(frame_without_crc.length() + 4);
+    frame = frame_without_crc;
+    frame += crc_hex;
+    return frame;
 }
 
 size_t get_expected_response_length(uint8_t function_code, uint16_t register_count) {
     switch (function_code) {
         case FUNCTION_CODE_READ:
             // slave_addr(1) + func_code(1) + byte_count(1) + data(register_count*2) + crc(2)
-            return (5 + register_count * 2) * 2; // *2 for hex encoding
+            return 5 + register_count * 2;
         case FUNCTION_CODE_WRITE:
             // slave_addr(1) + func_code(1) + register_addr(2) + value(2) + crc(2)
-            return 8 * 2; // *2 for hex encoding
+            return MODBUS_REQUEST_SIZE;
         default:
             return 0;
     }
@@ -2,23 +2,23 @@
 #define MODBUS_HANDLER_H
 
 #include <Arduino.h>
+#include "modbus_frame.h"
 
-// Modbus response validation
-bool validate_modbus_response(const String& response);
-bool is_exception_response(const String& response);
-uint8_t get_exception_code(const String& response);
+// Modbus response validation (binary frames, CRC included; see modbus_frame.h)
+bool validate_modbus_response(const uint8_t* frame, size_t length, modbus_response_t* response);
+bool is_exception_response(const modbus_response_t* response);
+uint8_t get_exception_code(const modbus_response_t* response);
 
 // Register validation
 bool is_valid_register(uint16_t register_addr);
 bool is_valid_write_value(uint16_t register_addr, uint16_t value);
 
 // Response processing
-bool decode_response_registers(const String& response, uint16_t* values, size_t max_count, size_t* actual_count);
-String format_request_frame(uint8_t slave_addr, uint8_t function_code, uint16_t start_reg, uint16_t count_or_value);
+bool decode_response_registers(const uint8_t* frame, size_t length, uint16_t* values, size_t max_count, size_t* actual_count);
+size_t format_request_frame(uint8_t* frame, size_t capacity, uint8_t slave_addr, uint8_t function_code, uint16_t start_reg, uint16_t count_or_value);
 
 // Frame utilities
 String append_crc_to_frame(const String& frame_without_crc);
-bool verify_frame_crc(const String& frame_with_crc);
 size_t get_expected_response_length(uint8_t function_code, uint16_t register_count);
 
 #endif
@@ -0,0 +1,52 @@
+#include "sample_ring.h"
+#include <cstring>
+
+bool sample_ring_init(sample_ring_t* ring, uint16_t* storage, uint32_t capacity, uint32_t width) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+    ring->storage = storage;
+    ring->capacity = capacity;
+    ring->width = width;
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+    ring->overflows.store(0, std::memory_order_relaxed);
+    ring->high_water.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+bool sample_ring_push(sample_ring_t* ring, const uint16_t* values) {
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    uint32_t tail = ring->tail.load(std::memory_order_acquire);  // Slot reads by the consumer are done
+    uint32_t used = head - tail;
+    if (used >= ring->capacity) {
+        ring->overflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    memcpy(ring->storage + (size_t)(head & (ring->capacity - 1)) * ring->width, values,
+           ring->width * sizeof(uint16_t));
+    ring->head.store(head + 1, std::memory_order_release);  // Publish the copied sample
+
+    if (used + 1 > ring->high_water.load(std::memory_order_relaxed)) {
+        ring->high_water.store(used + 1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool sample_ring_pop(sample_ring_t* ring, uint16_t* values) {
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint32_t head = ring->head.load(std::memory_order_acquire);  // Sees the producer's copy
+    if (head == tail) {
+        return false;
+    }
+
+    memcpy(values, ring->storage + (size_t)(tail & (ring->capacity - 1)) * ring->width,
+           ring->width * sizeof(uint16_t));
+    ring->tail.store(tail + 1, std::memory_order_release);  // Hand the slot back
+    return true;
+}
+
+uint32_t sample_ring_count(const sample_ring_t* ring) {
+    return ring->head.load(std::memory_order_acquire) - ring->tail.load(std::memory_order_acquire);
+}
@@ -0,0 +1,36 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+// Lock-free single-producer / single-consumer ring of fixed-width samples.
+// One task pushes (acquisition), one task pops (upload / compression); no
+// locks, no allocation. head and tail are free-running counters, each
+// written by one side only, so a full ring is head - tail == capacity.
+// Portable (no Arduino dependencies) so it can be exercised on a host.
+
+typedef struct {
+    uint16_t* storage;                 // capacity * width values, caller-owned
+    uint32_t capacity;                 // Samples, power of two
+    uint32_t width;                    // Values per sample
+    std::atomic<uint32_t> head;        // Samples pushed (producer only)
+    std::atomic<uint32_t> tail;        // Samples popped (consumer only)
+    std::atomic<uint32_t> overflows;   // Samples dropped because the ring was full
+    std::atomic<uint32_t> high_water;  // Largest fill level seen by the producer
+} sample_ring_t;
+
+// capacity must be a power of two; returns false otherwise
+bool sample_ring_init(sample_ring_t* ring, uint16_t* storage, uint32_t capacity, uint32_t width);
+
+// Producer: copy one sample in; drops it and counts an overflow when full
+bool sample_ring_push(sample_ring_t* ring, const uint16_t* values);
+
+// Consumer: copy the oldest sample out; false when empty
+bool sample_ring_pop(sample_ring_t* ring, uint16_t* values);
+
+// Samples waiting (exact for the consumer, a lower bound for the producer)
+uint32_t sample_ring_count(const sample_ring_t* ring);
+
+#endif // SAMPLE_RING_H
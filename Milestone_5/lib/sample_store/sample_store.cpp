@@ -0,0 +1,105 @@
+#include "sample_store.h"
+#include <algorithm>
+
+bool sample_store_alloc(sample_store_t* store, size_t capacity) {
+    sample_store_free(store);
+
+    uint16_t* columns = (uint16_t*)malloc(capacity * READ_REGISTER_COUNT * sizeof(uint16_t));
+    uint32_t* timestamps = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    if (columns == nullptr || timestamps == nullptr) {
+        free(columns);
+        free(timestamps);
+        return false;
+    }
+    store->columns = columns;
+    store->timestamps = timestamps;
+    store->max_capacity = capacity;
+    store->capacity = capacity;
+    store->owned = true;
+    sample_store_clear(store);
+    return true;
+}
+
+void sample_store_attach(sample_store_t* store, uint16_t* storage, uint32_t* timestamps,
+                         size_t max_capacity, size_t capacity) {
+    sample_store_free(store);
+    store->columns = storage;
+    store->capacity = capacity;
+    store->owned = false;
+    store->timestamps = timestamps;
+    store->max_capacity = max_capacity;
+}
+
+// Rotate the kept samples of one column to its start, then move them to the new column slot
+template <typename T>
+static void migrate_column(T* old_column, T* new_column, size_t old_capacity, size_t first, size_t count) {
+    if (first != 0) {
+        std::rotate(old_column, old_column + first, old_column + old_capacity);
+    }
+    memmove(new_column, old_column, count * sizeof(T));
+}
+
+bool sample_store_resize(sample_store_t* store, size_t new_capacity, size_t first, size_t count) {
+    size_t old_capacity = store->capacity;
+    if (store->columns == nullptr || new_capacity == 0 || new_capacity > store->max_capacity ||
+        count > new_capacity || count > old_capacity || (count > 0 && first >= old_capacity)) {
+        return false;
+    }
+
+    // Shrinking moves columns down (lowest first), growing moves them up (highest first),
+    // so no column is overwritten before it has moved
+    for (size_t i = 0; i < READ_REGISTER_COUNT; i++) {
+        size_t reg = new_capacity < old_capacity ? i : READ_REGISTER_COUNT - 1 - i;
+        migrate_column(store->columns + reg * old_capacity, store->columns + reg * new_capacity,
+                       old_capacity, first, count);
+    }
+    if (store->timestamps != nullptr) {
+        migrate_column(store->timestamps, store->timestamps, old_capacity, first, count);
+    }
+    store->capacity = new_capacity;
+
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        memset(store->columns + reg * new_capacity + count, 0, (new_capacity - count) * sizeof(uint16_t));
+    }
+    if (store->timestamps != nullptr) {
+        memset(store->timestamps + count, 0, (new_capacity - count) * sizeof(uint32_t));
+    }
+    return true;
+}
+
+void sample_store_free(sample_store_t* store) {
+    if (store->owned) {
+        free(store->columns);
+        free(store->timestamps);
+    }
+    store->columns = nullptr;
+    store->timestamps = nullptr;
+    store->max_capacity = 0;
+    store->capacity = 0;
+    store->owned = false;
+}
+
+void sample_store_clear(sample_store_t* store) {
+    if (store->columns != nullptr) {
+        memset(store->columns, 0, store->capacity * READ_REGISTER_COUNT * sizeof(uint16_t));
+    }
+    if (store->timestamps != nullptr) {
+        memset(store->timestamps, 0, store->capacity * sizeof(uint32_t));
+    }
+}
+
+void sample_store_set_row(sample_store_t* store, size_t index, const uint16_t* row) {
+    uint16_t* cell = store->columns + index;
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        *cell = row[reg];
+        cell += store->capacity;
+    }
+}
+
+void sample_store_get_row(const sample_store_t* store, size_t index, uint16_t* row) {
+    const uint16_t* cell = store->columns + index;
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        row[reg] = *cell;
+        cell += store->capacity;
+    }
+}
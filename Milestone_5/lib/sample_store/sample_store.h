@@ -0,0 +1,67 @@
+#ifndef SAMPLE_STORE_H
+#define SAMPLE_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Column-major (struct-of-arrays) sample buffer: every register has one
+// contiguous column of `capacity` samples, so per-register encoding,
+// aggregation and statistics walk memory sequentially. Samples are written
+// and read back as rows of READ_REGISTER_COUNT values through the accessors.
+// Stores may also keep the sample time of every row (millis() of the read).
+// The capacity can change in place up to the size of the storage, so a
+// store over a static arena is resized without touching the heap.
+
+typedef struct {
+    uint16_t* columns;  // READ_REGISTER_COUNT columns of capacity values each
+    size_t capacity;    // Samples per column
+    bool owned;         // columns were allocated by sample_store_alloc()
+    uint32_t* timestamps;  // capacity sample times (ms), nullptr if not kept
+    size_t max_capacity;   // Samples the storage can hold (resize limit)
+} sample_store_t;
+
+// Heap storage for capacity samples (released with sample_store_free)
+bool sample_store_alloc(sample_store_t* store, size_t capacity);
+
+// Caller-provided storage of READ_REGISTER_COUNT * max_capacity values (and max_capacity
+// sample times, or nullptr), used at capacity samples
+void sample_store_attach(sample_store_t* store, uint16_t* storage, uint32_t* timestamps,
+                         size_t max_capacity, size_t capacity);
+
+// Change the capacity in place (no reallocation). The count samples starting at row
+// first (wrapping at the old capacity) become rows 0..count-1; the rest is cleared.
+// False if new_capacity exceeds the storage or cannot hold count samples.
+bool sample_store_resize(sample_store_t* store, size_t new_capacity, size_t first, size_t count);
+
+void sample_store_free(sample_store_t* store);
+void sample_store_clear(sample_store_t* store);
+
+// Write / read one sample (READ_REGISTER_COUNT values)
+void sample_store_set_row(sample_store_t* store, size_t index, const uint16_t* row);
+void sample_store_get_row(const sample_store_t* store, size_t index, uint16_t* row);
+
+inline void sample_store_set_time(sample_store_t* store, size_t index, uint32_t timestamp_ms) {
+    if (store->timestamps != nullptr) {
+        store->timestamps[index] = timestamp_ms;
+    }
+}
+
+// Contiguous column of a register
+inline uint16_t* sample_store_column(sample_store_t* store, size_t reg) {
+    return store->columns + reg * store->capacity;
+}
+
+inline const uint16_t* sample_store_column(const sample_store_t* store, size_t reg) {
+    return store->columns + reg * store->capacity;
+}
+
+inline uint16_t sample_store_get(const sample_store_t* store, size_t index, size_t reg) {
+    return store->columns[reg * store->capacity + index];
+}
+
+// Bytes used by a store with capacity samples (columns and sample times)
+inline size_t sample_store_bytes(size_t capacity) {
+    return capacity * (READ_REGISTER_COUNT * sizeof(uint16_t) + sizeof(uint32_t));
+}
+
+#endif // SAMPLE_STORE_H
@@ -6,6 +6,18 @@
 #include "error_handler.h"
 #include "cloudAPI_handler.h"
 #include "compressor.h"
+#include "sample_times.h"
+#include "varint.h"
+#include "stream_encoder.h"
+#include "history_ring.h"
+#include "sample_ring.h"
+#include "upload_pipeline.h"
+#include "spill_queue.h"
+#include "deadline_queue.h"
+#include "adaptive_sampler.h"
+#include "alarm_rules.h"
+#include "timing_stats.h"
+#include "downsampler.h"
 #include "fota.h"
 #include "encryptionAndSecurity.h"
 #include "esp_task_wdt.h"
@@ -18,22 +30,35 @@ extern NonceManager nonceManager; // Declare the global instance from main.cpp
 
 // Task definitions
 static scheduler_task_t tasks[TASK_COUNT] = {
-    {TASK_READ_REGISTERS, POLL_INTERVAL_MS, 0, true},
-    {TASK_WRITE_REGISTER, WRITE_INTERVAL_MS, 0, false},
-    {TASK_UPLOAD_DATA, UPLOAD_INTERVAL_MS, 0, true},
+    {TASK_READ_REGISTERS, POLL_INTERVAL_MS, true},
+    {TASK_WRITE_REGISTER, WRITE_INTERVAL_MS, false},
+    {TASK_UPLOAD_DATA, UPLOAD_INTERVAL_MS, true},
     // FOTA task removed - now integrated into upload response handling
-    {TASK_COMMAND_HANDLING, COMMAND_INTERVAL_MS, 0, false}
+    {TASK_COMMAND_HANDLING, COMMAND_INTERVAL_MS, false}
 };
+static deadline_queue_t deadlines;  // Next run of each task (indexed by task_type_t)
+static adaptive_sampler_t sampler;  // Read interval from signal activity (ADAPTIVE_SAMPLING)
+static const char* const TASK_NAMES[TASK_COUNT] = {"read", "write", "upload", "command"};
+
+// Per-task timing: totals since boot for the serial dump ('t'), and the window since the
+// last frame, sent as the frame's FRAME_TLV_TASK_TIMING trailer
+static task_timing_t task_timing_total[TASK_COUNT];
+static task_timing_t task_timing_window[TASK_COUNT];
+static portMUX_TYPE timing_mux = portMUX_INITIALIZER_UNLOCKED;  // The acquisition task records from core 0
 
 // Dynamic buffer definition - Buffer Rules Implementation
-static register_reading_t* buffer = nullptr;  // Dynamic buffer allocated based on config
+// The fill buffer lives in a static arena sized for MAX_BUFFER_SAMPLES; config changes
+// only change its logical capacity (see resize_buffer), so the heap is never touched.
+static uint16_t buffer_arena_columns[READ_REGISTER_COUNT * MAX_BUFFER_SAMPLES];
+static uint32_t buffer_arena_times[MAX_BUFFER_SAMPLES];
+static sample_store_t buffer = {nullptr, 0, false, nullptr};  // Column-major fill buffer sized from config
 static size_t buffer_count = 0;
 static size_t buffer_write_index = 0;  // For circular buffer behavior
-static bool upload_in_progress = false;  // Prevents filling during upload
 static bool buffer_full = false;  // Tracks if buffer is full
 static size_t buffer_size = 0;  // Current allocated buffer size
 static uint32_t last_upload_interval = 0;  // Track config changes
 static uint32_t last_sampling_interval = 0;  // Track config changes
+static bool task_config_changed = false;  // Cloud config applied; re-read intervals
 static unsigned long last_upload_attempt = 0;  // For retry delays
 static int upload_retry_count = 0;  // Track retry attempts
 
@@ -45,38 +70,136 @@ static String write_executed_timestamp = ""; // Timestamp of last write executio
 uint8_t compressed_data[MAX_COMPRESSION_SIZE] = {0}; // Output buffer for compression
 size_t compressed_data_len = 0; // Length of compressed data
 compression_metrics_t compression_metrics = {0}; // Metrics of last compression
+static stream_encoder_t stream_encoder;  // Encodes the buffer incrementally as samples arrive
+static uint8_t upload_frame_buffer[UPLOAD_FRAME_MAX];  // [flags][window if aggregated][compressed payload]
+static uint8_t seal_frame_buffer[UPLOAD_FRAME_MAX];  // Fill buffer sealed while an upload is running
+
+// Frozen batch: an upload encodes the fill buffer into upload_frame_buffer and reads continue
+// into the emptied fill buffer. The frame is queued as a history block and the batch is
+// released once that block is acknowledged.
+static size_t upload_buffer_count = 0;  // Samples in the frozen batch, 0 = none
+static uint32_t upload_sequence = 0;  // History block of the frozen batch
+static bool upload_in_history = false;  // false: history was full, frame waits in upload_frame_buffer
+static size_t upload_frame_len = 0;
+static upload_packet_t upload_packet;  // Network stage input (too large for the loop stack)
+static upload_packet_t spill_packet;  // History overflow sealed for flash (may run during a send)
+
+// Alarm frames waiting for the loop (an alarm raised during an upload waits until it is done)
+#define ALARM_FRAME_MAX 96
+static alarm_state_t alarm_state = {0, 0};
+static uint8_t alarm_frames[ALARM_QUEUE_DEPTH][ALARM_FRAME_MAX];
+static size_t alarm_frame_lens[ALARM_QUEUE_DEPTH];
+static size_t alarm_head = 0;
+static size_t alarm_count = 0;
+static uint8_t alarm_sending[ALARM_FRAME_MAX];
+static upload_packet_t alarm_packet;
+
+// Event capture: pre-trigger ring of recent samples, and the capture frozen around an alarm
+#define CAPTURE_PAYLOAD_MAX (FRAME_HEADER_SIZE + READ_REGISTER_COUNT * (2 + 3 * (CAPTURE_MAX_SAMPLES - 1)))  // Whole capture, worst case
+static uint16_t pretrigger_columns[READ_REGISTER_COUNT * CAPTURE_PRE_SAMPLES];
+static uint32_t pretrigger_times[CAPTURE_PRE_SAMPLES];
+static sample_store_t pretrigger = {pretrigger_columns, CAPTURE_PRE_SAMPLES, false, pretrigger_times, CAPTURE_PRE_SAMPLES};
+static size_t pretrigger_next = 0;
+static size_t pretrigger_count = 0;
+static uint16_t capture_columns[READ_REGISTER_COUNT * CAPTURE_MAX_SAMPLES];
+static uint32_t capture_times[CAPTURE_MAX_SAMPLES];
+static sample_store_t capture = {capture_columns, CAPTURE_MAX_SAMPLES, false, capture_times, CAPTURE_MAX_SAMPLES};
+static size_t capture_count = 0;
+static size_t capture_trigger_index = 0;
+static bool capture_active = false;
+static uint32_t capture_trigger_ms = 0;
+static uint32_t capture_rules = 0;
+static uint32_t capture_resume_ms = 0;  // Read interval to return to after the burst
+static uint8_t capture_id = 0;
+static uint8_t capture_payload[CAPTURE_PAYLOAD_MAX];
+static uint8_t capture_frame[UPLOAD_FRAME_MAX];
+static bool read_in_progress = false;  // A read is running (its own retry waits must not sample)
+
+// Acquisition task (ACQUISITION_TASK_ENABLED): producer side of the ring, the loop drains it
+#define ACQUISITION_RING_WIDTH (READ_REGISTER_COUNT + 2)  // Register values, then the sample time (low, high)
+static uint16_t acquisition_ring_storage[ACQUISITION_RING_CAPACITY * ACQUISITION_RING_WIDTH];
+static sample_ring_t acquisition_ring;
+static TaskHandle_t acquisition_task_handle = nullptr;
+static uint32_t acquisition_overflows_logged = 0;
+
+#define AGGREGATED_ROWS (AGG_STAT_COUNT * ((MAX_BUFFER_SAMPLES + AGG_WINDOW - 1) / AGG_WINDOW))
+static uint16_t aggregated_columns[READ_REGISTER_COUNT * AGGREGATED_ROWS];
+static sample_store_t aggregated_buffer = {aggregated_columns, AGGREGATED_ROWS, false, nullptr};
+
+static bool seal_buffer_to_history(void);
+static void run_read_task(void);
+static void sample_while_waiting(unsigned long wait_ms);
+static void drain_acquisition_ring(void);
+static void start_acquisition_task(void);
+static bool spill_history_block(const uint8_t* frame, const history_block_t* info);
+static void apply_task_config(void);
+static void set_task_enabled(task_type_t type, bool enabled);
+static void init_adaptive_sampler(void);
+static uint32_t check_alarms(const uint16_t* values, size_t count, uint32_t timestamp_ms);
+static void capture_sample(const uint16_t* values, size_t count, uint32_t timestamp_ms, uint32_t fired);
+static void send_pending_alarms(void);
+static bool send_upload_packet(const upload_packet_t* packet);
+
+// Pick up the cloud-set tolerances; called before every new batch
+static void load_compression_config(void) {
+    uint16_t tolerances[READ_REGISTER_COUNT];
+    config_get_tolerances(tolerances);
+    compression_set_tolerances(tolerances);
+}
+
+// Attach the fill buffer to the arena (first use, or after free_buffer)
+static void attach_buffer(size_t new_size) {
+    sample_store_attach(&buffer, buffer_arena_columns, buffer_arena_times, MAX_BUFFER_SAMPLES, new_size);
+    sample_store_clear(&buffer);
+    upload_buffer_count = 0;
+    buffer_size = new_size;
+    buffer_count = 0;
+    buffer_write_index = 0;
+    buffer_full = false;
+    load_compression_config();
+    stream_encoder_init(&stream_encoder, COMPRESSION_METHOD);
+}
 
-// Internal buffer allocation with specific size
-static bool allocate_buffer_internal(size_t new_size) {
-    if (new_size == 0) {
-        Serial.println(F("[BUFFER] Cannot allocate buffer with size 0"));
+// Change the capacity of the fill buffer in place, keeping the samples it holds
+static bool resize_buffer(size_t new_size) {
+    if (new_size == 0 || new_size > MAX_BUFFER_SAMPLES) {
+        Serial.printf("[BUFFER] Cannot size buffer to %zu samples\n", new_size);
         return false;
     }
-    
-    // Free existing buffer if it exists
-    if (buffer != nullptr) {
-        free(buffer);
-        buffer = nullptr;
+    if (buffer.columns == nullptr) {
+        attach_buffer(new_size);
+        Serial.printf("[BUFFER] Sample buffer: %zu samples (%zu bytes, arena %u samples)\n",
+                      buffer_size, sample_store_bytes(buffer_size), (unsigned)MAX_BUFFER_SAMPLES);
+        return true;
     }
-    
-    // Allocate new buffer
-    buffer = (register_reading_t*)malloc(new_size * sizeof(register_reading_t));
-    if (buffer == nullptr) {
-        Serial.printf("[BUFFER] ERROR: Failed to allocate %zu bytes for buffer\n", 
-                     new_size * sizeof(register_reading_t));
-        buffer_size = 0;
-        return false;
+    if (new_size == buffer_size) {
+        return true;
     }
-    
-    // Initialize buffer to zero
-    memset(buffer, 0, new_size * sizeof(register_reading_t));
+
+    // A batch that would not fit with room for the next sample is sealed as it stands
+    if (buffer_count + 1 > new_size && seal_buffer_to_history()) {
+        Serial.println(F("[BUFFER] Batch sealed before shrinking the buffer"));
+    }
+
+    // Oldest sample first: row 0, or the write index once a circular buffer has wrapped
+    size_t first = buffer_full ? buffer_write_index : 0;
+    size_t keep = buffer_count;
+    if (keep + 1 > new_size) {
+        keep = new_size - 1;  // History full: only the newest samples fit
+        first = (first + buffer_count - keep) % buffer_size;
+        Serial.printf("[BUFFER] Dropping %zu oldest samples to shrink the buffer\n", buffer_count - keep);
+    }
+    if (first != 0 || keep != buffer_count) {
+        stream_encoder_invalidate(&stream_encoder);  // Upload falls back to batch compression
+    }
+    sample_store_resize(&buffer, new_size, first, keep);
+
+    Serial.printf("[BUFFER] Resized sample buffer in place: %zu -> %zu samples, %zu kept\n",
+                  buffer_size, new_size, keep);
     buffer_size = new_size;
-    buffer_count = 0;
-    buffer_write_index = 0;
+    buffer_count = keep;
+    buffer_write_index = keep;
     buffer_full = false;
-    
-    Serial.printf("[BUFFER] Allocated dynamic buffer: %zu samples (%zu bytes)\n", 
-                 buffer_size, buffer_size * sizeof(register_reading_t));
     return true;
 }
 
@@ -84,7 +207,7 @@ static bool allocate_buffer_internal(size_t new_size) {
 void allocate_buffer() {
     if (!g_config_manager || !g_config_manager->is_initialized()) {
         Serial.println(F("[BUFFER] Config manager not initialized, using default size"));
-        allocate_buffer_internal(MEMORY_BUFFER_SIZE);
+        resize_buffer(MEMORY_BUFFER_SIZE);
         return;
     }
     
@@ -93,34 +216,34 @@ void allocate_buffer() {
     
     if (upload_interval == 0 || sampling_interval == 0) {
         Serial.println(F("[BUFFER] Invalid intervals, using default buffer size"));
-        allocate_buffer_internal(MEMORY_BUFFER_SIZE);
+        resize_buffer(MEMORY_BUFFER_SIZE);
         return;
     }
     
     size_t calculated_buffer_size = (upload_interval / sampling_interval) + 1;
     
     // Enforce reasonable limits
-    if (calculated_buffer_size < 5) {
-        calculated_buffer_size = 5;
-    } else if (calculated_buffer_size > 100) {
-        calculated_buffer_size = 100;
+    if (calculated_buffer_size < MIN_BUFFER_SAMPLES) {
+        calculated_buffer_size = MIN_BUFFER_SAMPLES;
+    } else if (calculated_buffer_size > MAX_BUFFER_SAMPLES) {
+        calculated_buffer_size = MAX_BUFFER_SAMPLES;
     }
     
     Serial.printf("[BUFFER] Calculating buffer size: %ums / %ums + 1 = %zu samples\n", 
                  upload_interval, sampling_interval, calculated_buffer_size);
     
-    allocate_buffer_internal(calculated_buffer_size);
+    resize_buffer(calculated_buffer_size);
 }
 
 void free_buffer() {
-    if (buffer != nullptr) {
-        free(buffer);
-        buffer = nullptr;
+    if (buffer.columns != nullptr) {
+        sample_store_free(&buffer);
+        upload_buffer_count = 0;
         buffer_size = 0;
         buffer_count = 0;
         buffer_write_index = 0;
         buffer_full = false;
-        Serial.println(F("[BUFFER] Dynamic buffer freed"));
+        Serial.println(F("[BUFFER] Buffer released (arena stays reserved)"));
     }
 }
 
@@ -129,7 +252,20 @@ void scheduler_init() {
     Serial.println("[SCHEDULER] Initializing scheduler with dynamic buffer...");
     
     // Allocate initial buffer based on current configuration
+    deadline_init(&deadlines);
+    init_adaptive_sampler();
     allocate_buffer();
+    apply_task_config();
+    history_init();
+    upload_pipeline_init();
+    if (SPILL_ENABLED && spill_init()) {
+        history_set_overflow_hook(spill_history_block);  // Full history spills to flash instead of dropping
+    }
+    api_set_wait_hook(sample_while_waiting);  // Keep sampling through upload retry backoff
+
+    if (ACQUISITION_TASK_ENABLED) {
+        start_acquisition_task();
+    }
     
     Serial.println("[SCHEDULER] Scheduler initialization complete");
 }
@@ -138,145 +274,257 @@ void scheduler_init() {
 const PROGMEM float REGISTER_GAINS[MAX_REGISTERS] = {10.0, 10.0, 100.0, 10.0, 10.0, 10.0, 10.0, 10.0, 1.0, 1.0};
 const PROGMEM char* REGISTER_UNITS[MAX_REGISTERS] = {"V", "A", "Hz", "V", "V", "A", "A", "°C", "%", "W"};
 const PROGMEM uint16_t READ_REGISTERS[READ_REGISTER_COUNT] = {0x0000, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x0007, 0x0008, 0x0009};
+const PROGMEM uint8_t REGISTER_COLUMN_CODECS[READ_REGISTER_COUNT] = {
+    COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY,
+    COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY
+};
+// Vac1, Iac1, Fac, Vpv1, Vpv2, Ipv1, Ipv2, Temp, Export %, Pac
+const PROGMEM uint8_t REGISTER_QUANT_IMPORTANCE[READ_REGISTER_COUNT] = {4, 4, 5, 2, 2, 2, 2, 0, 9, 6};
+const PROGMEM uint8_t REGISTER_MAX_QUANT_SHIFT[READ_REGISTER_COUNT] = {4, 4, 3, 5, 5, 4, 4, 4, 0, 4};
+// Raw units (see REGISTER_GAINS): Vac1 0.1 V, Fac 0.01 Hz, Temp 0.1 °C, Pac W
+static const alarm_rule_t ALARM_RULES[] = {
+    {0, ALARM_EDGE_RISING, 2530, 50},   // Grid over-voltage, 253 V
+    {0, ALARM_EDGE_FALLING, 2070, 50},  // Grid under-voltage, 207 V
+    {2, ALARM_EDGE_RISING, 5150, 20},   // Over-frequency, 51.5 Hz
+    {2, ALARM_EDGE_FALLING, 4850, 20},  // Under-frequency, 48.5 Hz
+    {7, ALARM_EDGE_RISING, 750, 50},    // Inverter over-temperature, 75 °C
+    {9, ALARM_EDGE_RISING, 5000, 500},  // Output power spike, 5 kW
+};
+#define ALARM_RULE_COUNT (sizeof(ALARM_RULES) / sizeof(ALARM_RULES[0]))
 
-void scheduler_run(void) {
-    unsigned long current_time = millis();
-    
-    // Update task intervals from ConfigManager if available
+// 5 V/s, 1 A/s, 0.1 Hz/s, 5 V/s, 5 V/s, 1 A/s, 1 A/s, -, any export change, 200 W/s
+const PROGMEM uint16_t REGISTER_ACTIVITY_THRESHOLD[READ_REGISTER_COUNT] = {50, 10, 10, 50, 50, 10, 10, 0, 1, 200};
+
+static void init_adaptive_sampler(void) {
+    uint16_t thresholds[READ_REGISTER_COUNT];
+    for (size_t i = 0; i < READ_REGISTER_COUNT; i++) {
+        thresholds[i] = pgm_read_word(&REGISTER_ACTIVITY_THRESHOLD[i]);
+    }
+    adaptive_init(&sampler, ADAPTIVE_MIN_INTERVAL_MS, ADAPTIVE_MAX_INTERVAL_MS, ADAPTIVE_QUIET_PCT,
+                  ADAPTIVE_QUIET_SAMPLES, thresholds, READ_REGISTER_COUNT);
+}
+
+static void set_read_interval(uint32_t interval_ms, const char* reason) {
+    if (interval_ms == tasks[TASK_READ_REGISTERS].interval_ms) {
+        return;
+    }
+    Serial.printf("[%s] Read interval %lu -> %lu ms\n", reason, (unsigned long)tasks[TASK_READ_REGISTERS].interval_ms,
+                  (unsigned long)interval_ms);
+    tasks[TASK_READ_REGISTERS].interval_ms = interval_ms;
+    deadline_set_period(&deadlines, TASK_READ_REGISTERS, interval_ms, millis());
+}
+
+// Follow signal activity: the next read comes after the interval the sampler picked
+static void adapt_read_interval(const register_reading_t* reading) {
+    uint32_t interval_ms = adaptive_update(&sampler, reading->values, reading->timestamp_ms);
+    if (!capture_active) {  // A capture burst holds the rate until it ends
+        set_read_interval(interval_ms, "ADAPTIVE");
+    }
+}
+
+// Take task intervals from ConfigManager and resize the buffer when they change.
+// Runs at init and after cloud configuration is applied, not on every pass.
+static void apply_task_config(void) {
     if (g_config_manager && g_config_manager->is_initialized()) {
         tasks[TASK_READ_REGISTERS].interval_ms = config_get_sampling_interval_ms();
+        if (ADAPTIVE_SAMPLING) {
+            // Only a new configured interval restarts adaptation
+            tasks[TASK_READ_REGISTERS].interval_ms = adaptive_configure(&sampler, config_get_sampling_interval_ms());
+        }
         tasks[TASK_UPLOAD_DATA].interval_ms = config_get_upload_interval_ms();
         // Couple command interval to upload interval for synchronized timing
         tasks[TASK_COMMAND_HANDLING].interval_ms = config_get_upload_interval_ms();
+        if (capture_active) {
+            capture_resume_ms = tasks[TASK_READ_REGISTERS].interval_ms;  // Applied when the burst ends
+            tasks[TASK_READ_REGISTERS].interval_ms = CAPTURE_BURST_INTERVAL_MS;
+        }
+        for (int i = 0; i < TASK_COUNT; i++) {
+            deadline_set_period(&deadlines, i, tasks[i].interval_ms, millis());
+        }
         
         // Recalculate buffer size only when configuration changes
         uint32_t upload_interval = config_get_upload_interval_ms();
         uint32_t sampling_interval = config_get_sampling_interval_ms();
         
-        if (upload_interval != last_upload_interval || sampling_interval != last_sampling_interval || buffer == nullptr) {
-            // Configuration changed or buffer not allocated - reallocate buffer
+        if (upload_interval != last_upload_interval || sampling_interval != last_sampling_interval || buffer.columns == nullptr) {
+            // Configuration changed or buffer not attached - resize buffer
             Serial.printf("[BUFFER] Config changed: upload %u->%u, sampling %u->%u\n", 
                          last_upload_interval, upload_interval, last_sampling_interval, sampling_interval);
             
-            size_t calculated_buffer_size = (upload_interval / sampling_interval) + 2; // +2 for safety margin
+            // Adaptive reads may run at the floor: size a batch for that rate
+            uint32_t fastest_interval = sampling_interval;
+            if (ADAPTIVE_SAMPLING && ADAPTIVE_MIN_INTERVAL_MS < fastest_interval) {
+                fastest_interval = ADAPTIVE_MIN_INTERVAL_MS;
+            }
+            size_t calculated_buffer_size = (upload_interval / fastest_interval) + 2; // +2 for safety margin
             
             // Set reasonable limits
-            if (calculated_buffer_size < 5) calculated_buffer_size = 5;   // Minimum 5 samples
-            if (calculated_buffer_size > 100) calculated_buffer_size = 100; // Maximum 100 samples
+            if (calculated_buffer_size < MIN_BUFFER_SAMPLES) calculated_buffer_size = MIN_BUFFER_SAMPLES;
+            if (calculated_buffer_size > MAX_BUFFER_SAMPLES) calculated_buffer_size = MAX_BUFFER_SAMPLES;
             
             Serial.printf("[BUFFER] Calculation: %u / %u + 2 = %zu\n", 
-                         upload_interval, sampling_interval, calculated_buffer_size);
+                         upload_interval, fastest_interval, calculated_buffer_size);
             
-            // Reallocate buffer with new size
-            if (allocate_buffer_internal(calculated_buffer_size)) {
+            // Resize the buffer in place, keeping the samples already taken
+            if (resize_buffer(calculated_buffer_size)) {
                 last_upload_interval = upload_interval;
                 last_sampling_interval = sampling_interval;
-                Serial.printf("[BUFFER] Dynamic buffer allocated: %zu samples (upload: %us, sampling: %us)\n\r", 
+                Serial.printf("[BUFFER] Dynamic buffer resized: %zu samples (upload: %us, sampling: %us)\n\r", 
                              buffer_size, upload_interval/1000, sampling_interval/1000);
             } else {
-                Serial.println(F("[BUFFER] ERROR: Failed to allocate dynamic buffer, using fallback"));
+                Serial.println(F("[BUFFER] ERROR: Failed to resize dynamic buffer, keeping the current size"));
                 // Keep old values to prevent infinite reallocation attempts
             }
         }
     }
+}
 
-    for (int i = 0; i < TASK_COUNT; i++) {
-        if (!tasks[i].enabled) {
+static void record_task_timing(task_type_t type, uint32_t lateness_ms, uint32_t runtime_ms, uint32_t missed) {
+    taskENTER_CRITICAL(&timing_mux);
+    timing_record(&task_timing_total[type], lateness_ms, runtime_ms);
+    timing_add_missed(&task_timing_total[type], missed);
+    timing_record(&task_timing_window[type], lateness_ms, runtime_ms);
+    timing_add_missed(&task_timing_window[type], missed);
+    taskEXIT_CRITICAL(&timing_mux);
+}
+
+static void print_timing_histogram(const char* label, const timing_histogram_t* histogram) {
+    Serial.printf("         %s:", label);
+    for (size_t i = 0; i < TIMING_BUCKETS; i++) {
+        if (histogram->buckets[i] == 0) {
             continue;
         }
-        
-        if (current_time - tasks[i].last_run_ms >= tasks[i].interval_ms) {
-            // Update last_run_ms BEFORE executing task to prevent re-triggering
-            tasks[i].last_run_ms = current_time;
-            
-            switch (tasks[i].type) {
-                case TASK_READ_REGISTERS:
-                    execute_read_task();
-                    if (POWER_MANAGMENT) {
-                        current_time = millis();
-                        unsigned long read_slack = tasks[i].interval_ms - (current_time - tasks[i].last_run_ms);
-                        unsigned long upload_slack = tasks[2].interval_ms - (current_time - tasks[2].last_run_ms);
-                        if (read_slack > 0 && upload_slack > 0) {
-                            if (read_slack < upload_slack) {
-                                if (LIGHT_SLEEP) {
-                                    esp_err_t timer_result = esp_sleep_enable_timer_wakeup(read_slack * 1000); // micro_seconds
-                                    if (timer_result == ESP_OK){
-                                        Serial.println("Timer Success");
-                                    };
-                                    Serial.flush();
-                                    esp_err_t wakeup_result = esp_light_sleep_start(); 
-                                    if (wakeup_result == ESP_OK) {
-                                        Serial.printf("Read Slack: %lu\n\r", read_slack);
-                                        unsigned long wakeup_time = millis();
-                                        Serial.printf("Light Sleep Time: %lu\n\r", wakeup_time - current_time);
-                                        Serial.begin(SERIAL_BAUD_RATE);
-                                        wifi_init();
-                                        Serial.printf("Wifi Reconnection Time: %lu\n\r", millis() - wakeup_time);
-                                    };
-                                } else if (IDLE_DELAY) {
-                                    delay(read_slack);
-                                };
-                            } else {
-                                if (LIGHT_SLEEP) {
-                                    esp_sleep_enable_timer_wakeup(upload_slack * 1000); // micro_seconds
-                                    Serial.flush();
-                                    esp_light_sleep_start();
-                                    Serial.begin(SERIAL_BAUD_RATE);
-                                    wifi_init();
-                                } else if (IDLE_DELAY) {
-                                    delay(upload_slack);
-                                };
-                            };                        
-                        };
-                    };
-                    break;
-                case TASK_COMMAND_HANDLING:
-                    execute_command_task();
-                    break;
-                case TASK_UPLOAD_DATA:
-                    execute_upload_task();
-                    if (POWER_MANAGMENT) {
-                        current_time = millis();
-                        unsigned long read_slack = tasks[i].interval_ms - (current_time - tasks[i].last_run_ms);
-                        if (read_slack > 0) {
-                            if (LIGHT_SLEEP) {
-                                esp_sleep_enable_timer_wakeup(read_slack * 1000); // micro_seconds
-                                Serial.flush();
-                                esp_light_sleep_start();
-                                Serial.begin(SERIAL_BAUD_RATE);
-                                wifi_init();
-                            } else if (IDLE_DELAY) {
-                                delay(read_slack);
-                            };                     
-                        };
-                    };
-                    break;
-                // FOTA task removed - now handled in upload response
-                // WRITE task removed - now executes immediately when command received
-                default:
-                    break;
-            }
+        uint32_t limit = timing_bucket_limit(i);
+        if (limit) {
+            Serial.printf(" <%lu:%u", (unsigned long)limit, histogram->buckets[i]);
+        } else {
+            Serial.printf(" >=%lu:%u", (unsigned long)timing_bucket_limit(i - 1), histogram->buckets[i]);
         }
     }
-    
+    Serial.println();
+}
+
+static void print_task_timing(void) {
+    task_timing_t totals[TASK_COUNT];
+    taskENTER_CRITICAL(&timing_mux);
+    memcpy(totals, task_timing_total, sizeof(totals));
+    taskEXIT_CRITICAL(&timing_mux);
+
+    Serial.println(F("[TIMING] Task timing since boot (ms buckets, <limit:count)"));
+    for (int i = 0; i < TASK_COUNT; i++) {
+        Serial.printf("[TIMING] %-7s runs %u, missed %u, skipped slots %lu\n", TASK_NAMES[i], totals[i].runs,
+                      totals[i].missed, (unsigned long)deadlines.entries[i].skipped);
+        if (totals[i].runs) {
+            print_timing_histogram("lateness", &totals[i].lateness_ms);
+            print_timing_histogram("runtime ", &totals[i].runtime_ms);
+        }
+    }
+}
+
+// Serial console: 't' dumps the task timing
+static void handle_serial_input(void) {
+    while (Serial.available() > 0) {
+        if (Serial.read() == 't') {
+            print_task_timing();
+        }
+    }
+}
+
+static void run_task(task_type_t type) {
+    switch (type) {
+        case TASK_READ_REGISTERS:
+            run_read_task();
+            break;
+        case TASK_COMMAND_HANDLING:
+            execute_command_task();
+            break;
+        case TASK_UPLOAD_DATA:
+            execute_upload_task();
+            break;
+        // FOTA task removed - now handled in upload response
+        // WRITE task removed - now executes immediately when command received
+        default:
+            break;
+    }
+}
+
+// Run a task taken from the deadline queue and record how late it started and how long it ran
+static void run_timed_task(task_type_t type, const deadline_slot_t* slot) {
+    uint32_t start = millis();
+    run_task(type);
+    record_task_timing(type, start - slot->due_ms, millis() - start, slot->missed);
+}
+
+// Block until the next deadline. Light sleep when power management allows it (not while
+// the acquisition task samples), otherwise delay() so the idle task can let DFS act.
+static void idle_until_next_deadline(void) {
+    uint32_t wait_ms = deadline_wait_ms(&deadlines, millis());
+    uint32_t max_wait_ms = acquisition_task_handle ? tasks[TASK_READ_REGISTERS].interval_ms : SCHEDULER_MAX_IDLE_MS;
+    if (wait_ms > max_wait_ms) {
+        wait_ms = max_wait_ms;  // Keep feeding the watchdog / draining the acquisition ring
+    }
+    if (wait_ms == 0) {
+        return;
+    }
+
+    if (POWER_MANAGMENT && LIGHT_SLEEP && !acquisition_task_handle && wait_ms >= LIGHT_SLEEP_MIN_MS) {
+        unsigned long sleep_start = millis();
+        esp_sleep_enable_timer_wakeup((uint64_t)wait_ms * 1000); // micro_seconds
+        Serial.flush();
+        if (esp_light_sleep_start() == ESP_OK) {
+            unsigned long wakeup_time = millis();
+            Serial.begin(SERIAL_BAUD_RATE);
+            Serial.printf("Slack: %lu, Light Sleep Time: %lu\n\r", (unsigned long)wait_ms, wakeup_time - sleep_start);
+            wifi_init();
+            Serial.printf("Wifi Reconnection Time: %lu\n\r", millis() - wakeup_time);
+        }
+        return;
+    }
+    delay(wait_ms);
+}
+
+void scheduler_run(void) {
+    if (task_config_changed || buffer.columns == nullptr) {
+        task_config_changed = false;
+        apply_task_config();  // New intervals, or buffers not attached yet
+    }
+
+    if (acquisition_task_handle) {
+        drain_acquisition_ring();
+    }
+    handle_serial_input();
+    send_pending_alarms();
+
+    // Run every task whose deadline has passed, earliest first
+    int due;
+    deadline_slot_t slot;
+    while ((due = deadline_pop_due(&deadlines, millis(), &slot)) >= 0) {
+        if (tasks[due].enabled) {
+            run_timed_task(tasks[due].type, &slot);
+        }
+        send_pending_alarms();  // Raised by the read just taken: out of the upload cycle
+        feed_watchdog();
+    }
+
     // Feed watchdog
     feed_watchdog();
+    idle_until_next_deadline();
 }
 
 
-void store_register_reading(const uint16_t* values, size_t count) {
+void store_register_reading(const uint16_t* values, size_t count, uint32_t timestamp_ms) {
+    // Alarms and event captures do not depend on buffer space
+    uint32_t fired = ALARM_ENABLED ? check_alarms(values, count, timestamp_ms) : 0;
+    if (CAPTURE_ENABLED) {
+        capture_sample(values, count, timestamp_ms, fired);
+    }
+
     // Check if buffer is allocated
-    if (buffer == nullptr || buffer_size == 0) {
+    if (buffer.columns == nullptr || buffer_size == 0) {
         Serial.println(F("[BUFFER] ERROR: Buffer not allocated, skipping sample"));
         return;
     }
     
-    // Always stop filling buffer during upload (workflow requirement)
-    if (upload_in_progress) {
-        Serial.println(F("[BUFFER] Skipping sample - upload in progress"));
-        return;
-    }
-    
     // Check buffer full behavior when not uploading
     if (buffer_full) {
         #if BUFFER_FULL_BEHAVIOR == BUFFER_FULL_BEHAVIOR_STOP
@@ -292,18 +540,32 @@ void store_register_reading(const uint16_t* values, size_t count) {
         count = READ_REGISTER_COUNT;
     }
 
-    register_reading_t* reading = &buffer[buffer_write_index];
+    // Overwriting the oldest sample breaks the streamed batch; upload falls back to batch compression
+    if (buffer_full) {
+        stream_encoder_invalidate(&stream_encoder);
+    }
+
+    register_reading_t reading;
 
     // Copy values to the current reading
     for (size_t i = 0; i < count; i++) {
-        reading->values[i] = values[i];
+        reading.values[i] = values[i];
     }
     
     // Fill remaining with zeros
     for (size_t i = count; i < READ_REGISTER_COUNT; i++) {
-        reading->values[i] = 0;
+        reading.values[i] = 0;
+    }
+    reading.timestamp_ms = timestamp_ms;
+    sample_store_set_row(&buffer, buffer_write_index, reading.values);
+    sample_store_set_time(&buffer, buffer_write_index, reading.timestamp_ms);
+    if (ADAPTIVE_SAMPLING) {
+        adapt_read_interval(&reading);
     }
 
+    // Encode the sample now so the frame is ready when the upload task fires
+    stream_encoder_push(&stream_encoder, reading.values);
+
     // Advance write index (circular buffer)
     buffer_write_index = (buffer_write_index + 1) % buffer_size;
 
@@ -311,6 +573,10 @@ void store_register_reading(const uint16_t* values, size_t count) {
     if (!buffer_full) {
         buffer_count++;
         if (buffer_count >= buffer_size) {
+            // Keep the full batch as a compressed history block and start a new one
+            if (seal_buffer_to_history()) {
+                return;
+            }
             buffer_full = true;
             #if BUFFER_FULL_BEHAVIOR == BUFFER_FULL_BEHAVIOR_CIRCULAR
                 Serial.println(F("[BUFFER] Buffer full - using circular overwrite"));
@@ -335,7 +601,7 @@ void store_register_reading(const uint16_t* values, size_t count) {
         // Serial.println(F(")"));
         // for (size_t i = 0; i < buffer_count; i++) {
         //         for (size_t j = 0; j < READ_REGISTER_COUNT; j++) {
-        //             Serial.print(buffer[i].values[j]);
+        //             Serial.print(sample_store_get(&buffer, i, j));
         //             Serial.print(F(" "));
         //         }
         //         Serial.println(F("|"));
@@ -346,6 +612,7 @@ void store_register_reading(const uint16_t* values, size_t count) {
 
 void execute_read_task(void) {
     Serial.println(F("Executing read task..."));
+    uint32_t sample_ms = millis();  // Deadline-aligned; the request latency below varies
     
     // Get current configuration
     uint8_t slave_addr = config_get_slave_address();
@@ -357,8 +624,8 @@ void execute_read_task(void) {
     uint16_t start_register = (register_count > 0) ? active_registers[0] : pgm_read_word(&READ_REGISTERS[0]);
     
     // Generate read frame
-    String frame = format_request_frame(slave_addr, FUNCTION_CODE_READ, start_register, register_count);
-    frame = append_crc_to_frame(frame);
+    uint8_t frame[MODBUS_REQUEST_SIZE];
+    size_t frame_length = format_request_frame(frame, sizeof(frame), slave_addr, FUNCTION_CODE_READ, start_register, register_count);
     
     String url;
     url.reserve(128);
@@ -366,15 +633,25 @@ void execute_read_task(void) {
     url += "/api/inverter/read";
     String method = "POST";
     String api_key = API_KEY;
-    String response = api_send_request_with_retry(url, method, api_key, frame);
+    uint8_t response[MODBUS_MAX_FRAME];
+    size_t response_length = api_send_request_with_retry(url, method, api_key, frame, frame_length, response, sizeof(response));
     
-    if (response.length() > 0) {
-        uint16_t read_values[READ_REGISTER_COUNT];
+    if (response_length > 0) {
+        uint16_t read_values[ACQUISITION_RING_WIDTH];
         size_t actual_count;
 
-        if (decode_response_registers(response, read_values, READ_REGISTER_COUNT, &actual_count)) {
-            // Store raw values
-            store_register_reading(read_values, actual_count);
+        if (decode_response_registers(response, response_length, read_values, READ_REGISTER_COUNT, &actual_count)) {
+            // Store raw values (queued for the loop when reads run in their own task)
+            if (acquisition_task_handle) {
+                for (size_t i = actual_count; i < READ_REGISTER_COUNT; i++) {
+                    read_values[i] = 0;
+                }
+                read_values[READ_REGISTER_COUNT] = (uint16_t)sample_ms;
+                read_values[READ_REGISTER_COUNT + 1] = (uint16_t)(sample_ms >> 16);
+                sample_ring_push(&acquisition_ring, read_values);
+            } else {
+                store_register_reading(read_values, actual_count, sample_ms);
+            }
             
             // Display processed values
             for (size_t i = 0; i < actual_count; i++) {
@@ -401,7 +678,7 @@ void execute_write_task(void) {
     
     if (!current_command.pending) {
         Serial.println(F("[WRITE] No pending command - skipping"));
-        tasks[TASK_WRITE_REGISTER].enabled = false;
+        set_task_enabled(TASK_WRITE_REGISTER, false);
         return;
     }
     
@@ -414,9 +691,8 @@ void execute_write_task(void) {
         return;
     }
 
-    String frame = format_request_frame(SLAVE_ADDRESS, FUNCTION_CODE_WRITE, target_register, export_power_value);
-
-    frame = append_crc_to_frame(frame);
+    uint8_t frame[MODBUS_REQUEST_SIZE];
+    size_t frame_length = format_request_frame(frame, sizeof(frame), SLAVE_ADDRESS, FUNCTION_CODE_WRITE, target_register, export_power_value);
     
     String url;
     url.reserve(128);
@@ -424,12 +700,14 @@ void execute_write_task(void) {
     url += "/api/inverter/write";
     String method = "POST";
     String api_key = API_KEY;
-    String response = api_send_request_with_retry(url, method, api_key, frame);
+    uint8_t response[MODBUS_MAX_FRAME];
+    size_t response_length = api_send_request_with_retry(url, method, api_key, frame, frame_length, response, sizeof(response));
     
-    if (response.length() > 0) {
-        if (validate_modbus_response(response)) {
-            if (is_exception_response(response)) {
-                uint8_t exception_code = get_exception_code(response);
+    if (response_length > 0) {
+        modbus_response_t parsed;
+        if (validate_modbus_response(response, response_length, &parsed)) {
+            if (is_exception_response(&parsed)) {
+                uint8_t exception_code = get_exception_code(&parsed);
                 char error_msg[64];
                 snprintf(error_msg, sizeof(error_msg), "Write failed with exception: 0x%02X", exception_code);
                 log_error(ERROR_MODBUS_EXCEPTION, error_msg);
@@ -449,53 +727,307 @@ void execute_write_task(void) {
     }
 }
 
-void execute_upload_task(void) {
-    upload_in_progress = true;  // Prevent buffer filling during upload
+// Clear the buffer once its samples are uploaded or sealed into history
+static void reset_buffer(void) {
+    buffer_count = 0;
+    buffer_write_index = 0;
+    buffer_full = false;
+    sample_store_clear(&buffer);
+    load_compression_config();
+    stream_encoder_reset(&stream_encoder);
+    adaptive_begin_batch(&sampler);
+}
 
-    bool use_aggregation = false;
-    
-    // Check if we have data to upload
-    if (buffer_count == 0) {
-        Serial.println(F("[COMPRESSION] No data to compress and upload"));
-        upload_in_progress = false;  // Re-enable filling
+// Append a trailer record whose value was written at frame + frame_len + 2
+static size_t close_trailer_record(uint8_t* frame, size_t frame_len, uint8_t type, size_t value_len) {
+    frame[0] |= FRAME_FLAG_TRAILER;
+    frame[frame_len] = type;
+    frame[frame_len + 1] = (uint8_t)value_len;
+    return 2 + value_len;
+}
+
+// Time of every sample of the batch as a FRAME_TLV_SAMPLE_TIMES record; returns the bytes added.
+// Irregular times are retried at coarser resolutions until the record fits.
+static size_t append_sample_times(const sample_store_t* samples, size_t count, uint8_t* frame,
+                                  size_t frame_len, size_t capacity) {
+    if (samples->timestamps == nullptr || count == 0) {
+        return 0;
+    }
+    size_t room = capacity > frame_len + 2 ? capacity - frame_len - 2 : 0;
+    if (room > UINT8_MAX) {
+        room = UINT8_MAX;
+    }
+
+    sample_times_header_t header;
+    header.unix_time = time_unix_ms_at(samples->timestamps[0], &header.base_ms);
+    if (!header.unix_time) {
+        header.base_ms = samples->timestamps[0];  // Uptime only; the cloud aligns it to the upload time
+    }
+    header.count = count;
+    header.resolution_ms = SAMPLE_TIME_RESOLUTION_MS;
+    size_t value_len = sample_times_encode_fitted(&header, tasks[TASK_READ_REGISTERS].interval_ms,
+                                                  SAMPLE_TIME_MAX_RESOLUTION_MS, samples->timestamps,
+                                                  frame + frame_len + 2, room);
+    if (value_len > 0) {
+        return close_trailer_record(frame, frame_len, FRAME_TLV_SAMPLE_TIMES, value_len);
+    }
+    Serial.println(F("[UPLOAD] Sample times do not fit the frame trailer, sent without them"));
+    return 0;
+}
+
+// One-sample frame for fired alarm rules: the sample, its time and a FRAME_TLV_ALARM record.
+// Encoded like any batch frame, so the cloud decodes it with the usual path.
+static size_t build_alarm_frame(const uint16_t* values, uint32_t timestamp_ms, uint32_t fired,
+                                uint8_t* frame, size_t capacity) {
+    static uint16_t alarm_columns[READ_REGISTER_COUNT];
+    static uint32_t alarm_time;
+    sample_store_t sample = {alarm_columns, 1, false, &alarm_time, 1};
+    sample_store_set_row(&sample, 0, values);
+    sample_store_set_time(&sample, 0, timestamp_ms);
+
+    uint8_t payload[ALARM_FRAME_MAX];
+    compression_metrics_t metrics = compress_buffer(COMPRESSION_METHOD, &sample, 1, payload, sizeof(payload));
+    size_t payload_len = metrics.compressed_payload_size;
+    if (payload_len < FRAME_HEADER_SIZE || 1 + payload_len + 2 > capacity) {
+        return 0;
+    }
+    frame[0] = (uint8_t)(metrics.method_id << FRAME_METHOD_SHIFT);
+    if (metrics.predicted) {
+        frame[0] |= FRAME_FLAG_PREDICTED;
+    }
+    memcpy(frame + 1, payload, payload_len);
+    size_t frame_len = 1 + payload_len;
+
+    size_t value_len = alarm_encode(ALARM_RULES, ALARM_RULE_COUNT, fired, frame + frame_len + 2,
+                                    capacity - frame_len - 2);
+    if (value_len == 0) {
+        return 0;
+    }
+    frame_len += close_trailer_record(frame, frame_len, FRAME_TLV_ALARM, value_len);
+    frame_len += append_sample_times(&sample, 1, frame, frame_len, capacity);
+    return frame_len;
+}
+
+static uint32_t check_alarms(const uint16_t* values, size_t count, uint32_t timestamp_ms) {
+    uint16_t row[READ_REGISTER_COUNT] = {0};
+    memcpy(row, values, (count < READ_REGISTER_COUNT ? count : READ_REGISTER_COUNT) * sizeof(uint16_t));
+    uint32_t fired = alarm_evaluate(&alarm_state, ALARM_RULES, ALARM_RULE_COUNT, row, READ_REGISTER_COUNT);
+    if (fired == 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < ALARM_RULE_COUNT; i++) {
+        if (fired & ((uint32_t)1 << i)) {
+            Serial.printf("[ALARM] Rule %u: R%u %s %u (value %u)\n", (unsigned)i, ALARM_RULES[i].reg,
+                          ALARM_RULES[i].edge == ALARM_EDGE_RISING ? ">=" : "<=", ALARM_RULES[i].threshold,
+                          row[ALARM_RULES[i].reg]);
+        }
+    }
+
+    if (alarm_count == ALARM_QUEUE_DEPTH) {
+        // Queue full (uploads failing): the oldest alarm goes out with the next batches instead
+        history_append(alarm_frames[alarm_head], alarm_frame_lens[alarm_head], 1);
+        alarm_head = (alarm_head + 1) % ALARM_QUEUE_DEPTH;
+        alarm_count--;
+    }
+    size_t slot = (alarm_head + alarm_count) % ALARM_QUEUE_DEPTH;
+    alarm_frame_lens[slot] = build_alarm_frame(row, timestamp_ms, fired, alarm_frames[slot], ALARM_FRAME_MAX);
+    if (alarm_frame_lens[slot] == 0) {
+        log_error(ERROR_COMPRESSION_FAILED, "Alarm frame could not be built");
+        return fired;
+    }
+    alarm_count++;
+    return fired;
+}
+
+// Freeze the capture into lossless (bit-packed delta) frames of at most MAX_PAYLOAD_SIZE, each
+// tagged with a FRAME_TLV_CAPTURE record and its sample times, and queue them in history for upload
+static void finish_capture(void) {
+    size_t parts = 0;
+    size_t first = 0;
+    while (first < capture_count) {
+        sample_store_t chunk = capture;
+        chunk.columns += first;
+        chunk.timestamps += first;
+
+        // Largest run of samples that still fits one frame
+        size_t count = capture_count - first;
+        compression_metrics_t metrics;
+        for (;;) {
+            metrics = compress_bitpack(&chunk, count, capture_payload, sizeof(capture_payload));
+            if ((metrics.compressed_payload_size >= FRAME_HEADER_SIZE &&
+                 metrics.compressed_payload_size <= MAX_PAYLOAD_SIZE) || count == 1) {
+                break;
+            }
+            count = (count + 1) / 2;
+        }
+        size_t payload_len = metrics.compressed_payload_size;
+        if (payload_len < FRAME_HEADER_SIZE || payload_len > MAX_PAYLOAD_SIZE) {
+            log_error(ERROR_COMPRESSION_FAILED, "Capture frame could not be built");
+            break;
+        }
+
+        capture_frame[0] = (uint8_t)(metrics.method_id << FRAME_METHOD_SHIFT);
+        if (metrics.predicted) {
+            capture_frame[0] |= FRAME_FLAG_PREDICTED;
+        }
+        memcpy(capture_frame + 1, capture_payload, payload_len);
+        size_t frame_len = 1 + payload_len;
+
+        uint8_t* record = capture_frame + frame_len + 2;
+        size_t record_capacity = sizeof(capture_frame) - frame_len - 2;
+        size_t record_len = 0;
+        record[record_len++] = capture_id;
+        record[record_len++] = (uint8_t)parts;
+        record[record_len++] = first + count == capture_count ? 0x01 : 0x00;
+        if (!put_varint(record, record_capacity, &record_len, (uint32_t)first) ||
+            !put_varint(record, record_capacity, &record_len, (uint32_t)capture_trigger_index) ||
+            !put_varint(record, record_capacity, &record_len, capture_rules)) {
+            log_error(ERROR_COMPRESSION_FAILED, "Capture record does not fit the frame");
+            break;
+        }
+        frame_len += close_trailer_record(capture_frame, frame_len, FRAME_TLV_CAPTURE, record_len);
+        frame_len += append_sample_times(&chunk, count, capture_frame, frame_len, sizeof(capture_frame));
+
+        if (!history_append(capture_frame, frame_len, (uint16_t)count)) {
+            Serial.println(F("[CAPTURE] History full - capture part dropped"));
+        }
+        parts++;
+        first += count;
+    }
+
+    Serial.printf("[CAPTURE] Capture %u frozen: %zu samples (%zu before the trigger) in %zu frames\n",
+                  capture_id, capture_count, capture_trigger_index, parts);
+    capture_active = false;
+    capture_count = 0;
+    capture_id++;
+    set_read_interval(ADAPTIVE_SAMPLING ? sampler.interval_ms : capture_resume_ms, "CAPTURE");
+}
+
+static void capture_append(sample_store_t* store, size_t index, const uint16_t* values, size_t count,
+                           uint32_t timestamp_ms) {
+    uint16_t row[READ_REGISTER_COUNT] = {0};
+    memcpy(row, values, (count < READ_REGISTER_COUNT ? count : READ_REGISTER_COUNT) * sizeof(uint16_t));
+    sample_store_set_row(store, index, row);
+    sample_store_set_time(store, index, timestamp_ms);
+}
+
+// Keep recent samples for the pre-trigger window; on an alarm, start a capture that takes them
+// plus every sample of the post-trigger burst
+static void capture_sample(const uint16_t* values, size_t count, uint32_t timestamp_ms, uint32_t fired) {
+    if (!capture_active && fired) {
+        // Pre-trigger samples still inside the window, oldest first
+        size_t oldest = (pretrigger_next + CAPTURE_PRE_SAMPLES - pretrigger_count) % CAPTURE_PRE_SAMPLES;
+        uint16_t row[READ_REGISTER_COUNT];
+        for (size_t i = 0; i < pretrigger_count; i++) {
+            size_t index = (oldest + i) % CAPTURE_PRE_SAMPLES;
+            if (timestamp_ms - pretrigger_times[index] > CAPTURE_PRE_MS) {
+                continue;
+            }
+            sample_store_get_row(&pretrigger, index, row);
+            capture_append(&capture, capture_count++, row, READ_REGISTER_COUNT, pretrigger_times[index]);
+        }
+        pretrigger_count = 0;
+        capture_trigger_index = capture_count;
+        capture_trigger_ms = timestamp_ms;
+        capture_rules = fired;
+        capture_active = true;
+        capture_resume_ms = tasks[TASK_READ_REGISTERS].interval_ms;
+        Serial.printf("[CAPTURE] Triggered: %zu pre-trigger samples, bursting for %lu ms\n", capture_count,
+                      (unsigned long)CAPTURE_POST_MS);
+        set_read_interval(CAPTURE_BURST_INTERVAL_MS, "CAPTURE");
+    }
+
+    if (capture_active) {
+        capture_append(&capture, capture_count++, values, count, timestamp_ms);
+        if (timestamp_ms - capture_trigger_ms >= CAPTURE_POST_MS || capture_count == CAPTURE_MAX_SAMPLES) {
+            finish_capture();
+        }
         return;
     }
-    
-    // Check retry delay if previous upload failed
-    unsigned long current_time = millis();
-    if (upload_retry_count > 0) {
-        unsigned long retry_delay = RETRY_BASE_DELAY_MS * (1 << (upload_retry_count - 1));
-        if (retry_delay > MAX_RETRY_DELAY_MS) retry_delay = MAX_RETRY_DELAY_MS;
-        
-        if (current_time - last_upload_attempt < retry_delay) {
-            Serial.print(F("[UPLOAD] Waiting for retry delay: "));
-            Serial.print((retry_delay - (current_time - last_upload_attempt)) / 1000);
-            Serial.println(F("s remaining"));
+
+    capture_append(&pretrigger, pretrigger_next, values, count, timestamp_ms);
+    pretrigger_next = (pretrigger_next + 1) % CAPTURE_PRE_SAMPLES;
+    if (pretrigger_count < CAPTURE_PRE_SAMPLES) {
+        pretrigger_count++;
+    }
+}
+
+// Priority path: alarms go out as soon as the loop is free, not at the next upload tick.
+// A failed alarm is kept in history and delivered with the regular batches.
+static void send_pending_alarms(void) {
+    while (alarm_count > 0) {
+        // Take the frame off the queue first: reads during the send may raise new alarms
+        size_t frame_len = alarm_frame_lens[alarm_head];
+        memcpy(alarm_sending, alarm_frames[alarm_head], frame_len);
+        alarm_head = (alarm_head + 1) % ALARM_QUEUE_DEPTH;
+        alarm_count--;
+
+        Serial.printf("[ALARM] Sending alarm frame (%zu bytes)\n", frame_len);
+        if (!upload_pipeline_seal(alarm_sending, frame_len, 0, &alarm_packet) || !send_upload_packet(&alarm_packet)) {
+            Serial.println(F("[ALARM] Alarm upload failed, kept in history for the next upload"));
+            history_append(alarm_sending, frame_len, 1);
             return;
         }
+        feed_watchdog();
     }
-    
-    Serial.print(F("[UPLOAD] Starting upload - Buffer has "));
-    Serial.print(buffer_count);
-    Serial.println(F(" samples"));
-    
-    // WORKFLOW STEP 1: Stop filling → finalize buffer
-    upload_in_progress = true;
-    Serial.println(F("[WORKFLOW] Stop filling → finalize buffer"));
-    
-    // WORKFLOW STEP 2: Compress + packetize
-    Serial.println(F("[WORKFLOW] Compress + packetize"));
+}
+
+// Effective read interval of the batch as a FRAME_TLV_SAMPLING record; returns the bytes added
+static size_t append_sampling_report(uint8_t* frame, size_t frame_len, size_t capacity) {
+    if (!ADAPTIVE_SAMPLING) {
+        return 0;
+    }
+    const adaptive_batch_t* batch = &sampler.batch;
+    Serial.printf("[ADAPTIVE] Batch interval: now %lu ms, mean %lu ms (min %lu, max %lu), %u changes\n",
+                  (unsigned long)sampler.interval_ms,
+                  (unsigned long)(batch->gaps ? batch->gap_total_ms / batch->gaps : 0),
+                  (unsigned long)(batch->gaps ? batch->gap_min_ms : 0), (unsigned long)batch->gap_max_ms,
+                  batch->changes);
+
+    size_t room = capacity > frame_len + 2 ? capacity - frame_len - 2 : 0;
+    size_t value_len = room > 0 ? adaptive_encode_batch(&sampler, frame + frame_len + 2, room) : 0;
+    if (value_len == 0) {
+        return 0;
+    }
+    return close_trailer_record(frame, frame_len, FRAME_TLV_SAMPLING, value_len);
+}
+
+// Move the timing window into a FRAME_TLV_TASK_TIMING trailer record; returns the bytes added.
+// The window restarts either way, so a trailer never repeats counts already sent.
+static size_t append_timing_trailer(uint8_t* frame, size_t frame_len, size_t capacity) {
+    task_timing_t window[TASK_COUNT];
+    taskENTER_CRITICAL(&timing_mux);
+    memcpy(window, task_timing_window, sizeof(window));
+    timing_clear(task_timing_window, TASK_COUNT);
+    taskEXIT_CRITICAL(&timing_mux);
+
+    size_t room = capacity > frame_len + 2 ? capacity - frame_len - 2 : 0;
+    if (room > UINT8_MAX) {
+        room = UINT8_MAX;
+    }
+    size_t value_len = room > 0 ? timing_encode(window, TASK_COUNT, frame + frame_len + 2, room) : 0;
+    if (value_len == 0) {
+        Serial.println(F("[TIMING] Timing trailer does not fit, window dropped"));
+        return 0;
+    }
+    return close_trailer_record(frame, frame_len, FRAME_TLV_TASK_TIMING, value_len);
+}
+
+// Compress a batch into a finished upload frame: [flags][window if aggregated][compressed payload].
+// streamed: the batch is the fill buffer, so the frame built by the stream encoder can be used.
+// Returns the frame length, 0 if no frame could be built
+static size_t build_buffer_frame(const sample_store_t* samples, size_t count, bool streamed,
+                                 uint8_t* frame, size_t capacity) {
+    unsigned long start_us = micros();
+    bool use_aggregation = false;
 
-    if (!attempt_compression(buffer, &buffer_count)) {
+    // The frame is normally already encoded sample by sample; batch compression is the fallback
+    if (!(streamed && use_streamed_frame()) && !attempt_compression(samples, &count)) {
         memset(compressed_data, 0, sizeof(compressed_data));
         memset(&compression_metrics, 0, sizeof(compression_metrics));
         compressed_data_len = 0;
-        upload_retry_count++;
-        last_upload_attempt = current_time;
-        Serial.print(F("[UPLOAD] Compression failed - retry count: "));
-        Serial.println(upload_retry_count);
-        upload_in_progress = false;  // Re-enable filling on failure
-        return;
+        Serial.println(F("[UPLOAD] Compression failed"));
+        return 0;
     }
     
     // Check if compressed data exceeds payload limit
@@ -504,272 +1036,581 @@ void execute_upload_task(void) {
         Serial.print(compressed_data_len);
         Serial.print(F(" bytes) exceeds limit ("));
         Serial.print(MAX_PAYLOAD_SIZE);
-        Serial.println(F(" bytes). Using aggregation..."));
-        use_aggregation = true;
-        
-        size_t aggregated_count = 0;
-        register_reading_t* aggregated_buffer = NULL;
-        aggregated_count = aggregate_buffer_avg(buffer, buffer_count, &aggregated_buffer);
-
-        if (!attempt_compression(aggregated_buffer, &aggregated_count)) {
-            memset(&compression_metrics, 0, sizeof(compression_metrics));
-            memset(compressed_data, 0, sizeof(compressed_data));
-            compressed_data_len = 0;
-            upload_retry_count++;
-            last_upload_attempt = current_time;
-            Serial.print(F("[UPLOAD] Aggregated Compression failed - retry count: "));
-            Serial.println(upload_retry_count);
-            free(aggregated_buffer);
-            upload_in_progress = false;  // Re-enable filling on failure
-            return;
+        Serial.println(F(" bytes). Using bounded compression..."));
+
+        // Drop precision on the least important registers first
+        compression_metrics = compress_bounded(samples, count, compressed_data, sizeof(compressed_data), MAX_PAYLOAD_SIZE);
+        compressed_data_len = compression_metrics.compressed_payload_size;
+        if (compressed_data_len >= 5) {
+            print_compression_metrics(&compression_metrics);
         }
-        
-        free(aggregated_buffer);
     }
 
-    if (compressed_data_len >= 5 && compressed_data_len <= MAX_PAYLOAD_SIZE) {
-        
-        Serial.print(F("[UPLOAD] Method: "));
-        Serial.print(use_aggregation ? F("AGGREGATED COMPRESSION") : F("RAW COMPRESSION"));
-        Serial.print(F(", Original: "));
-        Serial.print(compression_metrics.original_payload_size);
-        Serial.print(F(" bytes, Final: "));
-        Serial.print(compression_metrics.compressed_payload_size);
-        Serial.print(F(" bytes, Ratio: "));
-        Serial.println(compression_metrics.compression_ratio);
-
-        // Create final upload frame: [metadata][compressed_data]
-        uint8_t compressed_data_frame[compressed_data_len + 1];
-        if (use_aggregation) {
-            // Indicate aggregated in header
-            compressed_data_frame[0] = 0x01; // Aggregated flag
-        } else {
-            compressed_data_frame[0] = 0x00; // Raw flag
+    // Aggregation is the last resort when even the coarsest quantization does not fit.
+    // Windows keep min/max/mean/last so peaks survive; the window doubles until the frame fits.
+    size_t window = 0;
+    if (compressed_data_len < 5 || compressed_data_len > MAX_PAYLOAD_SIZE) {
+        Serial.println(F("[UPLOAD] Bounded compression did not fit. Using aggregation..."));
+        use_aggregation = true;
+
+        for (window = AGG_WINDOW; ; window *= 2) {
+            if (window > AGG_MAX_WINDOW) {
+                window = AGG_MAX_WINDOW;
+            }
+            size_t aggregated_count = downsample_min_max_mean_last(samples, count, window, &aggregated_buffer);
+            if (aggregated_count == 0 || !attempt_compression(&aggregated_buffer, &aggregated_count)) {
+                memset(&compression_metrics, 0, sizeof(compression_metrics));
+                memset(compressed_data, 0, sizeof(compressed_data));
+                compressed_data_len = 0;
+                Serial.println(F("[UPLOAD] Aggregated Compression failed"));
+                return 0;
+            }
+            if (compressed_data_len <= MAX_PAYLOAD_SIZE || window >= count || window == AGG_MAX_WINDOW) {
+                break;
+            }
+            Serial.print(F("[UPLOAD] Aggregated frame too large with window "));
+            Serial.print(window);
+            Serial.println(F(", widening"));
         }
-        
-        // Copy metadata
-        memcpy(compressed_data_frame + 1, compressed_data, compressed_data_len);
+    }
+
+    size_t prefix_len = use_aggregation ? 2 : 1;
+    if (compressed_data_len < 5 || compressed_data_len > MAX_PAYLOAD_SIZE || compressed_data_len + prefix_len > capacity) {
+        log_error(ERROR_COMPRESSION_FAILED, "No compressed data available for upload");
+        return 0;
+    }
+
+    Serial.print(F("[UPLOAD] Method: "));
+    if (use_aggregation) {
+        Serial.print(F("AGGREGATED COMPRESSION, window "));
+        Serial.print(window);
+    } else if (compression_metrics.quantized) {
+        Serial.print(F("BOUNDED COMPRESSION"));
+    } else {
+        Serial.print(F("RAW COMPRESSION"));
+    }
+    Serial.print(F(" ("));
+    Serial.print(compression_metrics.compression_method);
+    Serial.print(F(")"));
+    Serial.print(F(", Original: "));
+    Serial.print(compression_metrics.original_payload_size);
+    Serial.print(F(" bytes, Final: "));
+    Serial.print(compression_metrics.compressed_payload_size);
+    Serial.print(F(" bytes, Ratio: "));
+    Serial.println(compression_metrics.compression_ratio);
 
-        Serial.println(F("[UPLOAD] Compressed data frame:"));
-        for (size_t i = 0; i < compressed_data_len + 1; i++) {
-            Serial.print(compressed_data_frame[i]);
-            Serial.print(F(" "));
+    // Flags byte: compression method in the high nibble, frame flags in the low nibble
+    frame[0] = (uint8_t)(compression_metrics.method_id << FRAME_METHOD_SHIFT);
+    if (use_aggregation) {
+        frame[0] |= FRAME_FLAG_AGGREGATED;
+        frame[1] = (uint8_t)window;
+    }
+    if (compression_metrics.predicted) {
+        frame[0] |= FRAME_FLAG_PREDICTED;
+    }
+    if (compression_metrics.quantized) {
+        frame[0] |= FRAME_FLAG_QUANTIZED;
+    }
+    memcpy(frame + prefix_len, compressed_data, compressed_data_len);
+
+    size_t frame_len = compressed_data_len + prefix_len;
+    size_t trailer_end = frame_len + FRAME_TRAILER_MAX < capacity ? frame_len + FRAME_TRAILER_MAX : capacity;
+    frame_len += append_sample_times(samples, count, frame, frame_len, trailer_end);
+    frame_len += append_sampling_report(frame, frame_len, trailer_end);
+    frame_len += append_timing_trailer(frame, frame_len, trailer_end);
+    memset(compressed_data, 0, compressed_data_len);
+    compressed_data_len = 0;
+    upload_pipeline_record(PIPELINE_STAGE_COMPRESS, micros() - start_us);
+    return frame_len;
+}
+
+// Hand one upload frame to the seal stage (CRC, encryption, MAC on the other core)
+static bool submit_upload_frame(const uint8_t* frame, size_t frame_len, uint32_t tag) {
+    Serial.println(F("[UPLOAD] Compressed data frame:"));
+    for (size_t i = 0; i < frame_len; i++) {
+        Serial.print(frame[i]);
+        Serial.print(F(" "));
+    }
+    Serial.println();
+
+    if (!upload_pipeline_submit(frame, frame_len, tag)) {
+        Serial.println(F("[PIPELINE] Seal stage rejected frame"));
+        return false;
+    }
+    return true;
+}
+
+// Network stage: send one sealed frame, then act on the cloud response
+// (commands, configuration updates, FOTA). Returns true once the cloud acknowledged it.
+static bool send_upload_packet(const upload_packet_t* packet) {
+    if (!packet->sealed) {
+        return false;
+    }
+    unsigned long start_us = micros();
+    size_t frame_len = packet->frame_len;
+
+    Serial.printf("[ENCRYPTION] Final encrypted payload: IV(16) + Ciphertext(%d) = %d bytes\n",
+                 packet->payload_len - 16, packet->payload_len);
+
+    String url;
+    url.reserve(128);
+    url = UPLOAD_API_BASE_URL;
+    url += "/api/cloud/write";
+    String method = "POST";
+    String api_key = UPLOAD_API_KEY;
+
+    Serial.print(F("[SECURITY] Using Nonce: "));
+    Serial.println(packet->nonce);
+    Serial.print(F("[SECURITY] Generated MAC: "));
+    Serial.println(packet->mac);
+
+    String response = upload_api_send_request_with_retry(url, method, api_key, packet->payload, packet->payload_len,
+                                                         String(packet->nonce), String(packet->mac));
+    upload_pipeline_record(PIPELINE_STAGE_NETWORK, micros() - start_us);
+
+    if (response.length() > 0) {
+        String action;
+        uint16_t reg = 0;
+        uint16_t val = 0;
+
+        if (extract_command(response, action, reg, val)) {
+            Serial.println(F("[COMMAND] Command detected in cloud response"));
+            
+            if (action.equalsIgnoreCase("write_register")) {
+                Serial.println(F("[COMMAND] Executing WRITE command immediately"));
+
+                // Store command atomically
+                current_command.pending = true;
+                current_command.register_address = reg;
+                current_command.value = val;
+                
+                // Execute write immediately (no need to wait for scheduler interval)
+                execute_write_task();
+                
+                // Command task will report result on next interval
+                set_task_enabled(TASK_COMMAND_HANDLING, true);
+
+            } else if (action.equalsIgnoreCase("read_register")) {
+                Serial.println(F("[COMMAND] Preparing to execute READ task"));
+
+            } else {
+                Serial.println(F("[COMMAND] Unknown action command received"));
+            }
         }
-        Serial.println();
+    }
+    
+    if (!validate_upload_response(response)) {
+        Serial.println(F("[UPLOAD] Failed - no response from cloud"));
+        return false;
+    }
+
+    Serial.print(F("[UPLOAD] Success: "));
+    Serial.print(frame_len + 2);
+    Serial.println(F(" bytes uploaded"));
+    
+    // STEP 1: Process configuration updates from cloud response
+    String config_ack = config_process_cloud_response(response);
+    if (config_ack.length() > 0) {
+        // Send configuration acknowledgment to cloud
+        extern void send_config_ack_to_cloud(const String& ack_json);
+        send_config_ack_to_cloud(config_ack);
+        // Note: ACK failure doesn't prevent config application
+    }
+    
+    // STEP 2: Apply any pending configuration changes after successful upload
+    if (config_has_pending_changes()) {
+        Serial.println(F("[CONFIG] Applying pending configuration changes"));
         
-        // Add CRC for entire frame
-        uint8_t upload_frame_with_crc[compressed_data_len + 3]; // metadata + data + CRC
-        append_crc_to_upload_frame(compressed_data_frame, compressed_data_len + 1, upload_frame_with_crc);
+        // Feed watchdog before potentially blocking operation
+        esp_task_wdt_reset();
         
-        Serial.print(F("[UPLOAD] Frame with CRC: "));
-        Serial.print(compressed_data_len + 1);
-        Serial.print(F(" bytes + 2 bytes CRC = "));
-        Serial.print(compressed_data_len + 3);
-        Serial.println(F(" bytes total"));
+        // Apply with timeout protection
+        bool apply_success = false;
+        unsigned long apply_start = millis();
+        const unsigned long APPLY_TIMEOUT = 5000; // 5 seconds max
         
-        // === AES-256-CBC ENCRYPTION ===
-        uint8_t iv[16]; // 16-byte IV for AES
-        uint8_t encrypted_payload[compressed_data_len + 32]; // Extra space for PKCS#7 padding
-        size_t encrypted_len = 0;
+        try {
+            config_apply_pending_changes();
+            task_config_changed = true;  // Picked up between tasks by scheduler_run()
+            apply_success = true;
+            Serial.println(F("[CONFIG] Configuration applied successfully"));
+        } catch (...) {
+            Serial.println(F("[CONFIG] ERROR: Exception during config application"));
+        }
         
-        Serial.println(F("[ENCRYPTION] Encrypting payload with AES-256-CBC..."));
+        // Check for timeout
+        if (millis() - apply_start > APPLY_TIMEOUT) {
+            Serial.println(F("[CONFIG] WARNING: Config application took too long"));
+        }
         
-        extern bool encryptPayloadAES_CBC(const uint8_t* plaintext, size_t plaintext_len,
-                                         uint8_t* ciphertext, size_t* ciphertext_len,
-                                         uint8_t* iv_output);
+        // Feed watchdog after config operation
+        esp_task_wdt_reset();
         
-        if (!encryptPayloadAES_CBC(upload_frame_with_crc, compressed_data_len + 3,
-                                  encrypted_payload, &encrypted_len, iv)) {
-            Serial.println(F("[ENCRYPTION] Encryption failed! Aborting upload."));
-            upload_in_progress = false;
-            return;
+        if (!apply_success) {
+            Serial.println(F("[CONFIG] ERROR: Failed to apply configuration changes"));
+            // Clear pending config to prevent retry loops
+            config_clear_pending_changes();
         }
+    }
+    
+    // STEP 3: Check for FOTA manifest in cloud response
+    int job_id;
+    String fwUrl, shaExpected, signature;
+    size_t fwSize;
+    
+    extern bool parse_fota_manifest_from_response(const String& response, 
+                                                 int& job_id, 
+                                                 String& fwUrl, 
+                                                 size_t& fwSize, 
+                                                 String& shaExpected, 
+                                                 String& signature);
+    
+    if (parse_fota_manifest_from_response(response, job_id, fwUrl, fwSize, shaExpected, signature)) {
+        Serial.println(F("[FOTA] Firmware update available - initiating download"));
         
-        // Combine IV + Ciphertext for final payload
-        uint8_t final_payload[16 + encrypted_len];
-        memcpy(final_payload, iv, 16); // First 16 bytes: IV
-        memcpy(final_payload + 16, encrypted_payload, encrypted_len); // Rest: Ciphertext
-        size_t final_payload_len = 16 + encrypted_len;
+        extern bool perform_FOTA_with_manifest(int job_id, 
+                                              const String& fwUrl, 
+                                              size_t fwSize, 
+                                              const String& shaExpected, 
+                                              const String& signature);
         
-        Serial.printf("[ENCRYPTION] Final encrypted payload: IV(16) + Ciphertext(%d) = %d bytes\n",
-                     encrypted_len, final_payload_len);
-
-        String url;
-        url.reserve(128);
-        url = UPLOAD_API_BASE_URL;
-        url += "/api/cloud/write";
-        String method = "POST";
-        String api_key = UPLOAD_API_KEY;
-
-        // Get a unique nonce for this transaction
-        uint32_t nonce = nonceManager.getAndIncrementNonce();
-        Serial.print(F("[SECURITY] Using Nonce: "));
-        Serial.println(nonce);
-
-        // Encode encrypted payload (IV + Ciphertext) to Base64
-        String upload_frame_base64 = encodeBase64(final_payload, final_payload_len);
-        Serial.print(F("[SECURITY] Base64 encoded length: "));
-        Serial.println(upload_frame_base64.length());
-
-        // Generate MAC for the encrypted Base64 payload
-        String mac = generateMAC(upload_frame_base64);
-        Serial.print(F("[SECURITY] Generated MAC: "));
-        Serial.println(mac);
-
-        String response = upload_api_send_request_with_retry(url, method, api_key, final_payload, final_payload_len, String(nonce), mac);
-
-        if (response.length() > 0) {
-            String action;
-            uint16_t reg = 0;
-            uint16_t val = 0;
-
-            if (extract_command(response, action, reg, val)) {
-                Serial.println(F("[COMMAND] Command detected in cloud response"));
-                
-                if (action.equalsIgnoreCase("write_register")) {
-                    Serial.println(F("[COMMAND] Executing WRITE command immediately"));
-
-                    // Store command atomically
-                    current_command.pending = true;
-                    current_command.register_address = reg;
-                    current_command.value = val;
-                    
-                    // Execute write immediately (no need to wait for scheduler interval)
-                    execute_write_task();
-                    
-                    // Command task will report result on next interval
-                    tasks[TASK_COMMAND_HANDLING].enabled = true;
-
-                } else if (action.equalsIgnoreCase("read_register")) {
-                    Serial.println(F("[COMMAND] Preparing to execute READ task"));
-
-                } else {
-                    Serial.println(F("[COMMAND] Unknown action command received"));
-                }
-            }
-        }
+        bool fota_success = perform_FOTA_with_manifest(job_id, fwUrl, fwSize, shaExpected, signature);
         
-        if (validate_upload_response(response)) {
-            Serial.print(F("[UPLOAD] Success: "));
-            Serial.print(compressed_data_len + 3);
-            Serial.println(F(" bytes uploaded"));
-            
-            // STEP 1: Process configuration updates from cloud response
-            String config_ack = config_process_cloud_response(response);
-            if (config_ack.length() > 0) {
-                // Send configuration acknowledgment to cloud
-                extern void send_config_ack_to_cloud(const String& ack_json);
-                send_config_ack_to_cloud(config_ack);
-                // Note: ACK failure doesn't prevent config application
-            }
-            
-            // STEP 2: Apply any pending configuration changes after successful upload
-            if (config_has_pending_changes()) {
-                Serial.println(F("[CONFIG] Applying pending configuration changes"));
-                
-                // Feed watchdog before potentially blocking operation
-                esp_task_wdt_reset();
-                
-                // Apply with timeout protection
-                bool apply_success = false;
-                unsigned long apply_start = millis();
-                const unsigned long APPLY_TIMEOUT = 5000; // 5 seconds max
-                
-                try {
-                    config_apply_pending_changes();
-                    apply_success = true;
-                    Serial.println(F("[CONFIG] Configuration applied successfully"));
-                } catch (...) {
-                    Serial.println(F("[CONFIG] ERROR: Exception during config application"));
-                }
-                
-                // Check for timeout
-                if (millis() - apply_start > APPLY_TIMEOUT) {
-                    Serial.println(F("[CONFIG] WARNING: Config application took too long"));
-                }
-                
-                // Feed watchdog after config operation
-                esp_task_wdt_reset();
-                
-                if (!apply_success) {
-                    Serial.println(F("[CONFIG] ERROR: Failed to apply configuration changes"));
-                    // Clear pending config to prevent retry loops
-                    config_clear_pending_changes();
-                }
-            }
-            
-            // STEP 3: Check for FOTA manifest in cloud response
-            int job_id;
-            String fwUrl, shaExpected, signature;
-            size_t fwSize;
-            
-            extern bool parse_fota_manifest_from_response(const String& response, 
-                                                         int& job_id, 
-                                                         String& fwUrl, 
-                                                         size_t& fwSize, 
-                                                         String& shaExpected, 
-                                                         String& signature);
-            
-            if (parse_fota_manifest_from_response(response, job_id, fwUrl, fwSize, shaExpected, signature)) {
-                Serial.println(F("[FOTA] Firmware update available - initiating download"));
-                
-                extern bool perform_FOTA_with_manifest(int job_id, 
-                                                      const String& fwUrl, 
-                                                      size_t fwSize, 
-                                                      const String& shaExpected, 
-                                                      const String& signature);
-                
-                bool fota_success = perform_FOTA_with_manifest(job_id, fwUrl, fwSize, shaExpected, signature);
-                
-                if (fota_success) {
-                    Serial.println(F("[FOTA] Update successful - restarting in 2 seconds..."));
-                    delay(2000);
-                    ESP.restart();
-                } else {
-                    Serial.println(F("[FOTA] Update failed - continuing normal operation"));
-                }
-            }
-            
-            // STEP 4: After successful ACK from cloud → clear buffer
-            Serial.println(F("[WORKFLOW] Successful ACK → clear buffer"));
-                buffer_count = 0;
-                buffer_write_index = 0;
-                buffer_full = false;
-                if (buffer != nullptr) {
-                    memset(buffer, 0, sizeof(register_reading_t) * buffer_size);
-                }
-                
-                // Reset retry counters on success
-                upload_retry_count = 0;
-                last_upload_attempt = 0;
-                
-                // WORKFLOW STEP 5: Buffer becomes free again for next cycle
-                upload_in_progress = false;
-                Serial.println(F("[WORKFLOW] Buffer free for next cycle"));
-                
-                reset_error_state();
+        if (fota_success) {
+            Serial.println(F("[FOTA] Update successful - restarting in 2 seconds..."));
+            delay(2000);
+            ESP.restart();
         } else {
-            // No response - upload failed
-            Serial.println(F("[UPLOAD] Failed - no response from cloud"));
-            upload_in_progress = false;  // Re-enable filling on upload failure
-            upload_retry_count++;
-            last_upload_attempt = current_time;
-            Serial.print(F("[UPLOAD] Network failure - retry count: "));
-            Serial.println(upload_retry_count);
+            Serial.println(F("[FOTA] Update failed - continuing normal operation"));
         }
-        
-        memset(compressed_data, 0, compressed_data_len);
-        compressed_data_len = 0;
-        
+    }
+
+    return true;
+}
+
+// Submit, seal and send a single frame
+static bool send_upload_frame(const uint8_t* frame, size_t frame_len) {
+    upload_packet_t* packet = &upload_packet;
+    if (!submit_upload_frame(frame, frame_len, 0) || !upload_pipeline_next(packet)) {
+        upload_pipeline_flush();
+        return false;
+    }
+    return send_upload_packet(packet);
+}
+
+// Feed the seal stage with the next history blocks (oldest first, newer than *last_sequence)
+// while it has room. Blocks are copied, so eviction during a send cannot corrupt them.
+static void submit_history_blocks(size_t* budget, bool* started, uint32_t* last_sequence) {
+    for (size_t i = 0; i < history_count() && *budget > 0 &&
+                       upload_pipeline_in_flight() < UPLOAD_PIPELINE_DEPTH; i++) {
+        history_block_t info;
+        const uint8_t* frame = history_get(i, &info);
+        if (*started && info.sequence <= *last_sequence) {
+            continue;
+        }
+
+        Serial.printf("[HISTORY] Uploading block %u (%u samples, %u bytes), %zu held\n",
+                     info.sequence, info.samples, info.length, history_count());
+        if (!submit_upload_frame(frame, info.length, info.sequence)) {
+            return;
+        }
+        *started = true;
+        *last_sequence = info.sequence;
+        (*budget)--;
+    }
+}
+
+// Upload sealed history blocks oldest first; stops at the first failure.
+// Block k+1 is sealed on the other core while block k is on the wire.
+static bool drain_history(void) {
+    size_t budget = HISTORY_BLOCKS_PER_UPLOAD;
+    bool started = false;
+    uint32_t last_sequence = 0;
+    upload_packet_t* packet = &upload_packet;
+
+    submit_history_blocks(&budget, &started, &last_sequence);
+    while (upload_pipeline_in_flight() > 0) {
+        if (!upload_pipeline_next(packet) || !send_upload_packet(packet)) {
+            upload_pipeline_flush();
+            return false;
+        }
+
+        // Reads during the send may have sealed a batch and evicted this block already
+        history_block_t oldest;
+        if (history_get(0, &oldest) && oldest.sequence == packet->tag) {
+            history_pop_oldest();
+        }
+        feed_watchdog();
+        submit_history_blocks(&budget, &started, &last_sequence);
+    }
+    return true;
+}
+
+// History overflow: seal the oldest block and append it to the flash spill queue
+static bool spill_history_block(const uint8_t* frame, const history_block_t* info) {
+    if (!upload_pipeline_seal(frame, info->length, info->sequence, &spill_packet) || !spill_append(&spill_packet)) {
+        return false;
+    }
+    Serial.printf("[SPILL] Block %u (%u samples) moved to flash, %u records queued\n",
+                 info->sequence, info->samples, spill_count());
+    return true;
+}
+
+// Send spilled records oldest first; they predate everything in RAM.
+// Rate limited: SPILL_DRAIN_BATCH records per cycle, SPILL_DRAIN_GAP_MS apart.
+static bool drain_spill(void) {
+    for (size_t sent = 0; sent < SPILL_DRAIN_BATCH; sent++) {
+        uint32_t sequence;
+        if (!spill_peek(&upload_packet, &sequence)) {
+            return true;
+        }
+        if (sent > 0) {
+            sample_while_waiting(SPILL_DRAIN_GAP_MS);
+        }
+
+        Serial.printf("[SPILL] Uploading record %u, %u on flash\n", sequence, spill_count());
+        if (!send_upload_packet(&upload_packet)) {
+            return false;
+        }
+        spill_ack(sequence);
+        feed_watchdog();
+    }
+    return true;
+}
+
+// Seal the full buffer into the compressed history so acquisition can continue
+static bool seal_buffer_to_history(void) {
+    size_t frame_len = build_buffer_frame(&buffer, buffer_count, true, seal_frame_buffer, sizeof(seal_frame_buffer));
+    if (frame_len == 0) {
+        return false;
+    }
+
+    if (!history_append(seal_frame_buffer, frame_len, (uint16_t)buffer_count)) {
+        Serial.println(F("[HISTORY] History full - batch not sealed"));
+        return false;
+    }
+
+    history_stats_t stats = history_get_stats();
+    Serial.printf("[HISTORY] Sealed %zu samples into %zu bytes (%zu blocks, %zu/%u bytes used)\n",
+                 buffer_count, frame_len, stats.blocks, stats.bytes_used, HISTORY_ARENA_SIZE);
+
+    reset_buffer();
+    return true;
+}
+
+// Count a failed upload attempt for the retry backoff
+static void upload_failed(unsigned long attempt_time) {
+    upload_retry_count++;
+    last_upload_attempt = attempt_time;
+    Serial.print(F("[UPLOAD] Upload failed - retry count: "));
+    Serial.println(upload_retry_count);
+}
+
+// Queue the frozen batch's frame behind the older history blocks so the cloud gets data in order
+static void queue_upload_frame(void) {
+    upload_in_history = history_append(upload_frame_buffer, upload_frame_len, (uint16_t)upload_buffer_count);
+    if (upload_in_history) {
+        history_block_t info;
+        history_get(history_count() - 1, &info);
+        upload_sequence = info.sequence;
     } else {
-        log_error(ERROR_COMPRESSION_FAILED, "No compressed data available for upload");
-        upload_in_progress = false;  // Re-enable filling on failure
-        upload_retry_count++;
-        last_upload_attempt = current_time;
-        Serial.print(F("[UPLOAD] No data after compression - retry count: "));
-        Serial.println(upload_retry_count);
+        Serial.println(F("[HISTORY] History full - frozen batch waits for the history to drain"));
+    }
+}
+
+// Freeze the fill buffer's batch for upload: its frame is built while the stream encoder
+// still holds the batch, then the buffer is emptied and reads continue into it.
+static bool freeze_fill_buffer(void) {
+    upload_frame_len = build_buffer_frame(&buffer, buffer_count, true, upload_frame_buffer, sizeof(upload_frame_buffer));
+    if (upload_frame_len == 0) {
+        return false;
+    }
+
+    upload_buffer_count = buffer_count;
+    reset_buffer();
+
+    queue_upload_frame();
+    return true;
+}
+
+// Release the frozen batch once it is acknowledged (or was evicted from history)
+static void release_frozen_batch(void) {
+    upload_buffer_count = 0;
+    Serial.println(F("[WORKFLOW] Frozen batch acknowledged → next batch can be frozen"));
+}
+
+// The frozen batch's history block is gone once the oldest block is newer
+static bool upload_batch_pending(void) {
+    if (!upload_in_history) {
+        return true;
+    }
+    history_block_t oldest;
+    return history_get(0, &oldest) && oldest.sequence <= upload_sequence;
+}
+
+static void run_read_task(void) {
+    read_in_progress = true;
+    execute_read_task();
+    read_in_progress = false;
+}
+
+// API retry backoff: keep sampling into the fill buffer instead of blocking in delay()
+static void sample_while_waiting(unsigned long wait_ms) {
+    if (read_in_progress || (acquisition_task_handle && xTaskGetCurrentTaskHandle() == acquisition_task_handle)) {
+        delay(wait_ms);  // Retries of the read itself
         return;
     }
+
+    deadline_slot_t slot;
+    unsigned long start = millis();
+    while (millis() - start < wait_ms) {
+        if (acquisition_task_handle) {
+            drain_acquisition_ring();
+        } else if (tasks[TASK_READ_REGISTERS].enabled &&
+                   deadline_take(&deadlines, TASK_READ_REGISTERS, millis(), &slot)) {
+            run_timed_task(TASK_READ_REGISTERS, &slot);
+        }
+        feed_watchdog();
+
+        unsigned long elapsed = millis() - start;
+        if (elapsed < wait_ms) {
+            unsigned long remaining = wait_ms - elapsed;
+            delay(remaining < WAIT_SAMPLING_STEP_MS ? remaining : WAIT_SAMPLING_STEP_MS);
+        }
+    }
+}
+
+// Fixed-cadence reads; vTaskDelayUntil keeps the period drift-free whatever a read costs
+static void acquisition_task(void* param) {
+    (void)param;
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;) {
+        TickType_t started = xTaskGetTickCount();
+        execute_read_task();
+        TickType_t finished = xTaskGetTickCount();
+        uint32_t lateness_ms = (started - last_wake) * portTICK_PERIOD_MS;  // last_wake: this slot's start
+
+        // Interval is updated from config by the loop; an aligned 32-bit read is atomic
+        TickType_t period = pdMS_TO_TICKS(tasks[TASK_READ_REGISTERS].interval_ms);
+        if (period == 0) {
+            period = 1;
+        }
+        uint32_t missed = 0;
+        if (finished - last_wake >= period) {
+            missed = (finished - last_wake) / period;
+            last_wake = finished;  // A read overran: restart the cadence, skip missed slots
+        }
+        record_task_timing(TASK_READ_REGISTERS, lateness_ms, (finished - started) * portTICK_PERIOD_MS, missed);
+        vTaskDelayUntil(&last_wake, period);
+    }
+}
+
+static void start_acquisition_task(void) {
+    if (acquisition_task_handle) {
+        return;
+    }
+    sample_ring_init(&acquisition_ring, acquisition_ring_storage, ACQUISITION_RING_CAPACITY, ACQUISITION_RING_WIDTH);
+    acquisition_overflows_logged = 0;
+
+    BaseType_t created = xTaskCreatePinnedToCore(acquisition_task, "acquisition", ACQUISITION_TASK_STACK, nullptr,
+                                                 ACQUISITION_TASK_PRIORITY, &acquisition_task_handle,
+                                                 ACQUISITION_TASK_CORE);
+    if (created != pdPASS) {
+        acquisition_task_handle = nullptr;
+        Serial.println(F("[ACQ] ERROR: Failed to create acquisition task, sampling from the loop"));
+        return;
+    }
+    set_task_enabled(TASK_READ_REGISTERS, false);  // Sampled by the acquisition task now
+    Serial.printf("[ACQ] Acquisition task started (ring: %u samples)\n", (unsigned)ACQUISITION_RING_CAPACITY);
+}
+
+// Consumer side: move queued samples into the fill buffer (and its stream encoder)
+static void drain_acquisition_ring(void) {
+    uint16_t values[ACQUISITION_RING_WIDTH];
+    while (sample_ring_pop(&acquisition_ring, values)) {
+        uint32_t timestamp_ms = values[READ_REGISTER_COUNT] | ((uint32_t)values[READ_REGISTER_COUNT + 1] << 16);
+        store_register_reading(values, READ_REGISTER_COUNT, timestamp_ms);
+    }
+
+    uint32_t overflows = acquisition_ring.overflows.load(std::memory_order_relaxed);
+    if (overflows != acquisition_overflows_logged) {
+        Serial.printf("[ACQ] Ring full: %u samples dropped (total %u, peak fill %u/%u)\n",
+                      overflows - acquisition_overflows_logged, overflows,
+                      acquisition_ring.high_water.load(std::memory_order_relaxed),
+                      (unsigned)ACQUISITION_RING_CAPACITY);
+        acquisition_overflows_logged = overflows;
+    }
+}
+
+void execute_upload_task(void) {
+    // Check if we have data to upload
+    if (buffer_count == 0 && history_count() == 0 && upload_buffer_count == 0 && spill_count() == 0) {
+        Serial.println(F("[COMPRESSION] No data to compress and upload"));
+        return;
+    }
+    
+    // Check retry delay if previous upload failed
+    unsigned long current_time = millis();
+    if (upload_retry_count > 0) {
+        unsigned long retry_delay = RETRY_BASE_DELAY_MS * (1 << (upload_retry_count - 1));
+        if (retry_delay > MAX_RETRY_DELAY_MS) retry_delay = MAX_RETRY_DELAY_MS;
+        
+        if (current_time - last_upload_attempt < retry_delay) {
+            Serial.print(F("[UPLOAD] Waiting for retry delay: "));
+            Serial.print((retry_delay - (current_time - last_upload_attempt)) / 1000);
+            Serial.println(F("s remaining"));
+            return;
+        }
+    }
+    
+    Serial.print(F("[UPLOAD] Starting upload - Buffer has "));
+    Serial.print(buffer_count);
+    Serial.print(F(" samples, frozen batch has "));
+    Serial.print(upload_buffer_count);
+    Serial.print(F(" samples, history has "));
+    Serial.print(history_count());
+    Serial.print(F(" sealed batches, flash has "));
+    Serial.print(spill_count());
+    Serial.println(F(" spilled"));
+
+    // WORKFLOW STEP 1: Swap buffers → freeze the filled one, reads continue into the other.
+    // A batch still frozen from a failed cycle is retried before a new one is frozen.
+    if (upload_buffer_count == 0 && buffer_count > 0) {
+        Serial.println(F("[WORKFLOW] Swap buffers → freeze batch, compress + packetize"));
+        if (!freeze_fill_buffer()) {
+            upload_failed(current_time);
+            return;
+        }
+    } else if (upload_buffer_count > 0 && !upload_in_history) {
+        queue_upload_frame();
+    }
+
+    // WORKFLOW STEP 2: Upload spilled then sealed batches oldest first (the frozen batch is queued
+    // behind them); history waits until the flash backlog is gone so the cloud gets data in order
+    if (!drain_spill() || (spill_count() == 0 && !drain_history())) {
+        upload_failed(current_time);
+        return;
+    }
+
+    // History could not take the frozen batch: send it directly once the older blocks are out
+    if (upload_buffer_count > 0 && !upload_in_history && history_count() == 0 && spill_count() == 0) {
+        if (!send_upload_frame(upload_frame_buffer, upload_frame_len)) {
+            upload_failed(current_time);
+            return;
+        }
+        release_frozen_batch();
+    } else if (upload_buffer_count > 0 && !upload_batch_pending()) {
+        // WORKFLOW STEP 3: After successful ACK from cloud → release the frozen batch
+        release_frozen_batch();
+    }
+
+    upload_pipeline_print_stats();
+
+    // Reset retry counters on success
+    upload_retry_count = 0;
+    last_upload_attempt = 0;
+    
+    reset_error_state();
 }
 
 // Send immediate write command acknowledgment 
@@ -819,7 +1660,7 @@ void execute_command_task(void) {
     // FIXED: Always attempt to send result if available
     if (write_status.length() == 0) {
         Serial.println(F("[COMMAND] No result to report"));
-        tasks[TASK_COMMAND_HANDLING].enabled = false;
+        set_task_enabled(TASK_COMMAND_HANDLING, false);
         return;
     }
 
@@ -845,18 +1686,45 @@ void execute_command_task(void) {
 
     write_status = "";
     write_executed_timestamp = "";
-    tasks[TASK_COMMAND_HANDLING].enabled = false;
+    set_task_enabled(TASK_COMMAND_HANDLING, false);
 }
 
 // FOTA task removed - now integrated into upload response handling
 // The cloud sends FOTA manifest in the upload acknowledgment response
 // See execute_upload_task() for FOTA integration
 
+// Take the frame built incrementally by store_register_reading()
+bool use_streamed_frame(void) {
+    if (!stream_encoder_ready(&stream_encoder, buffer_count)) {
+        return false;
+    }
+
+    compression_metrics = stream_encoder_finish(&stream_encoder, compressed_data, sizeof(compressed_data));
+    compressed_data_len = compression_metrics.compressed_payload_size;
+    if (compressed_data_len < 5) {
+        return false;
+    }
+
+    // Codecs were picked from the previous batch; if that no longer fits, let batch AUTO re-pick
+    if (compressed_data_len > MAX_PAYLOAD_SIZE) {
+        Serial.println(F("[COMPRESSION] Streamed frame over payload limit, re-encoding batch"));
+        return false;
+    }
+
+    Serial.print(F("[COMPRESSION] Using streamed frame, encode time: "));
+    Serial.print(compression_metrics.cpu_time_us);
+    Serial.print(F(" us over "));
+    Serial.print(compression_metrics.num_samples);
+    Serial.println(F(" samples"));
+    print_compression_metrics(&compression_metrics);
+    return true;
+}
+
 // Compress the buffer and add header
-bool attempt_compression(register_reading_t* buffer, size_t* buffer_count) {
+bool attempt_compression(const sample_store_t* buffer, size_t* buffer_count) {
     int retry_count = 0;
     while (retry_count < MAX_COMPRESSION_RETRIES) {
-        compression_metrics = compress_raw(buffer, *buffer_count, compressed_data);
+        compression_metrics = compress_buffer(COMPRESSION_METHOD, buffer, *buffer_count, compressed_data, sizeof(compressed_data));
         compressed_data_len = compression_metrics.compressed_payload_size;
         Serial.print(F("[COMPRESSION] Time: "));
         Serial.print(compression_metrics.cpu_time_us);
@@ -864,6 +1732,7 @@ bool attempt_compression(register_reading_t* buffer, size_t* buffer_count) {
 
         if (compressed_data_len >= 5) {
             Serial.println(F("[COMPRESSION] Raw buffer compressed successfully"));
+            print_compression_metrics(&compression_metrics);
             return true;
         } else {
             retry_count++;
@@ -878,37 +1747,18 @@ bool attempt_compression(register_reading_t* buffer, size_t* buffer_count) {
     return false;
 }
 
+// Start every task's deadline grid: first run one interval after start_time
 void init_tasks_last_run(unsigned long start_time) {
     for (int i = 0; i < TASK_COUNT; i++) {
-        tasks[i].last_run_ms = start_time;
+        deadline_start(&deadlines, i, tasks[i].interval_ms, start_time + tasks[i].interval_ms);
+        deadline_set_active(&deadlines, i, tasks[i].enabled, start_time);
     }
 }
 
-size_t aggregate_buffer_avg(const register_reading_t* buffer, size_t count, register_reading_t** out_buffer) {
-    size_t agg_count = (count + AGG_WINDOW - 1) / AGG_WINDOW;
-
-    register_reading_t* agg_buffer = (register_reading_t*)malloc(agg_count * sizeof(register_reading_t));
-    if (!agg_buffer) return 0;
-
-    size_t agg_idx = 0;
-    for (size_t i = 0; i < count; i += AGG_WINDOW) {
-        for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
-            uint32_t sum = 0;
-            size_t actual = 0;
-
-            for (size_t j = i; j < i + AGG_WINDOW && j < count; j++) {
-                sum += buffer[j].values[reg];
-                actual++;
-            }
-
-            uint16_t avg_val = (uint16_t)(sum / actual);
-            agg_buffer[agg_idx].values[reg] = avg_val;
-        }
-        agg_idx++;
-    }
-
-    *out_buffer = agg_buffer;
-    return agg_count;
+// Enabled tasks are in the deadline heap; disabled ones cost no wakeups
+static void set_task_enabled(task_type_t type, bool enabled) {
+    tasks[type].enabled = enabled;
+    deadline_set_active(&deadlines, type, enabled, millis());
 }
 
 // Unified command finalization
@@ -916,8 +1766,8 @@ void finalize_command(const String& status) {
     write_status = status;
     write_executed_timestamp = get_current_timestamp();
     current_command.pending = false;
-    tasks[TASK_WRITE_REGISTER].enabled = false;
-    tasks[TASK_COMMAND_HANDLING].enabled = true;  // Enable result reporting
+    set_task_enabled(TASK_WRITE_REGISTER, false);
+    set_task_enabled(TASK_COMMAND_HANDLING, true);  // Enable result reporting
     
     Serial.print(F("[COMMAND] Finalized with status: "));
     Serial.println(status);
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "sample_store.h"
 
 // Scheduler task types
 typedef enum {
@@ -18,14 +19,13 @@ typedef enum {
 typedef struct {
     task_type_t type;
     unsigned long interval_ms;
-    unsigned long last_run_ms;
     bool enabled;
 } scheduler_task_t;
 
-// Circular buffer for storing readings
+// One sample of all read registers (row view of the column-major sample buffer)
 typedef struct {
     uint16_t values[READ_REGISTER_COUNT];
-    // unsigned long timestamp;
+    uint32_t timestamp_ms;  // millis() when the read started (see time_unix_ms_at)
 } register_reading_t;
 
 // Command state structure
@@ -44,7 +44,7 @@ void free_buffer();
 void scheduler_init();
 
 // Data storage functions
-void store_register_reading(const uint16_t* values, size_t count);
+void store_register_reading(const uint16_t* values, size_t count, uint32_t timestamp_ms);
 
 // Task execution functions
 void execute_read_task(void);
@@ -56,8 +56,8 @@ void execute_command_task(void);
 // Command acknowledgment functions
 void send_write_command_ack(const String& status, const String& error_code = "", const String& error_message = "");
 
-bool attempt_compression(register_reading_t* buffer, size_t* buffer_count);
-size_t aggregate_buffer_avg(const register_reading_t* buffer, size_t count, register_reading_t** out_buffer);
+bool use_streamed_frame(void);
+bool attempt_compression(const sample_store_t* buffer, size_t* buffer_count);
 void init_tasks_last_run(unsigned long start_time);
 void finalize_command(const String& status);
 
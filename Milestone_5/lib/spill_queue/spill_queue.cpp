@@ -0,0 +1,311 @@
+#include "spill_queue.h"
+#include "calculateCRC.h"
+#include <SPIFFS.h>
+#include <Preferences.h>
+
+#define SPILL_RECORD_MAGIC 0x5350  // "SP"
+#define SPILL_HEADER_SIZE 10
+#define SPILL_BODY_FIXED 70        // nonce(4) + frame_len(2) + mac(64)
+#define SPILL_RECORD_MAX (SPILL_HEADER_SIZE + SPILL_BODY_FIXED + UPLOAD_PACKET_MAX)
+#define SPILL_NVS_NAMESPACE "spill"
+#define SPILL_NVS_TAIL "tail"
+
+static bool spill_ready = false;
+static uint32_t segment_first[SPILL_MAX_SEGMENTS];  // Oldest first
+static size_t segment_count = 0;
+static bool write_segment_open = false;  // Newest segment accepts appends
+static size_t write_segment_size = 0;
+static uint32_t head_sequence = 0;
+static uint32_t tail_sequence = 0;
+static size_t read_offset = 0;           // Position in the oldest segment
+static size_t peeked_next_offset = 0;    // Position after the last peeked record
+static uint32_t dropped_records = 0;
+static uint32_t corrupt_records = 0;
+static uint8_t record_buffer[SPILL_RECORD_MAX];
+
+static void segment_path(uint32_t first, char* path, size_t size) {
+    snprintf(path, size, "/spill_%08lx", (unsigned long)first);
+}
+
+static uint16_t get_u16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get_u32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static void put_u16(uint8_t* p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+static void put_u32(uint8_t* p, uint32_t v) { put_u16(p, v & 0xFFFF); put_u16(p + 2, v >> 16); }
+
+static void persist_tail(void) {
+    Preferences nvs;
+    if (nvs.begin(SPILL_NVS_NAMESPACE, false)) {
+        nvs.putUInt(SPILL_NVS_TAIL, tail_sequence);
+        nvs.end();
+    }
+}
+
+// Read and check the record at offset; returns its total size, 0 at the end or on corruption
+static size_t read_record(File& file, size_t offset, uint32_t* sequence, bool* corrupt) {
+    *corrupt = false;
+    if (!file.seek(offset) || file.read(record_buffer, SPILL_HEADER_SIZE) != SPILL_HEADER_SIZE) {
+        return 0;  // Clean end of segment
+    }
+
+    uint16_t body_len = get_u16(record_buffer + 2);
+    if (get_u16(record_buffer) != SPILL_RECORD_MAGIC || body_len < SPILL_BODY_FIXED + 16 ||
+        body_len > SPILL_RECORD_MAX - SPILL_HEADER_SIZE ||
+        file.read(record_buffer + SPILL_HEADER_SIZE, body_len) != body_len ||
+        calculateCRC(record_buffer + 6, 4 + body_len) != get_u16(record_buffer + 4)) {
+        *corrupt = true;
+        return 0;
+    }
+    *sequence = get_u32(record_buffer + 6);
+    return SPILL_HEADER_SIZE + body_len;
+}
+
+static void remove_oldest_segment(void) {
+    char path[24];
+    segment_path(segment_first[0], path, sizeof(path));
+    SPIFFS.remove(path);
+    memmove(segment_first, segment_first + 1, (segment_count - 1) * sizeof(segment_first[0]));
+    segment_count--;
+    read_offset = 0;
+    peeked_next_offset = 0;
+    if (segment_count == 0) {
+        write_segment_open = false;
+    }
+}
+
+bool spill_init(void) {
+    spill_ready = false;
+    segment_count = 0;
+    write_segment_open = false;
+    dropped_records = 0;
+    corrupt_records = 0;
+    read_offset = 0;
+    peeked_next_offset = 0;
+
+    if (!SPIFFS.begin(true)) {
+        Serial.println(F("[SPILL] Failed to mount SPIFFS - spill queue disabled"));
+        return false;
+    }
+
+    Preferences nvs;
+    tail_sequence = 0;
+    if (nvs.begin(SPILL_NVS_NAMESPACE, true)) {
+        tail_sequence = nvs.getUInt(SPILL_NVS_TAIL, 0);
+        nvs.end();
+    }
+
+    // Collect segment files (sorted insert, the index is small)
+    File root = SPIFFS.open("/");
+    for (File file = root.openNextFile(); file; file = root.openNextFile()) {
+        const char* name = strstr(file.name(), "spill_");
+        file.close();
+        if (!name) {
+            continue;
+        }
+        uint32_t first = strtoul(name + 6, nullptr, 16);
+        if (segment_count == SPILL_MAX_SEGMENTS) {
+            char path[24];
+            segment_path(first, path, sizeof(path));
+            SPIFFS.remove(path);
+            continue;
+        }
+        size_t i = segment_count++;
+        while (i > 0 && segment_first[i - 1] > first) {
+            segment_first[i] = segment_first[i - 1];
+            i--;
+        }
+        segment_first[i] = first;
+    }
+
+    // Segments whose successor starts at or below the tail are fully delivered
+    while (segment_count > 1 && segment_first[1] <= tail_sequence) {
+        remove_oldest_segment();
+    }
+
+    // Scan the newest segment for the head; a torn record closes it for appends
+    head_sequence = tail_sequence;
+    if (segment_count > 0) {
+        char path[24];
+        segment_path(segment_first[segment_count - 1], path, sizeof(path));
+        File file = SPIFFS.open(path, FILE_READ);
+        uint32_t next = segment_first[segment_count - 1];
+        size_t offset = 0;
+        bool corrupt = false;
+        if (file) {
+            size_t size = file.size();
+            uint32_t sequence;
+            size_t record_len;
+            while ((record_len = read_record(file, offset, &sequence, &corrupt)) > 0) {
+                next = sequence + 1;
+                offset += record_len;
+            }
+            if (corrupt || offset != size) {
+                corrupt_records++;
+                Serial.printf("[SPILL] Torn record at %s:%u - segment closed\n", path, (unsigned)offset);
+            } else {
+                write_segment_open = true;
+                write_segment_size = offset;
+            }
+            file.close();
+        }
+        if (next > head_sequence) {
+            head_sequence = next;
+        }
+    }
+    if (segment_count > 0 && tail_sequence < segment_first[0]) {
+        tail_sequence = segment_first[0];
+    }
+
+    spill_ready = true;
+    Serial.printf("[SPILL] Ready: %u records in %u segments (tail %u, head %u)\n", spill_count(),
+                  (unsigned)segment_count, tail_sequence, head_sequence);
+    return true;
+}
+
+bool spill_append(const upload_packet_t* packet) {
+    if (!spill_ready || !packet->sealed) {
+        return false;
+    }
+
+    size_t body_len = SPILL_BODY_FIXED + packet->payload_len;
+    size_t record_len = SPILL_HEADER_SIZE + body_len;
+    if (record_len > SPILL_RECORD_MAX) {
+        return false;
+    }
+
+    // Start a new segment when the newest one is full or was closed. A newest segment
+    // named after head_sequence holds no record (its first write failed or was torn):
+    // it is started over rather than indexed twice under the same file name.
+    if (!write_segment_open || write_segment_size + record_len > SPILL_SEGMENT_BYTES) {
+        if (segment_count == 0 || segment_first[segment_count - 1] != head_sequence) {
+            if (segment_count == SPILL_MAX_SEGMENTS) {
+                uint32_t next_first = segment_first[1];
+                if (next_first > tail_sequence) {
+                    dropped_records += next_first - tail_sequence;
+                    tail_sequence = next_first;
+                    persist_tail();
+                }
+                remove_oldest_segment();
+                Serial.printf("[SPILL] Queue full - dropped oldest segment (%u records lost so far)\n", dropped_records);
+            }
+            segment_first[segment_count++] = head_sequence;
+        }
+        write_segment_open = true;
+        write_segment_size = 0;
+    }
+
+    uint8_t* record = record_buffer;
+    put_u16(record, SPILL_RECORD_MAGIC);
+    put_u16(record + 2, (uint16_t)body_len);
+    put_u32(record + 6, head_sequence);
+    put_u32(record + 10, packet->nonce);
+    put_u16(record + 14, packet->frame_len);
+    memcpy(record + 16, packet->mac, 64);
+    memcpy(record + 80, packet->payload, packet->payload_len);
+    put_u16(record + 4, calculateCRC(record + 6, (int)(4 + body_len)));
+
+    char path[24];
+    segment_path(segment_first[segment_count - 1], path, sizeof(path));
+    File file = SPIFFS.open(path, write_segment_size == 0 ? FILE_WRITE : FILE_APPEND);  // Drops torn leftovers
+    size_t written = file ? file.write(record, record_len) : 0;
+    if (file) {
+        file.flush();
+        file.close();
+    }
+    if (written != record_len) {
+        // Whatever reached flash fails its CRC; appends continue in a new segment
+        write_segment_open = false;
+        Serial.println(F("[SPILL] ERROR: Flash write failed"));
+        return false;
+    }
+
+    write_segment_size += record_len;
+    head_sequence++;
+    return true;
+}
+
+bool spill_peek(upload_packet_t* packet, uint32_t* sequence) {
+    while (spill_ready && segment_count > 0 && tail_sequence < head_sequence) {
+        char path[24];
+        segment_path(segment_first[0], path, sizeof(path));
+        File file = SPIFFS.open(path, FILE_READ);
+        bool corrupt = false;
+        uint32_t record_sequence = 0;
+        size_t record_len = file ? read_record(file, read_offset, &record_sequence, &corrupt) : 0;
+        if (file) {
+            file.close();
+        }
+
+        if (record_len == 0) {
+            // End of this segment (or unreadable from here): move on to the next one
+            if (corrupt) {
+                corrupt_records++;
+            }
+            if (segment_count == 1) {
+                if (!corrupt && file) {
+                    return false;  // Newest segment, nothing more written yet
+                }
+                tail_sequence = head_sequence;
+                persist_tail();
+                remove_oldest_segment();
+                return false;
+            }
+            if (segment_first[1] > tail_sequence) {
+                tail_sequence = segment_first[1];
+                persist_tail();
+            }
+            remove_oldest_segment();
+            continue;
+        }
+
+        if (record_sequence < tail_sequence) {
+            read_offset += record_len;  // Delivered before a reset
+            continue;
+        }
+
+        const uint8_t* body = record_buffer + SPILL_HEADER_SIZE;
+        packet->tag = record_sequence;
+        packet->sealed = true;
+        packet->nonce = get_u32(body);
+        packet->frame_len = get_u16(body + 4);
+        memcpy(packet->mac, body + 6, 64);
+        packet->mac[64] = '\0';
+        packet->payload_len = (uint16_t)(record_len - SPILL_HEADER_SIZE - SPILL_BODY_FIXED);
+        memcpy(packet->payload, body + SPILL_BODY_FIXED, packet->payload_len);
+
+        *sequence = record_sequence;
+        peeked_next_offset = read_offset + record_len;
+        return true;
+    }
+    return false;
+}
+
+void spill_ack(uint32_t sequence) {
+    if (!spill_ready || sequence < tail_sequence || segment_count == 0) {
+        return;
+    }
+    tail_sequence = sequence + 1;
+    read_offset = peeked_next_offset;
+    persist_tail();
+
+    // Everything written is delivered: drop the files, the next append starts fresh
+    if (tail_sequence >= head_sequence) {
+        while (segment_count > 0) {
+            remove_oldest_segment();
+        }
+    }
+}
+
+uint32_t spill_count(void) {
+    return head_sequence - tail_sequence;
+}
+
+spill_stats_t spill_get_stats(void) {
+    spill_stats_t stats;
+    stats.segments = segment_count;
+    stats.records = spill_count();
+    stats.head_sequence = head_sequence;
+    stats.tail_sequence = tail_sequence;
+    stats.dropped_records = dropped_records;
+    stats.corrupt_records = corrupt_records;
+    return stats;
+}
@@ -0,0 +1,45 @@
+#ifndef SPILL_QUEUE_H
+#define SPILL_QUEUE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "upload_pipeline.h"
+
+// Store-and-forward queue of sealed (encrypted, MACed) upload frames on the
+// SPIFFS partition. Blocks the RAM history has no room for spill here while
+// the cloud is unreachable, and are drained oldest-first once it is back.
+//
+// Log-structured: records are appended to segment files named after their
+// first sequence number ("/spill_<seq>"). Each record is
+//   [magic u16][length u16][crc16 u16][sequence u32][body]
+// with the CRC over sequence and body, so a record torn by a reset is found
+// at boot and the segment is closed there. The delivery tail (next sequence
+// to send) persists in NVS; the head is recovered by scanning the newest
+// segment. Consumed segments are deleted; a full queue drops its oldest
+// segment. Only the segment index lives in RAM.
+
+typedef struct {
+    size_t segments;
+    uint32_t records;          // Records waiting on flash
+    uint32_t head_sequence;    // Next sequence to append
+    uint32_t tail_sequence;    // Next sequence to deliver
+    uint32_t dropped_records;  // Lost to a full queue
+    uint32_t corrupt_records;  // Failed CRC / torn at reset
+} spill_stats_t;
+
+// Recover head, tail and segments from flash (SPIFFS must be mountable)
+bool spill_init(void);
+
+// Append a sealed frame; false if flash is unavailable or the write failed
+bool spill_append(const upload_packet_t* packet);
+
+// Oldest undelivered record (not removed until spill_ack)
+bool spill_peek(upload_packet_t* packet, uint32_t* sequence);
+
+// The record from the last spill_peek was delivered
+void spill_ack(uint32_t sequence);
+
+uint32_t spill_count(void);
+spill_stats_t spill_get_stats(void);
+
+#endif // SPILL_QUEUE_H
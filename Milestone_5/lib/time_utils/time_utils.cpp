@@ -1,4 +1,5 @@
 #include "time_utils.h"
+#include <sys/time.h>
 
 static unsigned long lastSyncMillis = 0;   // Track last NTP sync
 static bool timeInitialized = false;       // Track if NTP has synced at least once
@@ -27,6 +28,17 @@ void init_time(const char* ntpServer, long gmtOffset_sec, int daylightOffset_sec
     }
 }
 
+bool time_unix_ms_at(uint32_t millis_at, uint64_t* unix_ms) {
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    uint32_t elapsed_ms = millis() - millis_at;
+    if (now.tv_sec < 100000) {
+        return false;
+    }
+    *unix_ms = (uint64_t)now.tv_sec * 1000 + now.tv_usec / 1000 - elapsed_ms;
+    return true;
+}
+
 String get_current_timestamp() {
     time_t now;
     struct tm timeinfo;
@@ -18,4 +18,8 @@ void init_time(const char* ntpServer = DEFAULT_NTP_SERVER,
 // Returns the current local timestamp (ISO 8601 format: YYYY-MM-DDTHH:MM:SS+05:30)
 String get_current_timestamp();
 
+// Unix time (ms) of an earlier millis() reading: the NTP-disciplined clock now, minus the
+// monotonic time elapsed since. False if the clock has not synced yet.
+bool time_unix_ms_at(uint32_t millis_at, uint64_t* unix_ms);
+
 #endif // TIME_UTILS_H
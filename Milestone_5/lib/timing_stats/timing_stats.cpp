@@ -0,0 +1,124 @@
+#include "timing_stats.h"
+#include <cstring>
+#include "varint.h"
+
+static void saturating_add(uint16_t* counter, uint32_t amount) {
+    uint32_t sum = (uint32_t)*counter + amount;
+    *counter = sum > UINT16_MAX ? UINT16_MAX : (uint16_t)sum;
+}
+
+size_t timing_bucket(uint32_t value) {
+    size_t bucket = 0;
+    while (value > 0 && bucket < TIMING_BUCKETS - 1) {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+uint32_t timing_bucket_limit(size_t bucket) {
+    if (bucket >= TIMING_BUCKETS - 1) {
+        return 0;
+    }
+    return (uint32_t)1 << bucket;
+}
+
+void timing_record(task_timing_t* timing, uint32_t lateness_ms, uint32_t runtime_ms) {
+    saturating_add(&timing->lateness_ms.buckets[timing_bucket(lateness_ms)], 1);
+    saturating_add(&timing->runtime_ms.buckets[timing_bucket(runtime_ms)], 1);
+    saturating_add(&timing->runs, 1);
+}
+
+void timing_add_missed(task_timing_t* timing, uint32_t missed) {
+    saturating_add(&timing->missed, missed);
+}
+
+void timing_clear(task_timing_t* timing, size_t task_count) {
+    memset(timing, 0, task_count * sizeof(task_timing_t));
+}
+
+static bool put_histogram(const timing_histogram_t* histogram, uint8_t* out, size_t capacity, size_t* pos) {
+    uint16_t mask = 0;
+    for (size_t i = 0; i < TIMING_BUCKETS; i++) {
+        if (histogram->buckets[i]) {
+            mask |= (uint16_t)(1u << i);
+        }
+    }
+    if (*pos + 2 > capacity) {
+        return false;
+    }
+    out[(*pos)++] = mask & 0xFF;
+    out[(*pos)++] = mask >> 8;
+    for (size_t i = 0; i < TIMING_BUCKETS; i++) {
+        if (histogram->buckets[i] && !put_varint(out, capacity, pos, histogram->buckets[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool get_histogram(const uint8_t* in, size_t length, size_t* pos, timing_histogram_t* histogram) {
+    if (*pos + 2 > length) {
+        return false;
+    }
+    uint16_t mask = (uint16_t)(in[*pos] | (in[*pos + 1] << 8));
+    *pos += 2;
+    for (size_t i = 0; i < TIMING_BUCKETS; i++) {
+        uint32_t count = 0;
+        if ((mask & (1u << i)) && !get_varint(in, length, pos, &count)) {
+            return false;
+        }
+        histogram->buckets[i] = count > UINT16_MAX ? UINT16_MAX : (uint16_t)count;
+    }
+    return true;
+}
+
+size_t timing_encode(const task_timing_t* tasks, size_t task_count, uint8_t* out, size_t capacity) {
+    if (capacity < 1 || task_count > UINT8_MAX) {
+        return 0;
+    }
+    size_t pos = 1;
+    uint8_t active = 0;
+    for (size_t id = 0; id < task_count; id++) {
+        const task_timing_t* timing = &tasks[id];
+        if (timing->runs == 0 && timing->missed == 0) {
+            continue;
+        }
+        if (pos >= capacity) {
+            return 0;
+        }
+        out[pos++] = (uint8_t)id;
+        if (!put_varint(out, capacity, &pos, timing->runs) || !put_varint(out, capacity, &pos, timing->missed) ||
+            !put_histogram(&timing->lateness_ms, out, capacity, &pos) ||
+            !put_histogram(&timing->runtime_ms, out, capacity, &pos)) {
+            return 0;
+        }
+        active++;
+    }
+    out[0] = active;
+    return pos;
+}
+
+bool timing_decode(const uint8_t* value, size_t length, task_timing_t* tasks, size_t task_count) {
+    timing_clear(tasks, task_count);
+    if (length < 1) {
+        return false;
+    }
+    size_t pos = 1;
+    for (uint8_t i = 0; i < value[0]; i++) {
+        if (pos >= length || value[pos] >= task_count) {
+            return false;
+        }
+        task_timing_t* timing = &tasks[value[pos++]];
+        uint32_t runs = 0;
+        uint32_t missed = 0;
+        if (!get_varint(value, length, &pos, &runs) || !get_varint(value, length, &pos, &missed) ||
+            !get_histogram(value, length, &pos, &timing->lateness_ms) ||
+            !get_histogram(value, length, &pos, &timing->runtime_ms)) {
+            return false;
+        }
+        timing->runs = runs > UINT16_MAX ? UINT16_MAX : (uint16_t)runs;
+        timing->missed = missed > UINT16_MAX ? UINT16_MAX : (uint16_t)missed;
+    }
+    return pos == length;
+}
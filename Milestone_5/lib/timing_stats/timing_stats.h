@@ -0,0 +1,45 @@
+#ifndef TIMING_STATS_H
+#define TIMING_STATS_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Per-task timing: log2 histograms of start lateness and run time (ms) plus
+// missed-period counters. Portable so host-side decoders can read the
+// FRAME_TLV_TASK_TIMING trailer record (see frame_format.h).
+//
+// Bucket 0 counts 0 ms, bucket i counts [2^(i-1), 2^i) ms, the last bucket
+// everything above. Counters saturate instead of wrapping.
+
+#define TIMING_BUCKETS 16
+
+typedef struct {
+    uint16_t buckets[TIMING_BUCKETS];
+} timing_histogram_t;
+
+typedef struct {
+    timing_histogram_t lateness_ms;  // Start time minus nominal deadline
+    timing_histogram_t runtime_ms;
+    uint16_t runs;
+    uint16_t missed;                 // Periods skipped because the task was too late
+} task_timing_t;
+
+size_t timing_bucket(uint32_t value);
+
+// Upper bound (exclusive) of a bucket in ms; 0 for the open-ended last bucket
+uint32_t timing_bucket_limit(size_t bucket);
+
+void timing_record(task_timing_t* timing, uint32_t lateness_ms, uint32_t runtime_ms);
+void timing_add_missed(task_timing_t* timing, uint32_t missed);
+void timing_clear(task_timing_t* timing, size_t task_count);
+
+// TLV value: [task count] then per task with activity
+//   [task id][runs varint][missed varint][lateness mask u16][counts varint..]
+//   [runtime mask u16][counts varint..]
+// (mask bit i set = bucket i non-zero, little endian). Returns 0 if it does not fit.
+size_t timing_encode(const task_timing_t* tasks, size_t task_count, uint8_t* out, size_t capacity);
+
+// Decode into tasks[task id] (zeroed first); false on malformed input
+bool timing_decode(const uint8_t* value, size_t length, task_timing_t* tasks, size_t task_count);
+
+#endif // TIMING_STATS_H
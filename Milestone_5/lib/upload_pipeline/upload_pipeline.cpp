@@ -0,0 +1,223 @@
+#include "upload_pipeline.h"
+#include "cloudAPI_handler.h"
+#include "encryptionAndSecurity.h"
+
+extern NonceManager nonceManager; // Declare the global instance from main.cpp
+
+// Frame waiting for the seal stage
+typedef struct {
+    uint32_t tag;
+    uint16_t length;
+    uint8_t frame[UPLOAD_FRAME_MAX];
+} upload_job_t;
+
+static QueueHandle_t job_queue = nullptr;     // compress -> seal
+static QueueHandle_t packet_queue = nullptr;  // seal -> network
+static TaskHandle_t seal_task_handle = nullptr;
+static size_t in_flight = 0;  // Submitted, not yet taken by the network stage (loop only)
+
+// The seal task (core 0) and inline seals on the loop (core 1) share the AES/HMAC
+// state and the nonce counter, so sealing is serialized; stage_stats is updated
+// from both cores under a spinlock
+static SemaphoreHandle_t seal_mutex = nullptr;
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static pipeline_stage_stats_t stage_stats[PIPELINE_STAGE_COUNT];
+
+static const char* const STAGE_NAMES[PIPELINE_STAGE_COUNT] = {"compress", "seal", "network"};
+
+static void note_queue_depth(pipeline_stage_t stage, QueueHandle_t queue) {
+    uint32_t depth = (uint32_t)uxQueueMessagesWaiting(queue);
+    taskENTER_CRITICAL(&stats_mux);
+    if (depth > stage_stats[stage].queue_peak) {
+        stage_stats[stage].queue_peak = depth;
+    }
+    taskEXIT_CRITICAL(&stats_mux);
+}
+
+// CRC, AES-256-CBC with a random IV, then HMAC over the base64 of IV + ciphertext.
+// Caller holds seal_mutex.
+static void seal_frame_locked(const upload_job_t* job, upload_packet_t* packet, unsigned long start) {
+    uint8_t frame_with_crc[UPLOAD_FRAME_MAX + 2];
+    append_crc_to_upload_frame(job->frame, job->length, frame_with_crc);
+
+    // Payload layout: IV (16) + ciphertext
+    size_t encrypted_len = 0;
+    if (!encryptPayloadAES_CBC(frame_with_crc, job->length + 2, packet->payload + 16, &encrypted_len,
+                               packet->payload)) {
+        Serial.println(F("[ENCRYPTION] Encryption failed! Aborting upload."));
+        return;
+    }
+    packet->payload_len = (uint16_t)(16 + encrypted_len);
+    packet->nonce = nonceManager.getAndIncrementNonce();
+
+    String mac = generateMAC(encodeBase64(packet->payload, packet->payload_len));
+    strncpy(packet->mac, mac.c_str(), sizeof(packet->mac) - 1);
+    packet->mac[sizeof(packet->mac) - 1] = '\0';
+    packet->sealed = true;
+
+    upload_pipeline_record(PIPELINE_STAGE_SEAL, micros() - start);
+}
+
+// Seal on any task; waits for a seal running on the other core
+static void seal_frame(const upload_job_t* job, upload_packet_t* packet) {
+    unsigned long start = micros();
+    packet->tag = job->tag;
+    packet->sealed = false;
+    packet->frame_len = job->length;
+    packet->payload_len = 0;
+    packet->mac[0] = '\0';
+
+    if (xSemaphoreTake(seal_mutex, pdMS_TO_TICKS(UPLOAD_SEAL_TIMEOUT_MS)) != pdTRUE) {
+        Serial.println(F("[PIPELINE] ERROR: Seal lock timeout"));
+        return;
+    }
+    seal_frame_locked(job, packet, start);
+    xSemaphoreGive(seal_mutex);
+}
+
+static void seal_task(void* param) {
+    (void)param;
+    static upload_job_t job;
+    static upload_packet_t packet;
+    for (;;) {
+        if (xQueueReceive(job_queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        seal_frame(&job, &packet);
+        // Never blocks long: the loop keeps at most UPLOAD_PIPELINE_DEPTH frames in flight
+        xQueueSend(packet_queue, &packet, portMAX_DELAY);
+        note_queue_depth(PIPELINE_STAGE_NETWORK, packet_queue);
+    }
+}
+
+bool upload_pipeline_init(void) {
+    if (job_queue && packet_queue) {
+        return true;
+    }
+
+    if (!seal_mutex) {
+        seal_mutex = xSemaphoreCreateMutex();
+        if (!seal_mutex) {
+            Serial.println(F("[PIPELINE] ERROR: Failed to create seal mutex"));
+            return false;
+        }
+    }
+    job_queue = xQueueCreate(UPLOAD_PIPELINE_DEPTH, sizeof(upload_job_t));
+    packet_queue = xQueueCreate(UPLOAD_PIPELINE_DEPTH, sizeof(upload_packet_t));
+    if (!job_queue || !packet_queue) {
+        Serial.println(F("[PIPELINE] ERROR: Failed to create stage queues"));
+        return false;
+    }
+    in_flight = 0;
+    taskENTER_CRITICAL(&stats_mux);
+    memset(stage_stats, 0, sizeof(stage_stats));
+    taskEXIT_CRITICAL(&stats_mux);
+
+    BaseType_t created = xTaskCreatePinnedToCore(seal_task, "upload_seal", UPLOAD_SEAL_TASK_STACK, nullptr,
+                                                 UPLOAD_SEAL_TASK_PRIORITY, &seal_task_handle,
+                                                 UPLOAD_SEAL_TASK_CORE);
+    if (created != pdPASS) {
+        seal_task_handle = nullptr;
+        Serial.println(F("[PIPELINE] WARNING: Seal task not started, sealing inline"));
+    } else {
+        Serial.printf("[PIPELINE] Seal stage on core %d, %d frames per queue\n",
+                      UPLOAD_SEAL_TASK_CORE, UPLOAD_PIPELINE_DEPTH);
+    }
+    return true;
+}
+
+bool upload_pipeline_submit(const uint8_t* frame, size_t length, uint32_t tag) {
+    if (length == 0 || length > UPLOAD_FRAME_MAX || in_flight >= UPLOAD_PIPELINE_DEPTH) {
+        return false;
+    }
+    if (!upload_pipeline_init()) {
+        return false;
+    }
+
+    static upload_job_t job;
+    job.tag = tag;
+    job.length = (uint16_t)length;
+    memcpy(job.frame, frame, length);
+
+    if (seal_task_handle) {
+        if (xQueueSend(job_queue, &job, 0) != pdTRUE) {
+            return false;
+        }
+        note_queue_depth(PIPELINE_STAGE_SEAL, job_queue);
+    } else {
+        static upload_packet_t packet;
+        seal_frame(&job, &packet);
+        if (xQueueSend(packet_queue, &packet, 0) != pdTRUE) {
+            return false;
+        }
+        note_queue_depth(PIPELINE_STAGE_NETWORK, packet_queue);
+    }
+    in_flight++;
+    return true;
+}
+
+bool upload_pipeline_seal(const uint8_t* frame, size_t length, uint32_t tag, upload_packet_t* packet) {
+    if (length == 0 || length > UPLOAD_FRAME_MAX) {
+        return false;
+    }
+    if (!upload_pipeline_init()) {
+        return false;
+    }
+    static upload_job_t job;
+    job.tag = tag;
+    job.length = (uint16_t)length;
+    memcpy(job.frame, frame, length);
+    seal_frame(&job, packet);
+    return packet->sealed;
+}
+
+bool upload_pipeline_next(upload_packet_t* packet) {
+    if (in_flight == 0) {
+        return false;
+    }
+    if (xQueueReceive(packet_queue, packet, pdMS_TO_TICKS(UPLOAD_SEAL_TIMEOUT_MS)) != pdTRUE) {
+        Serial.println(F("[PIPELINE] ERROR: Seal stage timed out"));
+        return false;
+    }
+    in_flight--;
+    return true;
+}
+
+void upload_pipeline_flush(void) {
+    static upload_packet_t discarded;
+    while (in_flight > 0 && upload_pipeline_next(&discarded)) {
+    }
+}
+
+size_t upload_pipeline_in_flight(void) {
+    return in_flight;
+}
+
+void upload_pipeline_record(pipeline_stage_t stage, uint32_t elapsed_us) {
+    taskENTER_CRITICAL(&stats_mux);
+    pipeline_stage_stats_t* stats = &stage_stats[stage];
+    stats->frames++;
+    stats->total_us += elapsed_us;
+    if (elapsed_us > stats->max_us) {
+        stats->max_us = elapsed_us;
+    }
+    taskEXIT_CRITICAL(&stats_mux);
+}
+
+// Consistent snapshot (the seal task may be recording on the other core)
+pipeline_stage_stats_t upload_pipeline_get_stats(pipeline_stage_t stage) {
+    taskENTER_CRITICAL(&stats_mux);
+    pipeline_stage_stats_t snapshot = stage_stats[stage];
+    taskEXIT_CRITICAL(&stats_mux);
+    return snapshot;
+}
+
+void upload_pipeline_print_stats(void) {
+    for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        pipeline_stage_stats_t snapshot = upload_pipeline_get_stats((pipeline_stage_t)i);
+        const pipeline_stage_stats_t* stats = &snapshot;
+        Serial.printf("[PIPELINE] %-8s frames %u, avg %u us, max %u us, queue peak %u\n", STAGE_NAMES[i],
+                      stats->frames, stats->frames ? stats->total_us / stats->frames : 0, stats->max_us,
+                      stats->queue_peak);
+    }
+}
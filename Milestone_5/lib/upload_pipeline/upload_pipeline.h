@@ -0,0 +1,66 @@
+#ifndef UPLOAD_PIPELINE_H
+#define UPLOAD_PIPELINE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "frame_format.h"
+
+// Upload pipeline: compress -> seal (CRC, AES-256-CBC, base64 + HMAC) -> network.
+// Compression runs in the loop as samples arrive (stream encoder); sealing runs
+// in its own task pinned to the other core; the loop does the HTTP exchange,
+// since the cloud response drives commands, configuration and FOTA. Stages are
+// joined by bounded FreeRTOS queues, so frame N+1 is sealed while frame N is on
+// the wire. Frames leave the pipeline in submission order.
+
+#define UPLOAD_FRAME_MAX (MAX_PAYLOAD_SIZE + 2 + FRAME_TRAILER_MAX)  // [flags][window][payload][trailer]
+#define UPLOAD_PACKET_MAX (16 + UPLOAD_FRAME_MAX + 2 + 16)  // IV + ciphertext of frame + CRC, padded
+
+typedef enum {
+    PIPELINE_STAGE_COMPRESS,
+    PIPELINE_STAGE_SEAL,
+    PIPELINE_STAGE_NETWORK,
+    PIPELINE_STAGE_COUNT
+} pipeline_stage_t;
+
+typedef struct {
+    uint32_t frames;      // Frames through the stage
+    uint32_t total_us;
+    uint32_t max_us;
+    uint32_t queue_peak;  // Deepest input queue seen (compress has none)
+} pipeline_stage_stats_t;
+
+// Sealed frame, ready for the network stage
+typedef struct {
+    uint32_t tag;          // Caller id (history sequence)
+    bool sealed;           // false: encryption failed, do not send
+    uint16_t frame_len;    // Plain frame length (without CRC)
+    uint16_t payload_len;  // IV + ciphertext
+    uint32_t nonce;
+    char mac[65];          // HMAC-SHA256 of the base64 payload, hex
+    uint8_t payload[UPLOAD_PACKET_MAX];
+} upload_packet_t;
+
+// Create the stage queues and the seal task (sealing runs inline if the task cannot start)
+bool upload_pipeline_init(void);
+
+// Copy a frame into the seal stage; false when UPLOAD_PIPELINE_DEPTH frames are in flight
+bool upload_pipeline_submit(const uint8_t* frame, size_t length, uint32_t tag);
+
+// Seal a frame on the calling task, bypassing the queues (alarms, spilling to flash);
+// waits while the seal task is sealing, since both use the same cipher and nonce state
+bool upload_pipeline_seal(const uint8_t* frame, size_t length, uint32_t tag, upload_packet_t* packet);
+
+// Take the oldest sealed frame (waits up to UPLOAD_SEAL_TIMEOUT_MS); false if none in flight
+bool upload_pipeline_next(upload_packet_t* packet);
+
+// Drop every frame in flight (after a failed send; they are resubmitted next cycle)
+void upload_pipeline_flush(void);
+
+size_t upload_pipeline_in_flight(void);
+
+// Stage latency bookkeeping; the loop records compress and network itself
+void upload_pipeline_record(pipeline_stage_t stage, uint32_t elapsed_us);
+pipeline_stage_stats_t upload_pipeline_get_stats(pipeline_stage_t stage);
+void upload_pipeline_print_stats(void);
+
+#endif // UPLOAD_PIPELINE_H
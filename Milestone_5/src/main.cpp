@@ -75,6 +75,9 @@ void setup() {
         Serial.println(F("System initialized successfully"));
     }
     
+    // Buffers, history and (when enabled) the acquisition task
+    scheduler_init();
+
     Serial.println(F("Starting main operation loop..."));
     Serial.println();
 
@@ -99,13 +102,10 @@ void setup() {
 }
 
 void loop() {
-    // Run the scheduler (handles all periodic tasks)
+    // Run the scheduler (handles all periodic tasks, then blocks until the next deadline)
     scheduler_run();
     
     // Process HTTP configuration requests
     // Configuration processing is now integrated with cloud upload responses
-    
-    // Small delay to prevent tight looping
-    delay(100);
 }
 #endif
\ No newline at end of file
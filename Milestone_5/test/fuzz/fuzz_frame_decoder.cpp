@@ -0,0 +1,111 @@
+// libFuzzer target for the upload frame decoder (decompressor.h): arbitrary
+// bytes must never crash, hang or read out of bounds, whatever the flags,
+// method, codec tags or trailer records claim.
+//
+// Build and run from Milestone_5/ (clang):
+//   clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address,undefined -Ilib/compression -Ilib/calculateCRC
+//       test/fuzz/fuzz_frame_decoder.cpp lib/compression/{decompressor,codecs,bitstream,predictor}.cpp
+//       lib/calculateCRC/calculateCRC.cpp -o fuzz_frame_decoder
+//   ./fuzz_frame_decoder -max_len=4096 corpus/
+//
+// Without libFuzzer (e.g. g++ -fsanitize=address,undefined), add -DFUZZ_STANDALONE:
+// the binary then replays the files given as arguments, or runs a fixed number
+// of pseudo-random inputs when there are none.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "decompressor.h"
+
+// Largest frame the firmware builds is well under this; the decoder must bound itself
+#define FUZZ_MAX_VALUES (4096 * 16)
+
+static uint16_t values[FUZZ_MAX_VALUES];
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    size_t sample_count = 0;
+    uint8_t register_count = 0;
+
+    if (decompress_frame(data, size, values, FUZZ_MAX_VALUES, &sample_count, &register_count)) {
+        if (sample_count * register_count > FUZZ_MAX_VALUES) {
+            abort();
+        }
+    }
+    decompress_upload_frame(data, size, values, FUZZ_MAX_VALUES, &sample_count, &register_count);
+    // Tight output: decoders must check the capacity, not assume it
+    decompress_frame(data, size, values, 7, &sample_count, &register_count);
+    frame_aggregation_window(data, size);
+
+    size_t trailer_len = 0;
+    const uint8_t* trailer = frame_trailer(data, size, &trailer_len);
+    if (trailer) {
+        if (trailer < data || trailer + trailer_len > data + size) {
+            abort();
+        }
+        for (int type = 0; type < 8; type++) {
+            size_t value_len = 0;
+            const uint8_t* value = frame_tlv_find(trailer, trailer_len, (uint8_t)type, &value_len);
+            if (value && value + value_len > trailer + trailer_len) {
+                abort();
+            }
+        }
+    }
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+static uint32_t next_random(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            FILE* file = fopen(argv[i], "rb");
+            if (!file) {
+                fprintf(stderr, "cannot open %s\n", argv[i]);
+                return 1;
+            }
+            std::vector<uint8_t> input;
+            int c;
+            while ((c = fgetc(file)) != EOF) {
+                input.push_back((uint8_t)c);
+            }
+            fclose(file);
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+        return 0;
+    }
+
+    // Random frames with a plausible header, so the codecs are reached
+    uint32_t state = 0x2545F491;
+    std::vector<uint8_t> input;
+    for (int run = 0; run < 200000; run++) {
+        size_t size = next_random(&state) % 300;
+        input.assign(size, 0);
+        for (size_t i = 0; i < size; i++) {
+            input[i] = (uint8_t)next_random(&state);
+        }
+        if (size > 6 && (run & 1)) {
+            input[0] &= 0x2F;                                  // Known method, any flags
+            size_t prefix = (input[0] & 0x01) ? 2 : 1;
+            if (size > prefix + 5) {
+                input[prefix] = 0;                             // Sample count < 256
+                input[prefix + 2] = (uint8_t)(next_random(&state) % 12);
+                size_t data_len = size - prefix - 5;
+                input[prefix + 3] = (uint8_t)(data_len >> 8);
+                input[prefix + 4] = (uint8_t)data_len;
+            }
+        }
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    printf("200000 inputs OK\n");
+    return 0;
+}
+#endif
@@ -0,0 +1,56 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Minimal Arduino surface for the [env:native] host tests: just what the
+// portable libraries (compression, sample_store, ...) touch. Serial output
+// is discarded; millis()/micros() come from the host steady clock.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <string>
+
+#define PROGMEM
+#define F(x) x
+#define HEX 16
+
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define pgm_read_float(p) (*(const float*)(p))
+#define pgm_read_ptr(p) (*(void* const*)(p))
+
+inline unsigned long millis(void) {
+    using namespace std::chrono;
+    return (unsigned long)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline unsigned long micros(void) {
+    using namespace std::chrono;
+    return (unsigned long)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+class String : public std::string {
+public:
+    String() {}
+    String(const char* text) : std::string(text ? text : "") {}
+    String(const std::string& text) : std::string(text) {}
+
+    String substring(size_t from, size_t to) const { return String(substr(from, to - from)); }
+};
+
+struct NativeSerial {
+    template <typename T> void print(const T&) {}
+    template <typename T> void print(const T&, int) {}
+    template <typename T> void println(const T&) {}
+    template <typename T> void println(const T&, int) {}
+    void println(void) {}
+    void printf(const char*, ...) {}
+};
+
+extern NativeSerial Serial;
+
+#endif // NATIVE_ARDUINO_H
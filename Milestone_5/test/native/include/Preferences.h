@@ -0,0 +1,35 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+// In-memory NVS for the [env:native] host tests; values survive a
+// simulated reboot (a new Preferences object) until native_nvs is cleared.
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+inline std::map<std::string, uint32_t> native_nvs;
+
+class Preferences {
+public:
+    bool begin(const char* name, bool read_only = false) {
+        (void)read_only;
+        prefix_ = std::string(name) + "/";
+        return true;
+    }
+    void end(void) {}
+
+    uint32_t getUInt(const char* key, uint32_t default_value = 0) {
+        auto it = native_nvs.find(prefix_ + key);
+        return it == native_nvs.end() ? default_value : it->second;
+    }
+    size_t putUInt(const char* key, uint32_t value) {
+        native_nvs[prefix_ + key] = value;
+        return sizeof(value);
+    }
+
+private:
+    std::string prefix_;
+};
+
+#endif // NATIVE_PREFERENCES_H
@@ -0,0 +1,137 @@
+#ifndef NATIVE_SPIFFS_H
+#define NATIVE_SPIFFS_H
+
+// In-memory SPIFFS for the [env:native] host tests: the File calls the
+// spill queue makes, over a map of file name -> bytes that survives a
+// simulated reboot. Tests can make the next writes fail partway
+// (fail_writes / keep_bytes) to model a full or failing flash.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+class NativeFS;
+
+class File {
+public:
+    File() : fs_(nullptr), dir_(false), pos_(0), next_(0) {}
+
+    explicit operator bool() const { return fs_ != nullptr; }
+
+    size_t write(const uint8_t* data, size_t length);
+    size_t read(uint8_t* data, size_t length);
+    bool seek(uint32_t pos) {
+        if (!fs_ || pos > bytes().size()) {
+            return false;
+        }
+        pos_ = pos;
+        return true;
+    }
+    size_t size() { return fs_ ? bytes().size() : 0; }
+    const char* name() const { return name_.c_str() + 1; }  // Without the leading '/', as the ESP32 core
+    void flush() {}
+    void close() { fs_ = nullptr; }
+    File openNextFile();
+
+private:
+    friend class NativeFS;
+    std::vector<uint8_t>& bytes();
+
+    NativeFS* fs_;
+    std::string name_;
+    bool dir_;
+    size_t pos_;
+    size_t next_;  // Directory: index of the next file
+};
+
+class NativeFS {
+public:
+    std::map<std::string, std::vector<uint8_t>> files;
+    bool mountable = true;
+    int fail_writes = 0;     // Number of upcoming writes that fail
+    size_t keep_bytes = 0;   // Bytes a failing write still stores (a torn record)
+
+    bool begin(bool format_if_failed = false) {
+        (void)format_if_failed;
+        return mountable;
+    }
+
+    bool exists(const char* path) { return files.count(path) > 0; }
+
+    bool remove(const char* path) { return files.erase(path) > 0; }
+
+    File open(const char* path, const char* mode = FILE_READ) {
+        File file;
+        std::string name(path);
+        if (name == "/") {
+            file.fs_ = this;
+            file.name_ = name;
+            file.dir_ = true;
+            return file;
+        }
+        if (mode[0] == 'r' && !exists(path)) {
+            return file;
+        }
+        if (mode[0] == 'w') {
+            files[name].clear();
+        }
+        file.fs_ = this;
+        file.name_ = name;
+        file.pos_ = mode[0] == 'a' ? files[name].size() : 0;
+        return file;
+    }
+};
+
+inline NativeFS SPIFFS;
+
+inline std::vector<uint8_t>& File::bytes() {
+    return fs_->files[name_];
+}
+
+inline size_t File::write(const uint8_t* data, size_t length) {
+    if (!fs_ || dir_) {
+        return 0;
+    }
+    size_t stored = length;
+    if (fs_->fail_writes > 0) {
+        fs_->fail_writes--;
+        stored = fs_->keep_bytes < length ? fs_->keep_bytes : length;
+    }
+    std::vector<uint8_t>& file = bytes();
+    file.insert(file.begin() + pos_, data, data + stored);
+    pos_ += stored;
+    return stored;
+}
+
+inline size_t File::read(uint8_t* data, size_t length) {
+    if (!fs_ || dir_) {
+        return 0;
+    }
+    std::vector<uint8_t>& file = bytes();
+    size_t count = pos_ + length <= file.size() ? length : file.size() - pos_;
+    memcpy(data, file.data() + pos_, count);
+    pos_ += count;
+    return count;
+}
+
+inline File File::openNextFile() {
+    File file;
+    if (!fs_ || !dir_ || next_ >= fs_->files.size()) {
+        return file;
+    }
+    auto it = fs_->files.begin();
+    std::advance(it, next_++);
+    file.fs_ = fs_;
+    file.name_ = it->first;
+    return file;
+}
+
+#endif // NATIVE_SPIFFS_H
@@ -0,0 +1,47 @@
+#ifndef CODEC_ROUND_TRIP_H
+#define CODEC_ROUND_TRIP_H
+
+// Column round trip shared by the codec suites: every codec (codecs.h) must
+// decode exactly what it encoded, end the reader where the writer stopped,
+// and report the same size from a size-only trial. Owns the test buffers:
+// include once per binary, after unity.h.
+
+#include <cstdio>
+#include <cstring>
+#include "codecs.h"
+
+#define ROUND_TRIP_MAX_VALUES 3000  // samples x stride of the input block
+
+static uint16_t input[ROUND_TRIP_MAX_VALUES];
+static uint16_t decoded[ROUND_TRIP_MAX_VALUES];
+static uint8_t encoded[ROUND_TRIP_MAX_VALUES * 2 + 64];
+
+// Encode and decode input[0], input[stride], ... (count values) with a codec;
+// returns the encoded size
+static size_t check_round_trip(uint8_t codec, size_t stride, size_t count) {
+    char message[96];
+    snprintf(message, sizeof(message), "%s, %u samples, stride %u", column_codec_name(codec), (unsigned)count,
+             (unsigned)stride);
+
+    bit_writer_t writer;
+    bit_writer_init(&writer, encoded, sizeof(encoded));
+    size_t length = column_encode(codec, input, stride, count, &writer);
+    TEST_ASSERT_FALSE_MESSAGE(writer.overflow, message);
+    TEST_ASSERT_EQUAL_MESSAGE(bit_writer_bytes(&writer), length, message);
+
+    bit_writer_t counter;
+    bit_writer_init(&counter, nullptr, 0);
+    TEST_ASSERT_EQUAL_MESSAGE(length, column_encode(codec, input, stride, count, &counter), message);
+
+    memset(decoded, 0xA5, sizeof(decoded));
+    bit_reader_t reader;
+    bit_reader_init(&reader, encoded, length);
+    TEST_ASSERT_TRUE_MESSAGE(column_decode(codec, &reader, decoded, stride, count), message);
+    TEST_ASSERT_EQUAL_MESSAGE(length, bit_reader_bytes(&reader), message);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(input[i * stride], decoded[i * stride], message);
+    }
+    return length;
+}
+
+#endif // CODEC_ROUND_TRIP_H
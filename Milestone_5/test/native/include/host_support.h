@@ -0,0 +1,35 @@
+#ifndef HOST_SUPPORT_H
+#define HOST_SUPPORT_H
+
+// Firmware globals the portable libraries link against, for host test suites
+// and tools. Include from exactly one source file of each binary.
+// The register tables mirror the definitions in scheduler.cpp.
+
+#include <Arduino.h>
+#include "config.h"
+#include "error_handler.h"
+#include "frame_format.h"
+
+NativeSerial Serial;
+
+static error_code_t host_last_error = ERROR_NONE;
+static int host_error_count = 0;
+
+void log_error(error_code_t error_code, const char* message) {
+    (void)message;
+    host_last_error = error_code;
+    host_error_count++;
+}
+
+const PROGMEM float REGISTER_GAINS[MAX_REGISTERS] = {10.0, 10.0, 100.0, 10.0, 10.0, 10.0, 10.0, 10.0, 1.0, 1.0};
+const PROGMEM char* REGISTER_UNITS[MAX_REGISTERS] = {"V", "A", "Hz", "V", "V", "A", "A", "C", "%", "W"};
+const PROGMEM uint16_t READ_REGISTERS[READ_REGISTER_COUNT] = {0x0000, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x0007, 0x0008, 0x0009};
+const PROGMEM uint8_t REGISTER_COLUMN_CODECS[READ_REGISTER_COUNT] = {
+    COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY,
+    COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY, COLUMN_CODEC_ANY
+};
+const PROGMEM uint8_t REGISTER_QUANT_IMPORTANCE[READ_REGISTER_COUNT] = {4, 4, 5, 2, 2, 2, 2, 0, 9, 6};
+const PROGMEM uint8_t REGISTER_MAX_QUANT_SHIFT[READ_REGISTER_COUNT] = {4, 4, 3, 5, 5, 4, 4, 4, 0, 4};
+const PROGMEM uint16_t REGISTER_ACTIVITY_THRESHOLD[READ_REGISTER_COUNT] = {50, 10, 10, 50, 50, 10, 10, 0, 1, 200};
+
+#endif // HOST_SUPPORT_H
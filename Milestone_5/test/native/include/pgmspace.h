@@ -0,0 +1,7 @@
+#ifndef NATIVE_PGMSPACE_H
+#define NATIVE_PGMSPACE_H
+
+// PROGMEM is ordinary memory on the host (see Arduino.h)
+#include "Arduino.h"
+
+#endif // NATIVE_PGMSPACE_H
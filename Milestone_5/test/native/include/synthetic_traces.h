@@ -0,0 +1,77 @@
+#ifndef SYNTHETIC_TRACES_H
+#define SYNTHETIC_TRACES_H
+
+// Deterministic register traces for the host tests and tools/codec_bench.
+// Header-only so every binary gets the same series from the same seed.
+
+#include <cstdint>
+#include <cstddef>
+
+typedef struct {
+    uint32_t state;
+} trace_rng_t;
+
+inline void trace_seed(trace_rng_t* rng, uint32_t seed) {
+    rng->state = seed ? seed : 1;
+}
+
+// xorshift32
+inline uint32_t trace_next(trace_rng_t* rng) {
+    uint32_t x = rng->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng->state = x;
+    return x;
+}
+
+// Uniform in [-spread, spread]
+inline int32_t trace_jitter(trace_rng_t* rng, int32_t spread) {
+    return spread > 0 ? (int32_t)(trace_next(rng) % (uint32_t)(2 * spread + 1)) - spread : 0;
+}
+
+// start, start + step, ... modulo 2^16 (energy counters wrap)
+inline void trace_ramp(uint16_t* out, size_t stride, size_t count, uint16_t start, int32_t step) {
+    for (size_t i = 0; i < count; i++) {
+        out[i * stride] = (uint16_t)(start + (int32_t)i * step);
+    }
+}
+
+// Random walk of +/-spread per sample, clamped to [low, high]
+inline void trace_walk(trace_rng_t* rng, uint16_t* out, size_t stride, size_t count, int32_t start, int32_t spread,
+                       int32_t low, int32_t high) {
+    int32_t value = start;
+    for (size_t i = 0; i < count; i++) {
+        value += trace_jitter(rng, spread);
+        value = value < low ? low : (value > high ? high : value);
+        out[i * stride] = (uint16_t)value;
+    }
+}
+
+// Independent uniform values
+inline void trace_noise(trace_rng_t* rng, uint16_t* out, size_t stride, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i * stride] = (uint16_t)trace_next(rng);
+    }
+}
+
+// Ten inverter registers (Vac1, Iac1, Fac, Vpv1, Vpv2, Ipv1, Ipv2, Temp, Export %, Pac)
+// at the REGISTER_GAINS scales, row-major: rows[sample * 10 + reg]. Pac follows Vac1 * Iac1.
+inline void trace_inverter(trace_rng_t* rng, uint16_t* rows, size_t count) {
+    const size_t regs = 10;
+    trace_walk(rng, rows + 0, regs, count, 2300, 15, 2000, 2600);
+    trace_walk(rng, rows + 1, regs, count, 50, 4, 0, 400);
+    trace_walk(rng, rows + 2, regs, count, 5000, 3, 4900, 5100);
+    trace_walk(rng, rows + 3, regs, count, 3000, 20, 0, 4500);
+    trace_walk(rng, rows + 4, regs, count, 2950, 20, 0, 4500);
+    trace_walk(rng, rows + 5, regs, count, 60, 4, 0, 300);
+    trace_walk(rng, rows + 6, regs, count, 58, 4, 0, 300);
+    trace_walk(rng, rows + 7, regs, count, 450, 1, 200, 900);
+    for (size_t i = 0; i < count; i++) {
+        rows[i * regs + 8] = 50;
+        uint32_t pac = (uint32_t)rows[i * regs + 0] * rows[i * regs + 1] / 100;
+        rows[i * regs + 9] = (uint16_t)(pac + trace_jitter(rng, 3));
+    }
+}
+
+#endif // SYNTHETIC_TRACES_H
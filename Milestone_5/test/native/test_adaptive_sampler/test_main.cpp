@@ -0,0 +1,141 @@
+// Activity-driven read interval (adaptive_sampler.h): full activity drops to
+// the floor, runs of quiet samples double the interval up to the ceiling,
+// the hold band in between resets the quiet streak, and the batch figures
+// are encoded as the FRAME_TLV_SAMPLING record.
+
+#include <unity.h>
+#include <cstring>
+#include "adaptive_sampler.h"
+
+#define FLOOR_MS 1000
+#define CEILING_MS 20000
+#define BASE_MS 5000
+#define QUIET_PCT 20
+#define QUIET_SAMPLES 3
+
+// Register 0: 100 counts per second is 100 % activity; register 1 is ignored
+static const uint16_t THRESHOLDS[2] = {100, 0};
+
+static adaptive_sampler_t sampler;
+static uint16_t values[2];
+static uint32_t now_ms;
+
+void setUp(void) {
+    adaptive_init(&sampler, FLOOR_MS, CEILING_MS, QUIET_PCT, QUIET_SAMPLES, THRESHOLDS, 2);
+    adaptive_configure(&sampler, BASE_MS);
+    values[0] = 1000;
+    values[1] = 0;
+    now_ms = 0;
+    adaptive_update(&sampler, values, now_ms);
+}
+
+void tearDown(void) {}
+
+// Next sample `gap_ms` later with register 0 moved by `change` counts; returns the next interval
+static uint32_t sample(int32_t change, uint32_t gap_ms) {
+    values[0] = (uint16_t)(values[0] + change);
+    now_ms += gap_ms;
+    return adaptive_update(&sampler, values, now_ms);
+}
+
+static void test_full_activity_jumps_to_floor(void) {
+    // The first sample has nothing to compare with
+    TEST_ASSERT_EQUAL_UINT32(BASE_MS, sampler.interval_ms);
+
+    // 495 counts in 5 s is 99 %: held
+    const uint16_t next[2] = {(uint16_t)(values[0] + 495), values[1]};
+    TEST_ASSERT_EQUAL_UINT32(99, adaptive_activity(&sampler, next, BASE_MS));
+    TEST_ASSERT_EQUAL_UINT32(BASE_MS, sample(495, BASE_MS));
+
+    // 500 counts in 5 s is 100 %, falling as fast as rising
+    TEST_ASSERT_EQUAL_UINT32(FLOOR_MS, sample(-500, BASE_MS));
+
+    // A register without a threshold never counts
+    adaptive_configure(&sampler, BASE_MS + 1);
+    values[1] = 60000;
+    TEST_ASSERT_EQUAL_UINT32(BASE_MS + 1, sample(0, BASE_MS));
+}
+
+static void test_quiet_samples_double_up_to_ceiling(void) {
+    static const uint32_t EXPECTED[] = {BASE_MS, BASE_MS, 2 * BASE_MS, 2 * BASE_MS, 2 * BASE_MS,
+                                        CEILING_MS, CEILING_MS, CEILING_MS, CEILING_MS};
+    for (size_t i = 0; i < sizeof(EXPECTED) / sizeof(EXPECTED[0]); i++) {
+        // 19 %: still quiet
+        TEST_ASSERT_EQUAL_UINT32(EXPECTED[i], sample(i % 2 ? 19 : -19, 1000));
+    }
+
+    // Doubling past the ceiling clamps to it rather than overshooting
+    adaptive_configure(&sampler, 12000);
+    for (size_t i = 0; i < QUIET_SAMPLES; i++) {
+        sample(0, 12000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(CEILING_MS, sampler.interval_ms);
+
+    // Activity brings it straight back down
+    TEST_ASSERT_EQUAL_UINT32(FLOOR_MS, sample(100, 1000));
+}
+
+static void test_hold_band_resets_quiet_streak(void) {
+    sample(0, BASE_MS);
+    sample(0, BASE_MS);
+    TEST_ASSERT_EQUAL(2, sampler.quiet_streak);
+
+    // 20 % is not quiet but below full activity: interval held, streak lost
+    TEST_ASSERT_EQUAL_UINT32(BASE_MS, sample(100, BASE_MS));
+    TEST_ASSERT_EQUAL(0, sampler.quiet_streak);
+
+    TEST_ASSERT_EQUAL_UINT32(BASE_MS, sample(0, BASE_MS));
+    TEST_ASSERT_EQUAL_UINT32(BASE_MS, sample(0, BASE_MS));
+    TEST_ASSERT_EQUAL_UINT32(2 * BASE_MS, sample(0, BASE_MS));
+
+    // A full-activity sample resets it too
+    sample(0, BASE_MS);
+    sample(0, BASE_MS);
+    TEST_ASSERT_EQUAL_UINT32(FLOOR_MS, sample(1000, BASE_MS));
+    TEST_ASSERT_EQUAL(0, sampler.quiet_streak);
+}
+
+static void test_encode_batch(void) {
+    uint8_t out[32];
+
+    // No gaps yet: everything but the interval is zero
+    adaptive_begin_batch(&sampler);
+    static const uint8_t EMPTY[] = {0x88, 0x27, 0, 0, 0, 0};  // 5000 ms
+    TEST_ASSERT_EQUAL(sizeof(EMPTY), adaptive_encode_batch(&sampler, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(EMPTY, out, sizeof(EMPTY));
+
+    // Gaps of 1, 3 and 2 s with one interval change (to the floor)
+    sample(100, 1000);
+    sample(0, 3000);
+    sample(0, 2000);
+    static const uint8_t EXPECTED[] = {
+        0xE8, 0x07,  // interval 1000 ms
+        0xD0, 0x0F,  // mean gap 2000 ms
+        0xE8, 0x07,  // min gap 1000 ms
+        0xB8, 0x17,  // max gap 3000 ms
+        0x01,        // one change
+    };
+    size_t length = adaptive_encode_batch(&sampler, out, sizeof(out));
+    TEST_ASSERT_EQUAL(sizeof(EXPECTED), length);
+    TEST_ASSERT_EQUAL_MEMORY(EXPECTED, out, sizeof(EXPECTED));
+
+    for (size_t capacity = 0; capacity < length; capacity++) {
+        TEST_ASSERT_EQUAL(0, adaptive_encode_batch(&sampler, out, capacity));
+    }
+
+    // A new batch starts over; its first sample is the third quiet one in a row
+    adaptive_begin_batch(&sampler);
+    sample(0, 1500);
+    static const uint8_t NEXT[] = {0xD0, 0x0F, 0xDC, 0x0B, 0xDC, 0x0B, 0xDC, 0x0B, 0x01};  // 2000 ms, 1500 ms gap
+    TEST_ASSERT_EQUAL(sizeof(NEXT), adaptive_encode_batch(&sampler, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(NEXT, out, sizeof(NEXT));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_activity_jumps_to_floor);
+    RUN_TEST(test_quiet_samples_double_up_to_ceiling);
+    RUN_TEST(test_hold_band_resets_quiet_streak);
+    RUN_TEST(test_encode_batch);
+    return UNITY_END();
+}
@@ -0,0 +1,116 @@
+// Threshold alarm rules (alarm_rules.h): rising and falling edges fire once
+// per excursion, re-arm only at threshold -/+ hysteresis, and fired rules are
+// encoded as FRAME_TLV_ALARM entries within the given capacity.
+
+#include <unity.h>
+#include <cstdio>
+#include "alarm_rules.h"
+
+#define RULES 3
+
+static const alarm_rule_t rules[RULES] = {
+    {0, ALARM_EDGE_RISING, 1000, 50},
+    {1, ALARM_EDGE_FALLING, 200, 20},
+    {5, ALARM_EDGE_RISING, 10, 0},  // Register beyond the sample: never evaluated
+};
+
+static alarm_state_t state;
+static uint16_t values[2];
+
+void setUp(void) {
+    alarm_init(&state);
+    values[0] = 900;
+    values[1] = 300;
+}
+
+void tearDown(void) {}
+
+static uint32_t evaluate(void) {
+    return alarm_evaluate(&state, rules, RULES, values, 2);
+}
+
+// Feed `count` values to one register; fires[i] says whether rule `rule` fires on sample i
+static void feed(size_t reg, size_t rule, const uint16_t* series, const bool* fires, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        values[reg] = series[i];
+        char message[48];
+        snprintf(message, sizeof(message), "sample %u = %u", (unsigned)i, (unsigned)series[i]);
+        TEST_ASSERT_EQUAL_MESSAGE(fires[i] ? (1u << rule) : 0u, evaluate(), message);
+    }
+}
+
+static void test_rising_edge(void) {
+    static const uint16_t SERIES[] = {900, 999, 1000, 1200, 1000, 951, 950, 999, 1000, 65535};
+    static const bool FIRES[] = {false, false, true, false, false, false, false, false, true, false};
+    feed(0, 0, SERIES, FIRES, sizeof(SERIES) / sizeof(SERIES[0]));
+    TEST_ASSERT_EQUAL_UINT32(2, state.fired);
+    TEST_ASSERT_EQUAL_UINT32(1u << 0, state.active);
+}
+
+static void test_falling_edge(void) {
+    static const uint16_t SERIES[] = {300, 201, 200, 0, 200, 219, 220, 201, 200, 150};
+    static const bool FIRES[] = {false, false, true, false, false, false, false, false, true, false};
+    feed(1, 1, SERIES, FIRES, sizeof(SERIES) / sizeof(SERIES[0]));
+    TEST_ASSERT_EQUAL_UINT32(2, state.fired);
+    TEST_ASSERT_EQUAL_UINT32(1u << 1, state.active);
+}
+
+// Noise around the threshold inside the hysteresis band fires once, however long it lasts
+static void test_single_firing_per_excursion(void) {
+    uint32_t fired = 0;
+    for (uint32_t i = 0; i < 500; i++) {
+        values[0] = (uint16_t)(1000 + (i * 37) % 99 - 49);  // 951 ... 1049
+        if (evaluate() & 1u) {
+            fired++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, fired);
+    TEST_ASSERT_EQUAL_UINT32(1, state.fired);
+
+    // Both edges on the same sample fire together
+    alarm_init(&state);
+    values[0] = 1000;
+    values[1] = 200;
+    TEST_ASSERT_EQUAL_UINT32(0x3, evaluate());
+    TEST_ASSERT_EQUAL_UINT32(0, evaluate());
+    TEST_ASSERT_EQUAL_UINT32(2, state.fired);
+}
+
+static void test_encode_capacity(void) {
+    uint8_t out[ALARM_MAX_RULES * ALARM_ENTRY_SIZE];
+    static const uint8_t EXPECTED[] = {
+        0, 0, ALARM_EDGE_RISING, 0xE8, 0x03,   // rule 0: register 0 >= 1000
+        1, 1, ALARM_EDGE_FALLING, 0xC8, 0x00,  // rule 1: register 1 <= 200
+    };
+    TEST_ASSERT_EQUAL(sizeof(EXPECTED), alarm_encode(rules, RULES, 0x3, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(EXPECTED, out, sizeof(EXPECTED));
+
+    // Exactly one entry of room per fired rule, or nothing
+    TEST_ASSERT_EQUAL(ALARM_ENTRY_SIZE, alarm_encode(rules, RULES, 0x2, out, ALARM_ENTRY_SIZE));
+    TEST_ASSERT_EQUAL_MEMORY(EXPECTED + ALARM_ENTRY_SIZE, out, ALARM_ENTRY_SIZE);
+    for (size_t capacity = 0; capacity < sizeof(EXPECTED); capacity++) {
+        TEST_ASSERT_EQUAL(0, alarm_encode(rules, RULES, 0x3, out, capacity));
+    }
+
+    // Bits beyond the rule count are not encoded
+    TEST_ASSERT_EQUAL(0, alarm_encode(rules, RULES, 0x8, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(0, alarm_encode(rules, RULES, 0, out, 0));
+
+    // Every rule firing fills ALARM_MAX_RULES entries
+    alarm_rule_t many[ALARM_MAX_RULES];
+    for (size_t i = 0; i < ALARM_MAX_RULES; i++) {
+        many[i] = rules[i % 2];
+    }
+    TEST_ASSERT_EQUAL(sizeof(out), alarm_encode(many, ALARM_MAX_RULES, UINT32_MAX, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_UINT8(ALARM_MAX_RULES - 1, out[sizeof(out) - ALARM_ENTRY_SIZE]);
+    TEST_ASSERT_EQUAL(0, alarm_encode(many, ALARM_MAX_RULES, UINT32_MAX, out, sizeof(out) - 1));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rising_edge);
+    RUN_TEST(test_falling_edge);
+    RUN_TEST(test_single_firing_per_excursion);
+    RUN_TEST(test_encode_capacity);
+    return UNITY_END();
+}
@@ -0,0 +1,139 @@
+// Round trip of every column codec (codecs.h) over synthetic series.
+// Lossless codecs must reproduce the input exactly; the swinging door is
+// exact at tolerance 0. Size-only trials must match the real encoding.
+
+#include <unity.h>
+#include "codec_round_trip.h"
+#include "synthetic_traces.h"
+
+#define MAX_SAMPLES 300
+#define STRIDE 10
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Every codec over one series at several lengths (block boundaries of the bit-packed codecs)
+static void check_all_codecs(size_t stride) {
+    static const size_t LENGTHS[] = {1, 2, 3, 15, 16, 17, 31, 33, 100, MAX_SAMPLES};
+    for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+        TEST_ASSERT_NOT_NULL(column_codec_get(codec));
+        for (size_t i = 0; i < sizeof(LENGTHS) / sizeof(LENGTHS[0]); i++) {
+            check_round_trip(codec, stride, LENGTHS[i]);
+        }
+    }
+}
+
+static void test_registry_covers_every_id(void) {
+    for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+        const column_codec_t* entry = column_codec_get(codec);
+        TEST_ASSERT_NOT_NULL(entry);
+        TEST_ASSERT_EQUAL(codec, entry->id);
+    }
+    TEST_ASSERT_NULL(column_codec_get(COLUMN_CODEC_COUNT));
+    TEST_ASSERT_NULL(column_codec_get(COLUMN_CODEC_ANY));
+}
+
+static void test_constant(void) {
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        input[i] = 1234;
+    }
+    check_all_codecs(1);
+}
+
+static void test_ramps(void) {
+    static const int32_t STEPS[] = {1, 7, -3, 300};
+    for (size_t s = 0; s < sizeof(STEPS) / sizeof(STEPS[0]); s++) {
+        trace_ramp(input, 1, MAX_SAMPLES, 65400, STEPS[s]);  // Wraps through 0
+        check_all_codecs(1);
+    }
+}
+
+static void test_random_walks(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 7);
+    static const int32_t SPREADS[] = {1, 20, 600};
+    for (size_t s = 0; s < sizeof(SPREADS) / sizeof(SPREADS[0]); s++) {
+        trace_walk(&rng, input, 1, MAX_SAMPLES, 30000, SPREADS[s], 0, 65535);
+        check_all_codecs(1);
+    }
+}
+
+static void test_full_range_noise(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 11);
+    trace_noise(&rng, input, 1, MAX_SAMPLES);
+    check_all_codecs(1);
+}
+
+static void test_extremes(void) {
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        input[i] = (i % 3 == 0) ? 0 : ((i % 3 == 1) ? 65535 : 32768);
+    }
+    check_all_codecs(1);
+}
+
+// Columns read from a row-major block, as the predictor and aggregation rows are
+static void test_strided_columns(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 3);
+    trace_inverter(&rng, input, MAX_SAMPLES);
+    for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+        for (size_t reg = 0; reg < STRIDE; reg++) {
+            bit_writer_t writer;
+            bit_writer_init(&writer, encoded, sizeof(encoded));
+            size_t length = column_encode(codec, input + reg, STRIDE, MAX_SAMPLES, &writer);
+            bit_reader_t reader;
+            bit_reader_init(&reader, encoded, length);
+            TEST_ASSERT_TRUE(column_decode(codec, &reader, decoded + reg, STRIDE, MAX_SAMPLES));
+        }
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(input, decoded, MAX_SAMPLES * STRIDE);
+    }
+}
+
+// Columns written back to back decode in sequence from one reader
+static void test_consecutive_columns(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 5);
+    trace_walk(&rng, input, 1, 50, 100, 9, 0, 65535);
+    bit_writer_t writer;
+    bit_writer_init(&writer, encoded, sizeof(encoded));
+    for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+        column_encode(codec, input, 1, 50, &writer);
+    }
+    bit_reader_t reader;
+    bit_reader_init(&reader, encoded, bit_writer_bytes(&writer));
+    for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+        TEST_ASSERT_TRUE(column_decode(codec, &reader, decoded, 1, 50));
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(input, decoded, 50);
+    }
+    TEST_ASSERT_EQUAL(bit_writer_bytes(&writer), bit_reader_bytes(&reader));
+}
+
+static void test_truncated_input_is_rejected(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 9);
+    trace_walk(&rng, input, 1, 100, 2000, 50, 0, 65535);
+    for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+        bit_writer_t writer;
+        bit_writer_init(&writer, encoded, sizeof(encoded));
+        size_t length = column_encode(codec, input, 1, 100, &writer);
+        bit_reader_t reader;
+        bit_reader_init(&reader, encoded, length / 2);
+        TEST_ASSERT_FALSE_MESSAGE(column_decode(codec, &reader, decoded, 1, 100), column_codec_name(codec));
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_registry_covers_every_id);
+    RUN_TEST(test_constant);
+    RUN_TEST(test_ramps);
+    RUN_TEST(test_random_walks);
+    RUN_TEST(test_full_range_noise);
+    RUN_TEST(test_extremes);
+    RUN_TEST(test_strided_columns);
+    RUN_TEST(test_consecutive_columns);
+    RUN_TEST(test_truncated_input_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,263 @@
+// Deadline scheduler (lib/deadline_queue) on a virtual millis() clock: the
+// harness below plays the scheduler loop (sleep until the earliest deadline,
+// run every due task, each taking some time), so ordering, drift, overrun
+// skipping and the 2^32 ms wrap are checked without waiting in real time.
+
+#include <unity.h>
+#include "deadline_queue.h"
+
+#define MAX_RUNS 4000
+
+typedef struct {
+    int id;
+    uint32_t start;   // Virtual time the task started
+    deadline_slot_t slot;
+} run_t;
+
+static deadline_queue_t queue;
+static uint32_t now;                               // Virtual millis()
+static uint32_t run_cost[DEADLINE_MAX_ENTRIES];    // ms each task keeps the loop busy
+static run_t runs[MAX_RUNS];
+static size_t run_count;
+
+void setUp(void) {
+    deadline_init(&queue);
+    now = 0;
+    run_count = 0;
+    for (size_t i = 0; i < DEADLINE_MAX_ENTRIES; i++) {
+        run_cost[i] = 0;
+    }
+}
+
+void tearDown(void) {}
+
+// Scheduler loop for `duration` virtual ms: run due tasks, otherwise sleep until the next one
+static void run_for(uint32_t duration) {
+    uint32_t end = now + duration;
+    while ((int32_t)(end - now) > 0) {
+        deadline_slot_t slot;
+        int id = deadline_pop_due(&queue, now, &slot);
+        if (id < 0) {
+            uint32_t wait = deadline_wait_ms(&queue, now);
+            TEST_ASSERT_GREATER_THAN(0, wait);
+            uint32_t left = end - now;
+            now += wait < left ? wait : left;
+            continue;
+        }
+        TEST_ASSERT_LESS_THAN(MAX_RUNS, run_count);
+        runs[run_count].id = id;
+        runs[run_count].start = now;
+        runs[run_count].slot = slot;
+        run_count++;
+        now += run_cost[id];
+    }
+}
+
+static size_t runs_of(int id) {
+    size_t count = 0;
+    for (size_t i = 0; i < run_count; i++) {
+        count += runs[i].id == id;
+    }
+    return count;
+}
+
+// Every slot of id is on its nominal grid base + k * period, none is run before
+// it is due, and consecutive slots are one period apart plus the skipped ones
+static void check_grid(int id, uint32_t base, uint32_t period) {
+    const run_t* last = nullptr;
+    for (size_t i = 0; i < run_count; i++) {
+        if (runs[i].id != id) {
+            continue;
+        }
+        uint32_t due = runs[i].slot.due_ms;
+        TEST_ASSERT_EQUAL(0, (uint32_t)(due - base) % period);
+        TEST_ASSERT_TRUE((int32_t)(runs[i].start - due) >= 0);
+        if (last) {
+            TEST_ASSERT_EQUAL((last->slot.missed + 1) * period, (uint32_t)(due - last->slot.due_ms));
+        }
+        last = &runs[i];
+    }
+}
+
+static void test_earliest_first(void) {
+    deadline_start(&queue, 0, 300, 300);
+    deadline_start(&queue, 1, 100, 100);
+    deadline_start(&queue, 2, 200, 200);
+    run_for(601);
+
+    TEST_ASSERT_EQUAL(6, runs_of(1));
+    TEST_ASSERT_EQUAL(3, runs_of(2));
+    TEST_ASSERT_EQUAL(2, runs_of(0));
+    for (size_t i = 0; i < run_count; i++) {
+        TEST_ASSERT_EQUAL(runs[i].slot.due_ms, runs[i].start);  // Zero-cost tasks are never late
+        if (i > 0) {
+            TEST_ASSERT_TRUE(runs[i - 1].slot.due_ms <= runs[i].slot.due_ms);
+        }
+    }
+    check_grid(0, 0, 300);
+    check_grid(1, 0, 100);
+    check_grid(2, 0, 200);
+}
+
+// Run time shifts the start of one slot but never the following ones
+static void test_no_drift(void) {
+    deadline_start(&queue, 0, 1000, 1000);
+    deadline_start(&queue, 1, 250, 250);
+    run_cost[0] = 170;
+    run_cost[1] = 40;
+    run_for(59900);
+
+    TEST_ASSERT_EQUAL(59, runs_of(0));
+    TEST_ASSERT_EQUAL(239, runs_of(1));
+    for (size_t i = 0; i < run_count; i++) {
+        TEST_ASSERT_EQUAL(0, runs[i].slot.missed);
+        TEST_ASSERT_LESS_OR_EQUAL(170, runs[i].start - runs[i].slot.due_ms);
+    }
+    check_grid(0, 0, 1000);
+    check_grid(1, 0, 250);
+}
+
+// A task that overruns its period skips the missed slots instead of running
+// back to back to catch up: one run per 350 ms busy period, not one per slot
+static void test_overrun_skips_slots(void) {
+    deadline_start(&queue, 0, 100, 100);
+    run_cost[0] = 350;
+    run_for(2000);
+
+    TEST_ASSERT_EQUAL(6, run_count);  // Starts at 100, 450, 800, 1150, 1500, 1850
+    uint32_t skipped = 0;
+    for (size_t i = 0; i < run_count; i++) {
+        TEST_ASSERT_EQUAL(100 + 350 * i, runs[i].start);
+        TEST_ASSERT_LESS_THAN(run_cost[0] + 100, runs[i].start - runs[i].slot.due_ms);
+        skipped += runs[i].slot.missed;
+    }
+    TEST_ASSERT_GREATER_THAN(0, skipped);
+    TEST_ASSERT_EQUAL(skipped, queue.entries[0].skipped);
+    check_grid(0, 0, 100);
+}
+
+// Same schedule across the millis() wrap as anywhere else
+static void test_millis_wrap(void) {
+    const uint32_t start = UINT32_MAX - 5000;
+    now = start;
+    deadline_start(&queue, 0, 1000, start + 1000);
+    deadline_start(&queue, 1, 300, start + 300);
+    run_cost[0] = 120;
+    run_cost[1] = 10;
+    run_for(12000);
+
+    TEST_ASSERT_EQUAL(11, runs_of(0));
+    TEST_ASSERT_EQUAL(39, runs_of(1));
+    bool wrapped = false;
+    for (size_t i = 0; i < run_count; i++) {
+        TEST_ASSERT_EQUAL(0, runs[i].slot.missed);
+        TEST_ASSERT_LESS_OR_EQUAL(120, runs[i].start - runs[i].slot.due_ms);
+        wrapped |= runs[i].start < start;
+    }
+    TEST_ASSERT_TRUE(wrapped);
+    check_grid(0, start, 1000);
+    check_grid(1, start, 300);
+
+    // Waiting across the wrap
+    deadline_init(&queue);
+    deadline_start(&queue, 0, 500, 200);
+    TEST_ASSERT_EQUAL(400, deadline_wait_ms(&queue, UINT32_MAX - 199));
+    TEST_ASSERT_EQUAL(-1, deadline_pop_due(&queue, UINT32_MAX - 199, nullptr));
+    TEST_ASSERT_EQUAL(0, deadline_pop_due(&queue, 200, nullptr));
+}
+
+// A resumed entry continues on its grid with its first slot at or after now
+static void test_pause_resume(void) {
+    deadline_start(&queue, 0, 100, 100);
+    deadline_start(&queue, 1, 1000, 1000);
+    run_for(350);
+    TEST_ASSERT_EQUAL(3, runs_of(0));
+
+    deadline_set_active(&queue, 0, false, now);
+    TEST_ASSERT_FALSE(deadline_is_active(&queue, 0));
+    run_for(1000);
+    TEST_ASSERT_EQUAL(3, runs_of(0));
+
+    deadline_set_active(&queue, 0, true, now);  // now = 1350
+    TEST_ASSERT_EQUAL(1400, queue.entries[0].next_due_ms);
+    run_for(300);
+    TEST_ASSERT_EQUAL(6, runs_of(0));
+    for (size_t i = 0; i < run_count; i++) {
+        TEST_ASSERT_EQUAL(runs[i].slot.due_ms, runs[i].start);
+        TEST_ASSERT_EQUAL(0, runs[i].slot.due_ms % 100);
+    }
+
+    // Never started: resuming does nothing
+    deadline_set_active(&queue, 5, true, now);
+    TEST_ASSERT_FALSE(deadline_is_active(&queue, 5));
+}
+
+// Shortening the period far into a long slot (the adaptive sampler speeding up)
+// starts the new grid at now: no phantom missed slots, no lateness
+static void test_set_period_never_in_the_past(void) {
+    static const uint32_t STARTS[] = {0, UINT32_MAX - 9500};  // Also across the millis() wrap
+    for (size_t s = 0; s < sizeof(STARTS) / sizeof(STARTS[0]); s++) {
+        setUp();
+        now = STARTS[s];
+        deadline_start(&queue, 0, 10000, now);
+        run_for(9000);  // Ran at STARTS[s]; next slot 10 s after it
+        TEST_ASSERT_EQUAL(1, run_count);
+
+        deadline_set_period(&queue, 0, 1000, now);
+        TEST_ASSERT_EQUAL(0, deadline_wait_ms(&queue, now));
+        run_for(5001);
+        TEST_ASSERT_EQUAL(7, run_count);  // now, then every second
+        for (size_t i = 1; i < run_count; i++) {
+            TEST_ASSERT_EQUAL(0, runs[i].slot.missed);
+            TEST_ASSERT_EQUAL(runs[i].slot.due_ms, runs[i].start);
+            TEST_ASSERT_EQUAL((uint32_t)(STARTS[s] + 9000 + 1000 * (i - 1)), runs[i].slot.due_ms);
+        }
+        TEST_ASSERT_EQUAL(0, queue.entries[0].skipped);
+    }
+}
+
+// A period change that still lands in the future keeps the last start as the phase
+static void test_set_period_keeps_phase(void) {
+    deadline_start(&queue, 0, 1000, 1000);
+    run_for(1200);  // Ran at 1000
+    deadline_set_period(&queue, 0, 5000, now);
+    TEST_ASSERT_EQUAL(6000, queue.entries[0].next_due_ms);
+    deadline_set_period(&queue, 0, 500, now);
+    TEST_ASSERT_EQUAL(1500, queue.entries[0].next_due_ms);
+    run_for(1000);
+    check_grid(0, 0, 500);
+    TEST_ASSERT_EQUAL(0, queue.entries[0].skipped);
+}
+
+// deadline_take runs one entry out of heap order, only when it is due
+static void test_take(void) {
+    deadline_start(&queue, 0, 100, 100);
+    deadline_start(&queue, 1, 100, 50);
+    deadline_slot_t slot;
+    TEST_ASSERT_FALSE(deadline_take(&queue, 0, 99, &slot));
+    TEST_ASSERT_TRUE(deadline_take(&queue, 0, 100, &slot));
+    TEST_ASSERT_EQUAL(100, slot.due_ms);
+    TEST_ASSERT_EQUAL(200, queue.entries[0].next_due_ms);
+    TEST_ASSERT_EQUAL(1, deadline_pop_due(&queue, 100, &slot));
+    TEST_ASSERT_EQUAL(50, slot.due_ms);
+    TEST_ASSERT_EQUAL(-1, deadline_pop_due(&queue, 100, &slot));
+    TEST_ASSERT_EQUAL(50, deadline_wait_ms(&queue, 100));
+
+    deadline_set_active(&queue, 0, false, 100);
+    TEST_ASSERT_FALSE(deadline_take(&queue, 0, 1000, &slot));
+    deadline_set_active(&queue, 1, false, 100);
+    TEST_ASSERT_EQUAL(DEADLINE_NONE, deadline_wait_ms(&queue, 100));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_earliest_first);
+    RUN_TEST(test_no_drift);
+    RUN_TEST(test_overrun_skips_slots);
+    RUN_TEST(test_millis_wrap);
+    RUN_TEST(test_pause_resume);
+    RUN_TEST(test_set_period_never_in_the_past);
+    RUN_TEST(test_set_period_keeps_phase);
+    RUN_TEST(test_take);
+    return UNITY_END();
+}
@@ -0,0 +1,74 @@
+// Delta-of-delta + RLE codec (COLUMN_CODEC_DOD_RLE) over synthetic counter
+// ramps: a constant step, also through 16-bit wraparound, collapses into
+// zero-run tokens of exact size. Generic round trips over every codec are in
+// test_codecs.
+
+#include <unity.h>
+#include "codec_round_trip.h"
+#include "synthetic_traces.h"
+
+#define MAX_SAMPLES 600
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static size_t round_trip(size_t count) {
+    return check_round_trip(COLUMN_CODEC_DOD_RLE, 1, count);
+}
+
+// First value (2) + the first delta as a residual token (3) + one 0x00 <run> token per 255 zeros
+static size_t ramp_size(size_t count) {
+    if (count == 1) {
+        return 2;
+    }
+    return 2 + 3 + 2 * ((count - 2 + 254) / 255);
+}
+
+static void test_ramps_collapse_into_runs(void) {
+    static const int32_t STEPS[] = {1, 2, 17, 250, 4096, -1, -300};
+    for (size_t s = 0; s < sizeof(STEPS) / sizeof(STEPS[0]); s++) {
+        trace_ramp(input, 1, 100, 1000, STEPS[s]);
+        TEST_ASSERT_EQUAL(ramp_size(100), round_trip(100));
+    }
+}
+
+static void test_ramp_wraps_through_zero(void) {
+    trace_ramp(input, 1, 100, 65500, 3);  // 65500 ... 65533, 0, 3, ...
+    TEST_ASSERT_EQUAL(ramp_size(100), round_trip(100));
+
+    trace_ramp(input, 1, 100, 40, -7);  // Down through 0 to 65535 - ...
+    TEST_ASSERT_EQUAL(ramp_size(100), round_trip(100));
+}
+
+static void test_long_runs_split_at_255(void) {
+    static const size_t LENGTHS[] = {2, 3, 256, 257, 258, 512, MAX_SAMPLES};
+    for (size_t i = 0; i < sizeof(LENGTHS) / sizeof(LENGTHS[0]); i++) {
+        trace_ramp(input, 1, LENGTHS[i], 65000, 5);
+        TEST_ASSERT_EQUAL(ramp_size(LENGTHS[i]), round_trip(LENGTHS[i]));
+    }
+}
+
+static void test_smaller_than_delta_rle_on_ramps(void) {
+    trace_ramp(input, 1, 100, 20000, 12);
+    size_t dod_rle = round_trip(100);
+    TEST_ASSERT_LESS_THAN(check_round_trip(COLUMN_CODEC_DELTA_RLE, 1, 100) / 10, dod_rle);
+}
+
+// Counter whose rate changes: each segment costs one residual token plus its run
+static void test_piecewise_ramp(void) {
+    trace_ramp(input, 1, 50, 60000, 40);
+    trace_ramp(input + 50, 1, 50, (uint16_t)(input[49] + 90), 90);
+    trace_ramp(input + 100, 1, 50, (uint16_t)(input[99]), 0);
+    TEST_ASSERT_EQUAL(2 + 3 * (3 + 2), round_trip(150));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ramps_collapse_into_runs);
+    RUN_TEST(test_ramp_wraps_through_zero);
+    RUN_TEST(test_long_runs_split_at_255);
+    RUN_TEST(test_smaller_than_delta_rle_on_ramps);
+    RUN_TEST(test_piecewise_ramp);
+    return UNITY_END();
+}
@@ -0,0 +1,357 @@
+// Whole upload frames: compressor.cpp / downsampler.cpp output decoded by
+// decompressor.cpp, for every method and frame flag (AGGREGATED, PREDICTED,
+// QUANTIZED, TRAILER), plus the CRC-checked upload frame and the TLV helpers.
+
+#include <unity.h>
+#include "host_support.h"
+#include "compressor.h"
+#include "decompressor.h"
+#include "downsampler.h"
+#include "stream_encoder.h"
+#include "calculateCRC.h"
+#include "varint.h"
+#include "synthetic_traces.h"
+
+#define SAMPLES 100
+#define FRAME_CAPACITY (MAX_COMPRESSION_SIZE + 2 + FRAME_TRAILER_MAX + 2)
+
+static uint16_t rows[SAMPLES * READ_REGISTER_COUNT];
+static uint16_t columns[SAMPLES * READ_REGISTER_COUNT];
+static sample_store_t store;
+static uint8_t payload[MAX_COMPRESSION_SIZE];
+static uint8_t frame[FRAME_CAPACITY];
+static uint16_t decoded[SAMPLES * READ_REGISTER_COUNT];
+
+static void load_trace(uint32_t seed) {
+    trace_rng_t rng;
+    trace_seed(&rng, seed);
+    trace_inverter(&rng, rows, SAMPLES);
+    for (size_t i = 0; i < SAMPLES; i++) {
+        sample_store_set_row(&store, i, rows + i * READ_REGISTER_COUNT);
+    }
+}
+
+// [flags][window if aggregated][payload], as build_buffer_frame() lays it out
+static size_t build_frame(const compression_metrics_t* metrics, size_t window) {
+    size_t prefix_len = window ? 2 : 1;
+    frame[0] = (uint8_t)(metrics->method_id << FRAME_METHOD_SHIFT);
+    if (window) {
+        frame[0] |= FRAME_FLAG_AGGREGATED;
+        frame[1] = (uint8_t)window;
+    }
+    if (metrics->predicted) {
+        frame[0] |= FRAME_FLAG_PREDICTED;
+    }
+    if (metrics->quantized) {
+        frame[0] |= FRAME_FLAG_QUANTIZED;
+    }
+    memcpy(frame + prefix_len, payload, metrics->compressed_payload_size);
+    return prefix_len + metrics->compressed_payload_size;
+}
+
+static void decode_frame(size_t frame_len, size_t expected_samples) {
+    size_t sample_count = 0;
+    uint8_t register_count = 0;
+    TEST_ASSERT_TRUE(decompress_frame(frame, frame_len, decoded, SAMPLES * READ_REGISTER_COUNT, &sample_count,
+                                      &register_count));
+    TEST_ASSERT_EQUAL(expected_samples, sample_count);
+    TEST_ASSERT_EQUAL(READ_REGISTER_COUNT, register_count);
+}
+
+void setUp(void) {
+    sample_store_attach(&store, columns, nullptr, SAMPLES, SAMPLES);
+    uint16_t lossless[READ_REGISTER_COUNT] = {0};
+    compression_set_tolerances(lossless);
+    memset(decoded, 0, sizeof(decoded));
+}
+
+void tearDown(void) {}
+
+static void test_fixed_methods(void) {
+    load_trace(1);
+    compression_metrics_t metrics = compress_raw(&store, SAMPLES, payload);
+    TEST_ASSERT_FALSE(metrics.predicted);
+    decode_frame(build_frame(&metrics, 0), SAMPLES);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(rows, decoded, SAMPLES * READ_REGISTER_COUNT);
+
+    metrics = compress_bitpack(&store, SAMPLES, payload, sizeof(payload));
+    decode_frame(build_frame(&metrics, 0), SAMPLES);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(rows, decoded, SAMPLES * READ_REGISTER_COUNT);
+}
+
+static void test_auto_predicted(void) {
+    load_trace(2);
+    compression_metrics_t metrics = compress_auto(&store, SAMPLES, payload, sizeof(payload));
+    TEST_ASSERT_TRUE(metrics.predicted);
+    size_t frame_len = build_frame(&metrics, 0);
+    TEST_ASSERT_TRUE(frame[0] & FRAME_FLAG_PREDICTED);
+    decode_frame(frame_len, SAMPLES);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(rows, decoded, SAMPLES * READ_REGISTER_COUNT);
+
+    // Without the flag the predicted register comes back as residuals
+    frame[0] &= ~FRAME_FLAG_PREDICTED;
+    decode_frame(frame_len, SAMPLES);
+    bool differs = false;
+    for (size_t i = 0; i < SAMPLES; i++) {
+        differs |= decoded[i * READ_REGISTER_COUNT + 9] != rows[i * READ_REGISTER_COUNT + 9];
+    }
+    TEST_ASSERT_TRUE(differs);
+}
+
+// Huffman's table is not versioned on the wire: AUTO trials it (reported in
+// codec_sizes) but never puts it in a frame, batch or streamed. Small random
+// walks are what the shipped table was trained on, where it wins the trials.
+static void test_auto_skips_huffman(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 31);
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        trace_walk(&rng, rows + reg, READ_REGISTER_COUNT, SAMPLES, 20000, 2, 0, 65535);
+    }
+    // Huffman is the smallest codec for some columns, so AUTO would pick it
+    size_t huffman_wins = 0;
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        size_t sizes[COLUMN_CODEC_COUNT];
+        for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+            bit_writer_t counter;
+            bit_writer_init(&counter, nullptr, 0);
+            sizes[codec] = column_encode(codec, rows + reg, READ_REGISTER_COUNT, SAMPLES, &counter);
+        }
+        bool smallest = true;
+        for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+            smallest &= codec == COLUMN_CODEC_HUFFMAN || sizes[COLUMN_CODEC_HUFFMAN] < sizes[codec];
+        }
+        huffman_wins += smallest;
+    }
+    TEST_ASSERT_GREATER_THAN(0, huffman_wins);
+    for (size_t i = 0; i < SAMPLES; i++) {
+        sample_store_set_row(&store, i, rows + i * READ_REGISTER_COUNT);
+    }
+
+    compression_metrics_t metrics = compress_auto(&store, SAMPLES, payload, sizeof(payload));
+    TEST_ASSERT_GREATER_THAN(0, metrics.codec_sizes[COLUMN_CODEC_HUFFMAN]);
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        TEST_ASSERT_TRUE(metrics.column_codecs[reg] != COLUMN_CODEC_HUFFMAN);
+    }
+    decode_frame(build_frame(&metrics, 0), SAMPLES);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(rows, decoded, SAMPLES * READ_REGISTER_COUNT);
+
+    // The stream encoder picks its codecs from the previous batch's trials
+    static stream_encoder_t encoder;
+    stream_encoder_init(&encoder, COMPRESSION_METHOD_AUTO);
+    for (int batch = 0; batch < 2; batch++) {
+        for (size_t i = 0; i < SAMPLES; i++) {
+            stream_encoder_push(&encoder, rows + i * READ_REGISTER_COUNT);
+        }
+        metrics = stream_encoder_finish(&encoder, payload, sizeof(payload));
+        stream_encoder_reset(&encoder);
+    }
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        TEST_ASSERT_TRUE(metrics.column_codecs[reg] != COLUMN_CODEC_HUFFMAN);
+    }
+}
+
+static void test_every_length(void) {
+    load_trace(3);
+    for (size_t count = 1; count <= SAMPLES; count++) {
+        compression_metrics_t metrics = compress_auto(&store, count, payload, sizeof(payload));
+        decode_frame(build_frame(&metrics, 0), count);
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(rows, decoded, count * READ_REGISTER_COUNT);
+    }
+}
+
+static void test_bounded_quantized(void) {
+    load_trace(4);
+    compression_metrics_t full = compress_auto(&store, SAMPLES, payload, sizeof(payload));
+    size_t budget = full.compressed_payload_size * 2 / 3;
+
+    compression_metrics_t metrics = compress_bounded(&store, SAMPLES, payload, sizeof(payload), budget);
+    TEST_ASSERT_TRUE(metrics.quantized);
+    TEST_ASSERT_FALSE(metrics.predicted);
+    TEST_ASSERT_LESS_OR_EQUAL(budget, metrics.compressed_payload_size);
+
+    size_t frame_len = build_frame(&metrics, 0);
+    TEST_ASSERT_TRUE(frame[0] & FRAME_FLAG_QUANTIZED);
+    decode_frame(frame_len, SAMPLES);
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        TEST_ASSERT_LESS_OR_EQUAL(pgm_read_byte(&REGISTER_MAX_QUANT_SHIFT[reg]), metrics.quant_shifts[reg]);
+        int32_t half_step = (1 << metrics.quant_shifts[reg]) / 2;
+        for (size_t i = 0; i < SAMPLES; i++) {
+            int32_t error = (int32_t)decoded[i * READ_REGISTER_COUNT + reg] - rows[i * READ_REGISTER_COUNT + reg];
+            TEST_ASSERT_LESS_OR_EQUAL(half_step, error < 0 ? -error : error);
+        }
+    }
+}
+
+static void test_aggregated(void) {
+    load_trace(5);
+    const size_t window = 7;
+    static uint16_t aggregated_columns[READ_REGISTER_COUNT * AGG_STAT_COUNT * SAMPLES];
+    sample_store_t aggregated = {nullptr, 0, false, nullptr, 0};
+    sample_store_attach(&aggregated, aggregated_columns, nullptr, AGG_STAT_COUNT * SAMPLES, AGG_STAT_COUNT * SAMPLES);
+
+    size_t windows = downsample_window_count(SAMPLES, window);
+    size_t aggregated_rows = downsample_min_max_mean_last(&store, SAMPLES, window, &aggregated);
+    TEST_ASSERT_EQUAL(AGG_STAT_COUNT * windows, aggregated_rows);
+
+    compression_metrics_t metrics = compress_auto(&aggregated, aggregated_rows, payload, sizeof(payload));
+    size_t frame_len = build_frame(&metrics, window);
+    TEST_ASSERT_EQUAL(window, frame_aggregation_window(frame, frame_len));
+    decode_frame(frame_len, aggregated_rows);
+
+    for (size_t w = 0; w < windows; w++) {
+        size_t first = w * window;
+        size_t last = first + window < SAMPLES ? first + window : SAMPLES;
+        for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+            uint16_t low = UINT16_MAX, high = 0;
+            uint32_t sum = 0;
+            for (size_t i = first; i < last; i++) {
+                uint16_t value = rows[i * READ_REGISTER_COUNT + reg];
+                low = value < low ? value : low;
+                high = value > high ? value : high;
+                sum += value;
+            }
+            uint32_t n = (uint32_t)(last - first);
+            TEST_ASSERT_EQUAL_UINT16(low, decoded[(AGG_STAT_MIN * windows + w) * READ_REGISTER_COUNT + reg]);
+            TEST_ASSERT_EQUAL_UINT16(high, decoded[(AGG_STAT_MAX * windows + w) * READ_REGISTER_COUNT + reg]);
+            TEST_ASSERT_EQUAL_UINT16((sum + n / 2) / n, decoded[(AGG_STAT_MEAN * windows + w) * READ_REGISTER_COUNT + reg]);
+            TEST_ASSERT_EQUAL_UINT16(rows[(last - 1) * READ_REGISTER_COUNT + reg],
+                                     decoded[(AGG_STAT_LAST * windows + w) * READ_REGISTER_COUNT + reg]);
+        }
+    }
+
+    frame[0] &= ~FRAME_FLAG_AGGREGATED;
+    TEST_ASSERT_EQUAL(0, frame_aggregation_window(frame, frame_len));
+}
+
+// Append one TLV record, as close_trailer_record() in scheduler.cpp does
+static size_t append_record(size_t frame_len, uint8_t type, const uint8_t* value, uint8_t length) {
+    frame[0] |= FRAME_FLAG_TRAILER;
+    frame[frame_len] = type;
+    frame[frame_len + 1] = length;
+    memcpy(frame + frame_len + 2, value, length);
+    return frame_len + 2 + length;
+}
+
+static void test_trailer_records(void) {
+    load_trace(6);
+    for (size_t window = 0; window <= 4; window += 4) {
+        compression_metrics_t metrics = compress_auto(&store, SAMPLES, payload, sizeof(payload));
+        size_t frame_len = build_frame(&metrics, window);
+        size_t trailer_len = 0;
+        TEST_ASSERT_NULL(frame_trailer(frame, frame_len, &trailer_len));
+
+        const uint8_t timing[] = {1, 2, 3};
+        const uint8_t unknown[] = {0xEE};
+        const uint8_t sampling[] = {9, 8, 7, 6, 5};
+        size_t payload_end = frame_len;
+        frame_len = append_record(frame_len, FRAME_TLV_TASK_TIMING, timing, sizeof(timing));
+        frame_len = append_record(frame_len, 0x7F, unknown, sizeof(unknown));
+        frame_len = append_record(frame_len, FRAME_TLV_SAMPLING, sampling, sizeof(sampling));
+
+        // The payload still decodes with records behind it
+        decode_frame(frame_len, SAMPLES);
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(rows, decoded, SAMPLES * READ_REGISTER_COUNT);
+
+        const uint8_t* trailer = frame_trailer(frame, frame_len, &trailer_len);
+        TEST_ASSERT_TRUE(trailer == frame + payload_end);
+        TEST_ASSERT_EQUAL(frame_len - payload_end, trailer_len);
+
+        size_t value_len = 0;
+        const uint8_t* value = frame_tlv_find(trailer, trailer_len, FRAME_TLV_SAMPLING, &value_len);
+        TEST_ASSERT_NOT_NULL(value);
+        TEST_ASSERT_EQUAL(sizeof(sampling), value_len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(sampling, value, value_len);
+        value = frame_tlv_find(trailer, trailer_len, FRAME_TLV_TASK_TIMING, &value_len);
+        TEST_ASSERT_NOT_NULL(value);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(timing, value, value_len);
+        TEST_ASSERT_NULL(frame_tlv_find(trailer, trailer_len, FRAME_TLV_ALARM, &value_len));
+
+        // A record running past the end is malformed
+        TEST_ASSERT_NULL(frame_tlv_find(trailer, trailer_len - 1, FRAME_TLV_SAMPLING, &value_len));
+        // A payload length past the end of the frame has no trailer
+        TEST_ASSERT_NULL(frame_trailer(frame, payload_end - 1, &trailer_len));
+    }
+}
+
+// Varints of the trailer records: sizes at every 7-bit boundary, cut-off input and output
+static void test_varint(void) {
+    static const uint32_t VALUES[] = {0, 1, 127, 128, 16383, 16384, 2097151, 2097152, 268435455, 268435456,
+                                      UINT32_MAX};
+    static const size_t SIZES[] = {1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5};
+    uint8_t bytes[5];
+    for (size_t i = 0; i < sizeof(VALUES) / sizeof(VALUES[0]); i++) {
+        size_t pos = 0;
+        TEST_ASSERT_TRUE(put_varint(bytes, sizeof(bytes), &pos, VALUES[i]));
+        TEST_ASSERT_EQUAL(SIZES[i], pos);
+        size_t read_pos = 0;
+        uint32_t value = 0;
+        TEST_ASSERT_TRUE(get_varint(bytes, pos, &read_pos, &value));
+        TEST_ASSERT_EQUAL(pos, read_pos);
+        TEST_ASSERT_EQUAL(VALUES[i], value);
+
+        read_pos = 0;
+        TEST_ASSERT_FALSE(get_varint(bytes, pos - 1, &read_pos, &value));
+        pos = 0;
+        TEST_ASSERT_FALSE(put_varint(bytes, SIZES[i] - 1, &pos, VALUES[i]));
+    }
+    // More than five bytes is malformed
+    const uint8_t endless[] = {0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+    size_t pos = 0;
+    uint32_t value = 0;
+    TEST_ASSERT_FALSE(get_varint(endless, sizeof(endless), &pos, &value));
+}
+
+static void test_upload_frame_crc(void) {
+    load_trace(7);
+    compression_metrics_t metrics = compress_auto(&store, SAMPLES, payload, sizeof(payload));
+    size_t frame_len = build_frame(&metrics, 0);
+    uint16_t crc = calculateCRC(frame, (int)frame_len);
+    frame[frame_len] = (uint8_t)crc;
+    frame[frame_len + 1] = (uint8_t)(crc >> 8);
+
+    size_t sample_count = 0;
+    uint8_t register_count = 0;
+    TEST_ASSERT_TRUE(decompress_upload_frame(frame, frame_len + 2, decoded, SAMPLES * READ_REGISTER_COUNT,
+                                             &sample_count, &register_count));
+    TEST_ASSERT_EQUAL(SAMPLES, sample_count);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(rows, decoded, SAMPLES * READ_REGISTER_COUNT);
+
+    for (size_t bit = 0; bit < (frame_len + 2) * 8; bit += 13) {
+        frame[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        TEST_ASSERT_FALSE(decompress_upload_frame(frame, frame_len + 2, decoded, SAMPLES * READ_REGISTER_COUNT,
+                                                  &sample_count, &register_count));
+        frame[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+    }
+    TEST_ASSERT_FALSE(decompress_upload_frame(frame, 2, decoded, SAMPLES * READ_REGISTER_COUNT, &sample_count,
+                                              &register_count));
+}
+
+static void test_truncated_and_small_output(void) {
+    load_trace(8);
+    compression_metrics_t metrics = compress_auto(&store, SAMPLES, payload, sizeof(payload));
+    size_t frame_len = build_frame(&metrics, 0);
+    size_t sample_count = 0;
+    uint8_t register_count = 0;
+    for (size_t length = 0; length < frame_len; length++) {
+        TEST_ASSERT_FALSE(decompress_frame(frame, length, decoded, SAMPLES * READ_REGISTER_COUNT, &sample_count,
+                                           &register_count));
+    }
+    // Output too small for every sample
+    TEST_ASSERT_FALSE(decompress_frame(frame, frame_len, decoded, SAMPLES * READ_REGISTER_COUNT - 1,
+                                       &sample_count, &register_count));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_methods);
+    RUN_TEST(test_auto_predicted);
+    RUN_TEST(test_auto_skips_huffman);
+    RUN_TEST(test_every_length);
+    RUN_TEST(test_bounded_quantized);
+    RUN_TEST(test_aggregated);
+    RUN_TEST(test_trailer_records);
+    RUN_TEST(test_varint);
+    RUN_TEST(test_upload_frame_crc);
+    RUN_TEST(test_truncated_and_small_output);
+    return UNITY_END();
+}
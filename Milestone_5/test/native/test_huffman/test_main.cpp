@@ -0,0 +1,140 @@
+// Static-table Huffman codec (COLUMN_CODEC_HUFFMAN): the shipped table in
+// entropy_table.h is a complete canonical code, and every delta symbol and
+// extra-bit width survives a round trip.
+
+#include <unity.h>
+#include <cstring>
+#include "codecs.h"
+#include "entropy_table.h"
+#include "synthetic_traces.h"
+
+#define MAX_SAMPLES 300
+
+static uint16_t input[MAX_SAMPLES];
+static uint16_t decoded[MAX_SAMPLES];
+static uint8_t encoded[MAX_SAMPLES * 4 + 16];
+
+void setUp(void) {
+    memset(decoded, 0xA5, sizeof(decoded));
+}
+
+void tearDown(void) {}
+
+static size_t round_trip(size_t count) {
+    bit_writer_t writer;
+    bit_writer_init(&writer, encoded, sizeof(encoded));
+    size_t length = column_encode(COLUMN_CODEC_HUFFMAN, input, 1, count, &writer);
+    TEST_ASSERT_FALSE(writer.overflow);
+
+    bit_writer_t counter;
+    bit_writer_init(&counter, nullptr, 0);
+    TEST_ASSERT_EQUAL(length, column_encode(COLUMN_CODEC_HUFFMAN, input, 1, count, &counter));
+
+    bit_reader_t reader;
+    bit_reader_init(&reader, encoded, length);
+    TEST_ASSERT_TRUE(column_decode(COLUMN_CODEC_HUFFMAN, &reader, decoded, 1, count));
+    TEST_ASSERT_EQUAL(length, bit_reader_bytes(&reader));
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(input, decoded, count);
+    return length;
+}
+
+// Code lengths fill the tree exactly (Kraft sum 1) and the codes are the
+// canonical assignment of ENTROPY_LENGTH_COUNTS / ENTROPY_SORTED_SYMBOLS
+static void test_table_is_canonical(void) {
+    uint32_t kraft = 0;
+    size_t counted = 0;
+    for (uint8_t len = 1; len <= ENTROPY_MAX_CODE_LEN; len++) {
+        kraft += ENTROPY_LENGTH_COUNTS[len] << (ENTROPY_MAX_CODE_LEN - len);
+        counted += ENTROPY_LENGTH_COUNTS[len];
+    }
+    TEST_ASSERT_EQUAL(0, ENTROPY_LENGTH_COUNTS[0]);
+    TEST_ASSERT_EQUAL(ENTROPY_SYMBOLS, counted);
+    TEST_ASSERT_EQUAL(1u << ENTROPY_MAX_CODE_LEN, kraft);
+
+    uint32_t code = 0;
+    size_t index = 0;
+    for (uint8_t len = 1; len <= ENTROPY_MAX_CODE_LEN; len++) {
+        for (uint8_t i = 0; i < ENTROPY_LENGTH_COUNTS[len]; i++, index++) {
+            uint8_t symbol = ENTROPY_SORTED_SYMBOLS[index];
+            TEST_ASSERT_EQUAL(len, ENTROPY_CODE_LENGTHS[symbol]);
+            TEST_ASSERT_EQUAL(code, ENTROPY_CODES[symbol]);
+            code++;
+        }
+        code <<= 1;
+    }
+}
+
+static void test_symbol_mapping(void) {
+    for (uint16_t zigzag = 0; zigzag < ENTROPY_DIRECT_SYMBOLS; zigzag++) {
+        TEST_ASSERT_EQUAL(zigzag, entropy_symbol(zigzag));
+    }
+    // One escape symbol per bit width 5..16
+    TEST_ASSERT_EQUAL(ENTROPY_DIRECT_SYMBOLS, entropy_symbol(16));
+    TEST_ASSERT_EQUAL(ENTROPY_DIRECT_SYMBOLS, entropy_symbol(31));
+    TEST_ASSERT_EQUAL(ENTROPY_DIRECT_SYMBOLS + 1, entropy_symbol(32));
+    TEST_ASSERT_EQUAL(ENTROPY_SYMBOLS - 1, entropy_symbol(0xFFFF));
+}
+
+// Deltas at both ends of every escape width, in both directions
+static void test_every_symbol(void) {
+    size_t count = 1;
+    input[0] = 30000;
+    for (uint8_t width = 1; width <= 16 && count + 4 <= MAX_SAMPLES; width++) {
+        uint16_t low = (uint16_t)(1u << (width - 1));
+        uint16_t high = (uint16_t)((1u << width) - 1);
+        const uint16_t zigzags[] = {low, high, (uint16_t)(low | 1), (uint16_t)(high & ~1u)};
+        for (size_t i = 0; i < 4; i++) {
+            input[count] = (uint16_t)(input[count - 1] + zigzag_decode16(zigzags[i]));
+            count++;
+        }
+    }
+    round_trip(count);
+}
+
+static void test_synthetic_traces(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 21);
+    static const int32_t SPREADS[] = {0, 1, 7, 40, 2000};
+    for (size_t s = 0; s < sizeof(SPREADS) / sizeof(SPREADS[0]); s++) {
+        trace_walk(&rng, input, 1, MAX_SAMPLES, 25000, SPREADS[s], 0, 65535);
+        static const size_t LENGTHS[] = {1, 2, 50, MAX_SAMPLES};
+        for (size_t l = 0; l < sizeof(LENGTHS) / sizeof(LENGTHS[0]); l++) {
+            round_trip(LENGTHS[l]);
+        }
+    }
+    trace_noise(&rng, input, 1, MAX_SAMPLES);
+    round_trip(MAX_SAMPLES);
+    trace_ramp(input, 1, MAX_SAMPLES, 65500, 1);
+    round_trip(MAX_SAMPLES);
+}
+
+// A flat column costs the first value plus the shortest code per sample
+static void test_flat_column_size(void) {
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        input[i] = 777;
+    }
+    size_t bits = 16 + (MAX_SAMPLES - 1) * ENTROPY_CODE_LENGTHS[0];
+    TEST_ASSERT_EQUAL((bits + 7) / 8, round_trip(MAX_SAMPLES));
+}
+
+static void test_truncated_input_is_rejected(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 4);
+    trace_noise(&rng, input, 1, MAX_SAMPLES);
+    size_t length = round_trip(MAX_SAMPLES);
+
+    bit_reader_t reader;
+    bit_reader_init(&reader, encoded, length / 2);
+    TEST_ASSERT_FALSE(column_decode(COLUMN_CODEC_HUFFMAN, &reader, decoded, 1, MAX_SAMPLES));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_table_is_canonical);
+    RUN_TEST(test_symbol_mapping);
+    RUN_TEST(test_every_symbol);
+    RUN_TEST(test_synthetic_traces);
+    RUN_TEST(test_flat_column_size);
+    RUN_TEST(test_truncated_input_is_rejected);
+    return UNITY_END();
+}
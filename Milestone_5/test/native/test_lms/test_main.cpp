@@ -0,0 +1,87 @@
+// Sign-sign LMS codec (COLUMN_CODEC_LMS): saturated predictions drive the
+// weights into their clamps and the decoder replays them exactly, and once
+// converged the predictor beats plain deltas on a trend. Generic round trips
+// over every codec are in test_codecs.
+
+#include <unity.h>
+#include <cmath>
+#include "codec_round_trip.h"
+#include "synthetic_traces.h"
+
+#define MAX_SAMPLES 300
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Push input[0..count-1] through an LMS encoder, tracking the extreme weights it reaches
+static void weight_range(size_t count, int32_t* low, int32_t* high) {
+    bit_writer_t counter;
+    bit_writer_init(&counter, nullptr, 0);
+    column_encoder_t encoder;
+    column_encoder_init(&encoder, COLUMN_CODEC_LMS);
+    *low = 0;
+    *high = 0;
+    for (size_t i = 0; i < count; i++) {
+        column_encoder_push(&encoder, &counter, input[i]);
+        for (uint8_t w = 0; w < LMS_ORDER; w++) {
+            *low = encoder.lms.weights[w] < *low ? encoder.lms.weights[w] : *low;
+            *high = encoder.lms.weights[w] > *high ? encoder.lms.weights[w] : *high;
+        }
+    }
+}
+
+// Deltas growing 3x per sample (`sign` -1 alternates them) until they would
+// leave 16 bits: the predictor keeps lagging, saturates, and pushes the
+// weights into their clamps
+static void geometric_deltas(int32_t sign) {
+    uint16_t value = 30000;
+    int32_t delta = 1;
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        delta *= 3 * sign;
+        if (delta > 20000 || delta < -20000) {
+            delta = 1;
+        }
+        value = (uint16_t)(value + delta);
+        input[i] = value;
+    }
+}
+
+static void test_weights_clamp(void) {
+    int32_t low, high;
+    geometric_deltas(1);
+    weight_range(MAX_SAMPLES, &low, &high);
+    TEST_ASSERT_EQUAL(LMS_WEIGHT_LIMIT, high);
+    check_round_trip(COLUMN_CODEC_LMS, 1, MAX_SAMPLES);
+
+    geometric_deltas(-1);
+    weight_range(MAX_SAMPLES, &low, &high);
+    TEST_ASSERT_EQUAL(-LMS_WEIGHT_LIMIT, low);
+    TEST_ASSERT_EQUAL(LMS_WEIGHT_LIMIT, high);
+    check_round_trip(COLUMN_CODEC_LMS, 1, MAX_SAMPLES);
+
+    // Full-scale noise moves them both ways without leaving the clamps
+    trace_rng_t rng;
+    trace_seed(&rng, 8);
+    trace_noise(&rng, input, 1, MAX_SAMPLES);
+    weight_range(MAX_SAMPLES, &low, &high);
+    TEST_ASSERT_GREATER_OR_EQUAL(-LMS_WEIGHT_LIMIT, low);
+    TEST_ASSERT_LESS_OR_EQUAL(LMS_WEIGHT_LIMIT, high);
+    check_round_trip(COLUMN_CODEC_LMS, 1, MAX_SAMPLES);
+}
+
+// Once the weights have converged, a trending signal costs less than plain deltas
+static void test_learns_trends(void) {
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        input[i] = (uint16_t)(30000 + lround(8000.0 * sin((double)i * 0.2)));
+    }
+    size_t lms = check_round_trip(COLUMN_CODEC_LMS, 1, MAX_SAMPLES);
+    TEST_ASSERT_LESS_THAN(check_round_trip(COLUMN_CODEC_BITPACK, 1, MAX_SAMPLES), lms);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_weights_clamp);
+    RUN_TEST(test_learns_trends);
+    return UNITY_END();
+}
@@ -0,0 +1,101 @@
+// Binary Modbus RTU frames (lib/modbus_frame): requests, response parsing with
+// its length / CRC / exception checks, and the hex conversion at the HTTP edge.
+
+#include <unity.h>
+#include <cstring>
+#include "modbus_frame.h"
+#include "calculateCRC.h"
+
+static uint8_t frame[MODBUS_MAX_FRAME];
+
+void setUp(void) {
+    memset(frame, 0, sizeof(frame));
+}
+
+void tearDown(void) {}
+
+// Copy bytes into frame and append their CRC (low byte first); returns the frame length
+static size_t with_crc(const uint8_t* bytes, size_t length) {
+    memcpy(frame, bytes, length);
+    uint16_t crc = calculateCRC(frame, (int)length);
+    frame[length] = (uint8_t)crc;
+    frame[length + 1] = (uint8_t)(crc >> 8);
+    return length + 2;
+}
+
+static void test_build_request(void) {
+    // Read 2 registers from 0 on slave 0x11: the classic 11 03 00 00 00 02 C6 9B
+    const uint8_t expected[] = {0x11, 0x03, 0x00, 0x00, 0x00, 0x02, 0xC6, 0x9B};
+    TEST_ASSERT_EQUAL(MODBUS_REQUEST_SIZE, modbus_build_request(frame, sizeof(frame), 0x11, 0x03, 0, 2));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, sizeof(expected));
+    TEST_ASSERT_EQUAL(0, modbus_build_request(frame, MODBUS_REQUEST_SIZE - 1, 0x11, 0x03, 0, 2));
+}
+
+static void test_read_response(void) {
+    const uint8_t bytes[] = {0x11, 0x03, 0x04, 0x12, 0x34, 0xAB, 0xCD};
+    size_t length = with_crc(bytes, sizeof(bytes));
+    modbus_response_t response;
+    TEST_ASSERT_EQUAL(MODBUS_FRAME_OK, modbus_parse_response(frame, length, &response));
+    TEST_ASSERT_EQUAL(0x11, response.slave);
+    TEST_ASSERT_EQUAL(0x03, response.function);
+    TEST_ASSERT_EQUAL(0, response.exception_code);
+    TEST_ASSERT_EQUAL(2, modbus_register_count(&response));
+    TEST_ASSERT_EQUAL(0x1234, modbus_register(&response, 0));
+    TEST_ASSERT_EQUAL(0xABCD, modbus_register(&response, 1));
+
+    frame[3] ^= 0x01;
+    TEST_ASSERT_EQUAL(MODBUS_FRAME_BAD_CRC, modbus_parse_response(frame, length, &response));
+    TEST_ASSERT_EQUAL(MODBUS_FRAME_TOO_SHORT, modbus_parse_response(frame, 3, &response));
+
+    // Byte count disagreeing with the frame length
+    const uint8_t short_count[] = {0x11, 0x03, 0x02, 0x12, 0x34, 0xAB, 0xCD};
+    length = with_crc(short_count, sizeof(short_count));
+    TEST_ASSERT_EQUAL(MODBUS_FRAME_BAD_LENGTH, modbus_parse_response(frame, length, &response));
+}
+
+static void test_exception_response(void) {
+    const uint8_t bytes[] = {0x11, 0x83, 0x02};
+    size_t length = with_crc(bytes, sizeof(bytes));
+    modbus_response_t response;
+    TEST_ASSERT_EQUAL(MODBUS_FRAME_OK, modbus_parse_response(frame, length, &response));
+    TEST_ASSERT_EQUAL(0x03, response.function);
+    TEST_ASSERT_EQUAL(0x02, response.exception_code);
+    TEST_ASSERT_EQUAL(0, response.data.length);
+
+    const uint8_t long_exception[] = {0x11, 0x83, 0x02, 0x00};
+    length = with_crc(long_exception, sizeof(long_exception));
+    TEST_ASSERT_EQUAL(MODBUS_FRAME_BAD_LENGTH, modbus_parse_response(frame, length, &response));
+}
+
+// Exception code 0 would be indistinguishable from a normal response with no data
+static void test_exception_code_zero_is_rejected(void) {
+    const uint8_t bytes[] = {0x11, 0x83, 0x00};
+    size_t length = with_crc(bytes, sizeof(bytes));
+    modbus_response_t response;
+    TEST_ASSERT_EQUAL(MODBUS_FRAME_BAD_EXCEPTION, modbus_parse_response(frame, length, &response));
+}
+
+static void test_hex(void) {
+    const uint8_t bytes[] = {0x00, 0x1F, 0xA0, 0xFF};
+    char hex[9];
+    TEST_ASSERT_EQUAL(8, modbus_hex_encode(bytes, sizeof(bytes), hex, sizeof(hex)));
+    TEST_ASSERT_EQUAL_STRING("001FA0FF", hex);
+    TEST_ASSERT_EQUAL(0, modbus_hex_encode(bytes, sizeof(bytes), hex, 8));  // No room for the NUL
+
+    uint8_t decoded[4];
+    TEST_ASSERT_EQUAL(4, modbus_hex_decode("001fA0Ff", 8, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(bytes, decoded, sizeof(bytes));
+    TEST_ASSERT_EQUAL(0, modbus_hex_decode("001", 3, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL(0, modbus_hex_decode("0G", 2, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL(0, modbus_hex_decode("001FA0FF00", 10, decoded, sizeof(decoded)));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_build_request);
+    RUN_TEST(test_read_response);
+    RUN_TEST(test_exception_response);
+    RUN_TEST(test_exception_code_zero_is_rejected);
+    RUN_TEST(test_hex);
+    return UNITY_END();
+}
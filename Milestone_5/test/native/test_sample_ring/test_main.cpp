@@ -0,0 +1,207 @@
+// Lock-free SPSC sample ring (lib/sample_ring) under real concurrency: one
+// std::thread pushes numbered samples while another pops them. Every sample
+// must come out exactly once, in order and untorn; dropped pushes must match
+// the overflow counter. Run it under -fsanitize=thread as well to check the
+// memory ordering.
+
+#include <unity.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "sample_ring.h"
+
+#define WIDTH 10                 // One sample of READ_REGISTER_COUNT values
+#define STRESS_SAMPLES 1000000u
+
+static uint16_t storage[64 * WIDTH];
+static sample_ring_t ring;
+
+void setUp(void) {
+    memset(storage, 0, sizeof(storage));
+}
+
+void tearDown(void) {}
+
+// Sample seq: the number in values[0..1], every other value derived from it,
+// so a copy that mixes two slots is detected
+static void make_sample(uint32_t seq, uint16_t* values) {
+    values[0] = (uint16_t)seq;
+    values[1] = (uint16_t)(seq >> 16);
+    for (uint32_t i = 2; i < WIDTH; i++) {
+        values[i] = (uint16_t)(seq * 2654435761u >> i);
+    }
+}
+
+static bool check_sample(const uint16_t* values, uint32_t* seq) {
+    *seq = values[0] | ((uint32_t)values[1] << 16);
+    uint16_t expected[WIDTH];
+    make_sample(*seq, expected);
+    return memcmp(values, expected, sizeof(expected)) == 0;
+}
+
+typedef struct {
+    std::vector<uint32_t> popped;
+    uint32_t torn;
+    uint32_t out_of_order;
+} consumer_result_t;
+
+// Pops until `total` samples were seen or the producer is done and the ring is empty
+static void consume(uint32_t total, const std::atomic<bool>* producer_done, consumer_result_t* result) {
+    uint16_t values[WIDTH];
+    bool first = true;
+    uint32_t last = 0;
+    while (result->popped.size() < total) {
+        if (!sample_ring_pop(&ring, values)) {
+            if (producer_done->load(std::memory_order_acquire) && sample_ring_count(&ring) == 0) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t seq;
+        if (!check_sample(values, &seq)) {
+            result->torn++;
+        }
+        if (!first && seq <= last) {
+            result->out_of_order++;
+        }
+        first = false;
+        last = seq;
+        result->popped.push_back(seq);
+    }
+}
+
+// Producer retries until every sample is accepted: the consumer sees 0..n-1 exactly
+static void run_lossless(uint32_t capacity, uint32_t samples) {
+    TEST_ASSERT_TRUE(sample_ring_init(&ring, storage, capacity, WIDTH));
+    std::atomic<bool> done(false);
+    consumer_result_t result = {{}, 0, 0};
+    result.popped.reserve(samples);
+
+    std::thread consumer(consume, samples, &done, &result);
+    uint32_t rejected = 0;
+    std::thread producer([&] {
+        uint16_t values[WIDTH];
+        for (uint32_t seq = 0; seq < samples; seq++) {
+            make_sample(seq, values);
+            while (!sample_ring_push(&ring, values)) {
+                rejected++;
+                std::this_thread::yield();
+            }
+        }
+        done.store(true, std::memory_order_release);
+    });
+    producer.join();
+    consumer.join();
+
+    TEST_ASSERT_EQUAL(0, result.torn);
+    TEST_ASSERT_EQUAL(0, result.out_of_order);
+    TEST_ASSERT_EQUAL(samples, result.popped.size());
+    for (uint32_t i = 0; i < samples; i++) {
+        TEST_ASSERT_EQUAL(i, result.popped[i]);
+    }
+    TEST_ASSERT_EQUAL(rejected, ring.overflows.load());
+    TEST_ASSERT_LESS_OR_EQUAL(capacity, ring.high_water.load());
+    TEST_ASSERT_EQUAL(0, sample_ring_count(&ring));
+}
+
+static void test_lossless_small_ring(void) {
+    run_lossless(2, STRESS_SAMPLES);
+}
+
+static void test_lossless_buffer_sized_ring(void) {
+    run_lossless(64, STRESS_SAMPLES);
+}
+
+// Producer pushes once per sample, as the acquisition task does: the consumer
+// sees exactly the accepted samples, and every rejected one is an overflow
+static void test_dropping_producer(void) {
+    const uint32_t samples = STRESS_SAMPLES;
+    TEST_ASSERT_TRUE(sample_ring_init(&ring, storage, 4, WIDTH));
+    std::atomic<bool> done(false);
+    consumer_result_t result = {{}, 0, 0};
+    result.popped.reserve(samples);
+    std::vector<uint32_t> accepted;
+    accepted.reserve(samples);
+
+    std::thread consumer(consume, samples, &done, &result);
+    std::thread producer([&] {
+        uint16_t values[WIDTH];
+        for (uint32_t seq = 0; seq < samples; seq++) {
+            make_sample(seq, values);
+            if (sample_ring_push(&ring, values)) {
+                accepted.push_back(seq);
+            }
+        }
+        done.store(true, std::memory_order_release);
+    });
+    producer.join();
+    consumer.join();
+
+    TEST_ASSERT_EQUAL(0, result.torn);
+    TEST_ASSERT_EQUAL(0, result.out_of_order);
+    TEST_ASSERT_EQUAL(accepted.size(), result.popped.size());
+    TEST_ASSERT_TRUE(accepted == result.popped);
+    TEST_ASSERT_EQUAL(samples - accepted.size(), ring.overflows.load());
+}
+
+// head and tail are free-running: crossing 2^32 must not lose or repeat samples
+static void test_counter_wraparound(void) {
+    TEST_ASSERT_TRUE(sample_ring_init(&ring, storage, 8, WIDTH));
+    ring.head.store(0xFFFFFFF0u);
+    ring.tail.store(0xFFFFFFF0u);
+
+    uint16_t values[WIDTH];
+    uint32_t next_pop = 0;
+    for (uint32_t seq = 0; seq < 100; seq++) {
+        make_sample(seq, values);
+        TEST_ASSERT_TRUE(sample_ring_push(&ring, values));
+        if (seq % 3 == 2) {
+            continue;  // Let the fill level vary across the wrap
+        }
+        while (sample_ring_count(&ring) > 2) {
+            uint32_t popped;
+            TEST_ASSERT_TRUE(sample_ring_pop(&ring, values));
+            TEST_ASSERT_TRUE(check_sample(values, &popped));
+            TEST_ASSERT_EQUAL(next_pop++, popped);
+        }
+    }
+    while (sample_ring_pop(&ring, values)) {
+        uint32_t popped;
+        TEST_ASSERT_TRUE(check_sample(values, &popped));
+        TEST_ASSERT_EQUAL(next_pop++, popped);
+    }
+    TEST_ASSERT_EQUAL(100, next_pop);
+    TEST_ASSERT_EQUAL(0, ring.overflows.load());
+}
+
+static void test_full_ring_counts_overflows(void) {
+    TEST_ASSERT_TRUE(sample_ring_init(&ring, storage, 4, WIDTH));
+    TEST_ASSERT_FALSE(sample_ring_init(&ring, storage, 6, WIDTH));  // Not a power of two
+
+    uint16_t values[WIDTH];
+    for (uint32_t seq = 0; seq < 7; seq++) {
+        make_sample(seq, values);
+        TEST_ASSERT_EQUAL(seq < 4, sample_ring_push(&ring, values));
+    }
+    TEST_ASSERT_EQUAL(3, ring.overflows.load());
+    TEST_ASSERT_EQUAL(4, ring.high_water.load());
+    TEST_ASSERT_EQUAL(4, sample_ring_count(&ring));
+    for (uint32_t seq = 0; seq < 4; seq++) {
+        uint32_t popped;
+        TEST_ASSERT_TRUE(sample_ring_pop(&ring, values));
+        TEST_ASSERT_TRUE(check_sample(values, &popped));
+        TEST_ASSERT_EQUAL(seq, popped);
+    }
+    TEST_ASSERT_FALSE(sample_ring_pop(&ring, values));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_ring_counts_overflows);
+    RUN_TEST(test_counter_wraparound);
+    RUN_TEST(test_lossless_small_ring);
+    RUN_TEST(test_lossless_buffer_sized_ring);
+    RUN_TEST(test_dropping_producer);
+    return UNITY_END();
+}
@@ -0,0 +1,221 @@
+// Sample time trailer record (FRAME_TLV_SAMPLE_TIMES): on-time samples cost
+// one bit, every delta-of-delta escape class is taken at its boundaries, the
+// resolution doubles until irregular times fit, and cut-off values are rejected.
+
+#include <unity.h>
+#include <cstring>
+#include "sample_times.h"
+#include "bitstream.h"
+#include "synthetic_traces.h"
+
+#define MAX_SAMPLES 64
+#define RESOLUTION_MS 100
+#define INTERVAL_MS 1000
+#define HEADER_SIZE 10  // flags, 48-bit base, one-byte resolution, interval and count varints
+
+static uint32_t times[MAX_SAMPLES];
+static int32_t offsets[MAX_SAMPLES];
+static uint8_t encoded[256];
+
+void setUp(void) {
+    memset(offsets, 0xA5, sizeof(offsets));
+}
+
+void tearDown(void) {}
+
+static sample_times_header_t make_header(size_t count) {
+    sample_times_header_t header;
+    header.base_ms = 1700000000000ULL;
+    header.unix_time = true;
+    header.resolution_ms = RESOLUTION_MS;
+    header.interval = INTERVAL_MS / RESOLUTION_MS;
+    header.count = count;
+    return header;
+}
+
+// Decode encoded[0..length-1], check the header against `expected` and every
+// offset against times[] to within half a resolution step
+static void check_decode(const sample_times_header_t* expected, size_t length) {
+    sample_times_header_t header;
+    TEST_ASSERT_TRUE(sample_times_decode(encoded, length, &header, offsets, MAX_SAMPLES));
+    TEST_ASSERT_TRUE(header.base_ms == expected->base_ms);
+    TEST_ASSERT_EQUAL(expected->unix_time, header.unix_time);
+    TEST_ASSERT_EQUAL_UINT32(expected->resolution_ms, header.resolution_ms);
+    TEST_ASSERT_EQUAL_UINT32(expected->interval, header.interval);
+    TEST_ASSERT_EQUAL(expected->count, header.count);
+    for (size_t i = 0; i < header.count; i++) {
+        int32_t actual = (int32_t)(times[i] - times[0]);
+        TEST_ASSERT_INT32_WITHIN(header.resolution_ms / 2, actual, offsets[i]);
+        TEST_ASSERT_EQUAL_INT32(0, offsets[i] % (int32_t)header.resolution_ms);
+    }
+}
+
+void test_on_time_samples_cost_one_bit(void) {
+    for (size_t i = 0; i < 33; i++) {
+        times[i] = 50000 + (uint32_t)i * INTERVAL_MS;
+    }
+    sample_times_header_t header = make_header(33);
+    size_t length = sample_times_encode(&header, times, encoded, sizeof(encoded));
+
+    // 32 later samples, one zero bit each
+    TEST_ASSERT_EQUAL(HEADER_SIZE + 4, length);
+    for (size_t i = HEADER_SIZE; i < length; i++) {
+        TEST_ASSERT_EQUAL_HEX8(0x00, encoded[i]);
+    }
+    check_decode(&header, length);
+
+    // Jitter under half a step still quantizes onto the grid
+    times[7] += RESOLUTION_MS / 2 - 1;
+    times[20] -= RESOLUTION_MS / 2 - 1;
+    TEST_ASSERT_EQUAL(HEADER_SIZE + 4, sample_times_encode(&header, times, encoded, sizeof(encoded)));
+}
+
+// Two samples whose second one is `dod` steps off the nominal interval: reads
+// back the leading ones of the escape and its code; returns the bits used
+static size_t encode_single_dod(int32_t dod, uint32_t* prefix, uint32_t* code) {
+    times[0] = 1000000;
+    times[1] = times[0] + INTERVAL_MS + (uint32_t)(dod * RESOLUTION_MS);
+    sample_times_header_t header = make_header(2);
+    size_t length = sample_times_encode(&header, times, encoded, sizeof(encoded));
+    TEST_ASSERT_TRUE(length > HEADER_SIZE);
+    check_decode(&header, length);
+
+    bit_reader_t reader;
+    bit_reader_init(&reader, encoded + HEADER_SIZE, length - HEADER_SIZE);
+    *prefix = 0;
+    while (*prefix < 4 && bit_reader_get(&reader, 1)) {
+        (*prefix)++;
+    }
+    TEST_ASSERT_TRUE(*prefix > 0);
+    static const uint8_t payload_bits[] = {3, 7, 12, 32};
+    uint8_t width = payload_bits[*prefix - 1];
+    if (width > 16) {
+        *code = bit_reader_get(&reader, 16) << 16;
+        *code |= bit_reader_get(&reader, 16);
+    } else {
+        *code = bit_reader_get(&reader, width);
+    }
+    TEST_ASSERT_FALSE(reader.overflow);
+    return *prefix + (*prefix < 4) + width;
+}
+
+void test_escape_classes(void) {
+    // dod -> zigzag(dod) - 1 at the edge of each class
+    static const struct {
+        int32_t dod;
+        uint32_t prefix_ones;
+        uint32_t code;
+        size_t bits;
+    } cases[] = {
+        {-1, 1, 0, 5},        {4, 1, 7, 5},             // 10 + 3 bits
+        {-5, 2, 8, 10},       {64, 2, 127, 10},         // 110 + 7 bits
+        {-65, 3, 128, 16},    {2048, 3, 4095, 16},      // 1110 + 12 bits
+        {-2049, 4, 4096, 36}, {-300000, 4, 599998, 36}, // 1111 + 32 bits
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint32_t prefix, code;
+        size_t bits = encode_single_dod(cases[i].dod, &prefix, &code);
+        TEST_ASSERT_EQUAL_UINT32(cases[i].prefix_ones, prefix);
+        TEST_ASSERT_EQUAL_UINT32(cases[i].code, code);
+        TEST_ASSERT_EQUAL(cases[i].bits, bits);
+        sample_times_header_t header = make_header(2);
+        TEST_ASSERT_EQUAL(HEADER_SIZE + (cases[i].bits + 7) / 8,
+                          sample_times_encode(&header, times, encoded, sizeof(encoded)));
+    }
+}
+
+void test_resolution_doubles_until_it_fits(void) {
+    // Poll jitter of up to +-1.5 s: 5-10 bits a sample at 100 ms
+    trace_rng_t rng;
+    trace_seed(&rng, 11);
+    times[0] = 200000;
+    for (size_t i = 1; i < 40; i++) {
+        times[i] = times[i - 1] + INTERVAL_MS + (uint32_t)trace_jitter(&rng, 1500);
+    }
+    const size_t capacity = 24;
+    sample_times_header_t header = make_header(40);
+    TEST_ASSERT_EQUAL(0, sample_times_encode(&header, times, encoded, capacity));
+
+    size_t length = sample_times_encode_fitted(&header, INTERVAL_MS, 60000, times, encoded, capacity);
+    TEST_ASSERT_TRUE(length > 0 && length <= capacity);
+    TEST_ASSERT_TRUE(header.resolution_ms > RESOLUTION_MS);
+    TEST_ASSERT_EQUAL_UINT32((INTERVAL_MS + header.resolution_ms / 2) / header.resolution_ms, header.interval);
+    check_decode(&header, length);
+
+    // The first resolution that fits was taken
+    sample_times_header_t finer = header;
+    finer.resolution_ms /= 2;
+    finer.interval = (INTERVAL_MS + finer.resolution_ms / 2) / finer.resolution_ms;
+    TEST_ASSERT_EQUAL(0, sample_times_encode(&finer, times, encoded, capacity));
+
+    // Nothing fits under a ceiling below it
+    sample_times_header_t capped = make_header(40);
+    TEST_ASSERT_EQUAL(0, sample_times_encode_fitted(&capped, INTERVAL_MS, header.resolution_ms / 2, times,
+                                                    encoded, capacity));
+
+    // Times that fit keep the starting resolution
+    for (size_t i = 0; i < 40; i++) {
+        times[i] = 200000 + (uint32_t)i * INTERVAL_MS;
+    }
+    sample_times_header_t regular = make_header(40);
+    TEST_ASSERT_TRUE(sample_times_encode_fitted(&regular, INTERVAL_MS, 60000, times, encoded, capacity) > 0);
+    TEST_ASSERT_EQUAL_UINT32(RESOLUTION_MS, regular.resolution_ms);
+}
+
+void test_out_of_order_first_sample(void) {
+    // A sample read late but stamped before the first one, and times across
+    // the 32-bit uptime wrap
+    times[0] = 0xFFFFFC18u;  // 1 s before the wrap
+    times[1] = times[0] - 1500;
+    times[2] = times[0] + 1000;
+    times[3] = times[0] + 2000;
+    sample_times_header_t header = make_header(4);
+    size_t length = sample_times_encode(&header, times, encoded, sizeof(encoded));
+    TEST_ASSERT_TRUE(length > 0);
+    check_decode(&header, length);
+    TEST_ASSERT_EQUAL_INT32(-1500, offsets[1]);
+    TEST_ASSERT_EQUAL_INT32(1000, offsets[2]);
+    TEST_ASSERT_EQUAL_INT32(2000, offsets[3]);
+}
+
+void test_truncated_input_rejected(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 5);
+    times[0] = 0;
+    for (size_t i = 1; i < 30; i++) {
+        times[i] = times[i - 1] + INTERVAL_MS + (i % 4 == 0 ? (uint32_t)trace_jitter(&rng, 20000) : 0);
+    }
+    sample_times_header_t header = make_header(30);
+    size_t length = sample_times_encode(&header, times, encoded, sizeof(encoded));
+    TEST_ASSERT_TRUE(length > HEADER_SIZE);
+    check_decode(&header, length);
+
+    sample_times_header_t decoded;
+    for (size_t cut = 0; cut < length; cut++) {
+        TEST_ASSERT_FALSE(sample_times_decode(encoded, cut, &decoded, offsets, MAX_SAMPLES));
+    }
+
+    // Encoding into any smaller buffer fails rather than truncating
+    for (size_t capacity = 0; capacity < length; capacity++) {
+        TEST_ASSERT_EQUAL(0, sample_times_encode(&header, times, encoded, capacity));
+    }
+
+    // A count beyond the codes present, and a zero resolution
+    header = make_header(30);
+    length = sample_times_encode(&header, times, encoded, sizeof(encoded));
+    encoded[HEADER_SIZE - 1] = 120;
+    TEST_ASSERT_FALSE(sample_times_decode(encoded, length, &decoded, offsets, MAX_SAMPLES));
+    encoded[HEADER_SIZE - 1] = 30;
+    encoded[HEADER_SIZE - 3] = 0;
+    TEST_ASSERT_FALSE(sample_times_decode(encoded, length, &decoded, offsets, MAX_SAMPLES));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_on_time_samples_cost_one_bit);
+    RUN_TEST(test_escape_classes);
+    RUN_TEST(test_resolution_doubles_until_it_fits);
+    RUN_TEST(test_out_of_order_first_sample);
+    RUN_TEST(test_truncated_input_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,176 @@
+// Flash store-and-forward queue (lib/spill_queue) over the in-memory SPIFFS
+// and NVS of test/native/include: every record appended is delivered once, in
+// order, across failed flash writes and reboots (spill_init on the same files).
+
+#include <unity.h>
+#include <vector>
+#include <SPIFFS.h>
+#include <Preferences.h>
+#include "host_support.h"
+#include "spill_queue.h"
+
+static upload_packet_t packet;
+static upload_packet_t peeked;
+
+void setUp(void) {
+    SPIFFS.files.clear();
+    SPIFFS.fail_writes = 0;
+    SPIFFS.keep_bytes = 0;
+    native_nvs.clear();
+    TEST_ASSERT_TRUE(spill_init());
+}
+
+void tearDown(void) {}
+
+// Sealed packet identified by id (nonce and payload bytes), payload_len bytes of payload
+static bool append(uint32_t id, uint16_t payload_len = 48) {
+    packet.sealed = true;
+    packet.tag = id;
+    packet.nonce = id;
+    packet.frame_len = 40;
+    memset(packet.mac, 'a' + id % 26, 64);
+    packet.mac[64] = '\0';
+    packet.payload_len = payload_len;
+    for (uint16_t i = 0; i < payload_len; i++) {
+        packet.payload[i] = (uint8_t)(id * 31 + i);
+    }
+    return spill_append(&packet);
+}
+
+// The next flash write stores only `keep` bytes (a full or failing flash)
+static bool append_failing(uint32_t id, size_t keep, uint16_t payload_len = 48) {
+    SPIFFS.fail_writes = 1;
+    SPIFFS.keep_bytes = keep;
+    return append(id, payload_len);
+}
+
+// Peek and ack until the queue is empty; returns the ids in delivery order, checking every payload
+static std::vector<uint32_t> drain(void) {
+    std::vector<uint32_t> ids;
+    uint32_t sequence;
+    while (spill_peek(&peeked, &sequence)) {
+        TEST_ASSERT_TRUE(peeked.sealed);
+        TEST_ASSERT_EQUAL(sequence, peeked.tag);
+        for (uint16_t i = 0; i < peeked.payload_len; i++) {
+            TEST_ASSERT_EQUAL((uint8_t)(peeked.nonce * 31 + i), peeked.payload[i]);
+        }
+        ids.push_back(peeked.nonce);
+        spill_ack(sequence);
+        TEST_ASSERT_LESS_THAN(1000, ids.size());
+    }
+    TEST_ASSERT_EQUAL(0, spill_count());
+    return ids;
+}
+
+static void check_ids(const std::vector<uint32_t>& ids, const std::vector<uint32_t>& expected) {
+    TEST_ASSERT_EQUAL(expected.size(), ids.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        TEST_ASSERT_EQUAL(expected[i], ids[i]);
+    }
+}
+
+static void test_append_drain(void) {
+    for (uint32_t id = 1; id <= 5; id++) {
+        TEST_ASSERT_TRUE(append(id));
+    }
+    TEST_ASSERT_EQUAL(5, spill_count());
+    check_ids(drain(), {1, 2, 3, 4, 5});
+    TEST_ASSERT_TRUE(SPIFFS.files.empty());  // Delivered segments are deleted
+}
+
+// A write failing mid-segment: the torn record is skipped, nothing after it is lost
+static void test_failed_write_mid_segment(void) {
+    TEST_ASSERT_TRUE(append(1));
+    TEST_ASSERT_TRUE(append(2));
+    TEST_ASSERT_FALSE(append_failing(3, 20));
+    TEST_ASSERT_TRUE(append(4));
+    TEST_ASSERT_TRUE(append(5));
+    TEST_ASSERT_EQUAL(4, spill_count());
+    check_ids(drain(), {1, 2, 4, 5});
+    TEST_ASSERT_EQUAL(1, spill_get_stats().corrupt_records);
+}
+
+// The first write of a new segment failing: the appends after it go to the same
+// file name, which must be started over, not indexed a second time
+static void test_failed_first_write_of_segment(void) {
+    TEST_ASSERT_FALSE(append_failing(1, 30));
+    TEST_ASSERT_FALSE(append_failing(2, 0));
+    TEST_ASSERT_TRUE(append(3));
+    TEST_ASSERT_TRUE(append(4));
+    TEST_ASSERT_EQUAL(1, spill_get_stats().segments);
+    check_ids(drain(), {3, 4});
+
+    // Same with good records in an older segment, delivered while the new one fills
+    TEST_ASSERT_TRUE(append(5));
+    TEST_ASSERT_FALSE(append_failing(6, 10));  // Closes the segment holding 5
+    TEST_ASSERT_FALSE(append_failing(7, 10));  // First write of the next segment
+    TEST_ASSERT_TRUE(append(8));
+    TEST_ASSERT_TRUE(append(9));
+    TEST_ASSERT_EQUAL(2, spill_get_stats().segments);
+    check_ids(drain(), {5, 8, 9});
+}
+
+// Segments roll over at SPILL_SEGMENT_BYTES; the write opening the next segment
+// failing loses only that record
+static void test_failed_write_at_rollover(void) {
+    const uint16_t payload_len = UPLOAD_PACKET_MAX;
+    const uint32_t per_segment = SPILL_SEGMENT_BYTES / (80 + payload_len);  // Header + fixed body + payload
+    std::vector<uint32_t> expected;
+    for (uint32_t id = 1; id <= per_segment; id++) {
+        TEST_ASSERT_TRUE(append(id, payload_len));
+        expected.push_back(id);
+    }
+    TEST_ASSERT_EQUAL(1, spill_get_stats().segments);
+    TEST_ASSERT_FALSE(append_failing(per_segment + 1, 50, payload_len));
+    TEST_ASSERT_EQUAL(2, spill_get_stats().segments);
+    for (uint32_t id = per_segment + 2; id <= per_segment + 4; id++) {
+        TEST_ASSERT_TRUE(append(id, payload_len));
+        expected.push_back(id);
+    }
+    TEST_ASSERT_EQUAL(2, spill_get_stats().segments);
+    TEST_ASSERT_EQUAL(2, SPIFFS.files.size());
+    check_ids(drain(), expected);
+}
+
+// Reboot with a torn, record-less newest segment on flash: appends after the reboot survive
+static void test_reboot_after_failed_write(void) {
+    TEST_ASSERT_TRUE(append(1));
+    TEST_ASSERT_FALSE(append_failing(2, 30));
+    TEST_ASSERT_FALSE(append_failing(3, 30));  // Record-less segment left on flash
+    TEST_ASSERT_TRUE(spill_init());
+    TEST_ASSERT_EQUAL(1, spill_count());
+    TEST_ASSERT_TRUE(append(4));
+    TEST_ASSERT_TRUE(append(5));
+
+    TEST_ASSERT_TRUE(spill_init());
+    TEST_ASSERT_EQUAL(3, spill_count());
+    check_ids(drain(), {1, 4, 5});
+}
+
+// Delivery progress persists: records acked before a reboot are not sent again
+static void test_reboot_keeps_tail(void) {
+    for (uint32_t id = 1; id <= 4; id++) {
+        TEST_ASSERT_TRUE(append(id));
+    }
+    uint32_t sequence;
+    TEST_ASSERT_TRUE(spill_peek(&peeked, &sequence));
+    spill_ack(sequence);
+    TEST_ASSERT_TRUE(spill_peek(&peeked, &sequence));
+    spill_ack(sequence);
+
+    TEST_ASSERT_TRUE(spill_init());
+    TEST_ASSERT_EQUAL(2, spill_count());
+    TEST_ASSERT_TRUE(append(5));
+    check_ids(drain(), {3, 4, 5});
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_append_drain);
+    RUN_TEST(test_failed_write_mid_segment);
+    RUN_TEST(test_failed_first_write_of_segment);
+    RUN_TEST(test_failed_write_at_rollover);
+    RUN_TEST(test_reboot_after_failed_write);
+    RUN_TEST(test_reboot_keeps_tail);
+    return UNITY_END();
+}
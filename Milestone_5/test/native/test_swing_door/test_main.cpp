@@ -0,0 +1,174 @@
+// Swinging-door codec (COLUMN_CODEC_SWING_DOOR): lossless at tolerance 0,
+// never more than the tolerance away from the input otherwise, and the
+// per-register tolerances applied through compress_auto().
+
+#include <unity.h>
+#include <cstdlib>
+#include "host_support.h"
+#include "codecs.h"
+#include "compressor.h"
+#include "decompressor.h"
+#include "synthetic_traces.h"
+
+#define MAX_SAMPLES 300
+
+static uint16_t input[MAX_SAMPLES];
+static uint16_t decoded[MAX_SAMPLES];
+static uint8_t encoded[MAX_SAMPLES * 8 + 64];
+
+static uint16_t rows[MAX_SAMPLES * READ_REGISTER_COUNT];
+static uint16_t columns[MAX_SAMPLES * READ_REGISTER_COUNT];
+static sample_store_t store;
+static uint8_t frame[MAX_COMPRESSION_SIZE + 1];
+static uint16_t frame_values[MAX_SAMPLES * READ_REGISTER_COUNT];
+
+static const uint16_t TOLERANCES[] = {0, 1, 3, 20, 250, MAX_REGISTER_TOLERANCE};
+
+void setUp(void) {
+    memset(decoded, 0xA5, sizeof(decoded));
+    uint16_t lossless[READ_REGISTER_COUNT] = {0};
+    compression_set_tolerances(lossless);
+}
+
+void tearDown(void) {}
+
+// Encode and decode input[0..count-1]; returns the largest reconstruction error
+static int32_t round_trip(size_t count, uint16_t tolerance, size_t* length_out = nullptr) {
+    bit_writer_t writer;
+    bit_writer_init(&writer, encoded, sizeof(encoded));
+    size_t length = column_encode(COLUMN_CODEC_SWING_DOOR, input, 1, count, &writer, tolerance);
+    TEST_ASSERT_FALSE(writer.overflow);
+
+    bit_writer_t counter;
+    bit_writer_init(&counter, nullptr, 0);
+    TEST_ASSERT_EQUAL(length, column_encode(COLUMN_CODEC_SWING_DOOR, input, 1, count, &counter, tolerance));
+
+    bit_reader_t reader;
+    bit_reader_init(&reader, encoded, length);
+    TEST_ASSERT_TRUE(column_decode(COLUMN_CODEC_SWING_DOOR, &reader, decoded, 1, count));
+    TEST_ASSERT_EQUAL(length, bit_reader_bytes(&reader));
+
+    int32_t worst = 0;
+    for (size_t i = 0; i < count; i++) {
+        int32_t error = abs((int32_t)decoded[i] - (int32_t)input[i]);
+        worst = error > worst ? error : worst;
+    }
+    // End points are archived exactly
+    TEST_ASSERT_EQUAL_UINT16(input[0], decoded[0]);
+    TEST_ASSERT_EQUAL_UINT16(input[count - 1], decoded[count - 1]);
+    if (length_out) {
+        *length_out = length;
+    }
+    return worst;
+}
+
+// Every tolerance over the current input, at several lengths
+static void check_bound(void) {
+    static const size_t LENGTHS[] = {1, 2, 3, 17, 100, MAX_SAMPLES};
+    for (size_t t = 0; t < sizeof(TOLERANCES) / sizeof(TOLERANCES[0]); t++) {
+        for (size_t l = 0; l < sizeof(LENGTHS) / sizeof(LENGTHS[0]); l++) {
+            int32_t worst = round_trip(LENGTHS[l], TOLERANCES[t]);
+            TEST_ASSERT_LESS_OR_EQUAL(TOLERANCES[t], worst);
+        }
+    }
+}
+
+static void test_random_walks(void) {
+    static const int32_t SPREADS[] = {1, 10, 200};
+    for (uint32_t seed = 1; seed <= 5; seed++) {
+        for (size_t s = 0; s < sizeof(SPREADS) / sizeof(SPREADS[0]); s++) {
+            trace_rng_t rng;
+            trace_seed(&rng, seed);
+            trace_walk(&rng, input, 1, MAX_SAMPLES, 20000, SPREADS[s], 0, 65535);
+            check_bound();
+        }
+    }
+}
+
+// Walks pinned against both ends of the register range
+static void test_range_limits(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 9);
+    trace_walk(&rng, input, 1, MAX_SAMPLES, 0, 300, 0, 65535);
+    check_bound();
+    trace_walk(&rng, input, 1, MAX_SAMPLES, 65535, 300, 0, 65535);
+    check_bound();
+}
+
+static void test_noise_and_steps(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 3);
+    trace_noise(&rng, input, 1, MAX_SAMPLES);
+    check_bound();
+
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        input[i] = (i / 25) % 2 ? 4000 : 100;  // Square wave
+    }
+    check_bound();
+}
+
+// A straight line is one segment whatever the tolerance
+static void test_ramp_is_one_segment(void) {
+    trace_ramp(input, 1, MAX_SAMPLES, 100, 7);
+    for (size_t t = 0; t < sizeof(TOLERANCES) / sizeof(TOLERANCES[0]); t++) {
+        size_t length = 0;
+        TEST_ASSERT_EQUAL(0, round_trip(MAX_SAMPLES, TOLERANCES[t], &length));
+        TEST_ASSERT_LESS_OR_EQUAL(8, length);
+    }
+}
+
+// A wider door never needs more archived points on a noisy signal
+static void test_tolerance_trades_size(void) {
+    trace_rng_t rng;
+    trace_seed(&rng, 11);
+    trace_walk(&rng, input, 1, MAX_SAMPLES, 30000, 40, 0, 65535);
+    size_t lossless = 0;
+    size_t lossy = 0;
+    round_trip(MAX_SAMPLES, 0, &lossless);
+    round_trip(MAX_SAMPLES, 100, &lossy);
+    TEST_ASSERT_LESS_THAN(lossless / 2, lossy);
+}
+
+// Registers with a tolerance go through the swinging door in AUTO frames and
+// stay within their own tolerance; the others stay exact
+static void test_auto_frame_tolerances(void) {
+    static const uint16_t REGISTER_TOLERANCES[READ_REGISTER_COUNT] = {5, 0, 2, 50, 50, 0, 0, 0, 0, 100};
+    sample_store_attach(&store, columns, nullptr, MAX_SAMPLES, MAX_SAMPLES);
+    trace_rng_t rng;
+    trace_seed(&rng, 7);
+    trace_inverter(&rng, rows, MAX_SAMPLES);
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        sample_store_set_row(&store, i, rows + i * READ_REGISTER_COUNT);
+    }
+    compression_set_tolerances(REGISTER_TOLERANCES);
+
+    compression_metrics_t metrics = compress_auto(&store, MAX_SAMPLES, frame + 1, sizeof(frame) - 1);
+    TEST_ASSERT_FALSE(metrics.predicted);
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        if (REGISTER_TOLERANCES[reg] > 0) {
+            TEST_ASSERT_EQUAL(COLUMN_CODEC_SWING_DOOR, metrics.column_codecs[reg]);
+        }
+    }
+
+    frame[0] = (uint8_t)(metrics.method_id << FRAME_METHOD_SHIFT);
+    size_t sample_count = 0;
+    uint8_t register_count = 0;
+    TEST_ASSERT_TRUE(decompress_frame(frame, metrics.compressed_payload_size + 1, frame_values,
+                                      MAX_SAMPLES * READ_REGISTER_COUNT, &sample_count, &register_count));
+    TEST_ASSERT_EQUAL(MAX_SAMPLES, sample_count);
+    for (size_t i = 0; i < MAX_SAMPLES * READ_REGISTER_COUNT; i++) {
+        int32_t error = abs((int32_t)frame_values[i] - (int32_t)rows[i]);
+        TEST_ASSERT_LESS_OR_EQUAL(REGISTER_TOLERANCES[i % READ_REGISTER_COUNT], error);
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_random_walks);
+    RUN_TEST(test_range_limits);
+    RUN_TEST(test_noise_and_steps);
+    RUN_TEST(test_ramp_is_one_segment);
+    RUN_TEST(test_tolerance_trades_size);
+    RUN_TEST(test_auto_frame_tolerances);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+// Task timing record (FRAME_TLV_TASK_TIMING): log2 bucket boundaries,
+// saturating counters, exact round trips of the sparse histograms, and
+// cut-off or inconsistent values rejected.
+
+#include <unity.h>
+#include <cstring>
+#include "timing_stats.h"
+
+#define TASKS 4
+
+static task_timing_t tasks[TASKS];
+static task_timing_t decoded[TASKS];
+static uint8_t encoded[256];
+
+void setUp(void) {
+    timing_clear(tasks, TASKS);
+    memset(decoded, 0xA5, sizeof(decoded));
+}
+
+void tearDown(void) {}
+
+static void test_bucket_boundaries(void) {
+    TEST_ASSERT_EQUAL(0, timing_bucket(0));
+    for (size_t bucket = 0; bucket < TIMING_BUCKETS - 1; bucket++) {
+        uint32_t limit = timing_bucket_limit(bucket);
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)1 << bucket, limit);
+        TEST_ASSERT_EQUAL(bucket, timing_bucket(limit - 1));
+        TEST_ASSERT_EQUAL(bucket + 1, timing_bucket(limit));
+    }
+    // The last bucket is open-ended
+    TEST_ASSERT_EQUAL_UINT32(0, timing_bucket_limit(TIMING_BUCKETS - 1));
+    TEST_ASSERT_EQUAL(TIMING_BUCKETS - 1, timing_bucket(1u << 20));
+    TEST_ASSERT_EQUAL(TIMING_BUCKETS - 1, timing_bucket(UINT32_MAX));
+}
+
+static void test_counters_saturate(void) {
+    for (uint32_t i = 0; i < 70000; i++) {
+        timing_record(&tasks[0], 3, 0);
+    }
+    TEST_ASSERT_EQUAL(UINT16_MAX, tasks[0].runs);
+    TEST_ASSERT_EQUAL(UINT16_MAX, tasks[0].lateness_ms.buckets[2]);
+    TEST_ASSERT_EQUAL(UINT16_MAX, tasks[0].runtime_ms.buckets[0]);
+
+    timing_add_missed(&tasks[1], 65000);
+    timing_add_missed(&tasks[1], 1000);
+    TEST_ASSERT_EQUAL(UINT16_MAX, tasks[1].missed);
+}
+
+static void test_round_trip(void) {
+    // Task 0: on time, one bucket each
+    timing_record(&tasks[0], 0, 5);
+    // Task 1 stays idle and is left out of the record
+    // Task 2: spread over both ends of the range, multi-byte counts
+    for (uint32_t i = 0; i < 300; i++) {
+        timing_record(&tasks[2], i * 97, 1u << (i % 20));
+    }
+    timing_add_missed(&tasks[2], 40000);
+    // Task 3: only missed periods
+    timing_add_missed(&tasks[3], 2);
+
+    size_t length = timing_encode(tasks, TASKS, encoded, sizeof(encoded));
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_EQUAL_UINT8(3, encoded[0]);
+    TEST_ASSERT_TRUE(timing_decode(encoded, length, decoded, TASKS));
+    TEST_ASSERT_EQUAL_MEMORY(tasks, decoded, sizeof(tasks));
+
+    // [count] [id] [runs] [missed] [mask u16] [count] [mask u16] [count]
+    timing_clear(tasks, TASKS);
+    timing_record(&tasks[1], 0, 5);
+    TEST_ASSERT_EQUAL(10, timing_encode(tasks, TASKS, encoded, sizeof(encoded)));
+    static const uint8_t expected[] = {1, 1, 1, 0, 0x01, 0x00, 1, 0x08, 0x00, 1};
+    TEST_ASSERT_EQUAL_MEMORY(expected, encoded, sizeof(expected));
+
+    // No activity: just the zero task count
+    timing_clear(tasks, TASKS);
+    TEST_ASSERT_EQUAL(1, timing_encode(tasks, TASKS, encoded, sizeof(encoded)));
+    TEST_ASSERT_TRUE(timing_decode(encoded, 1, decoded, TASKS));
+    TEST_ASSERT_EQUAL_MEMORY(tasks, decoded, sizeof(tasks));
+}
+
+static void test_truncated_input_rejected(void) {
+    for (uint32_t i = 0; i < 50; i++) {
+        timing_record(&tasks[0], i, i * 31);
+        timing_record(&tasks[3], i * 1000, 2);
+    }
+    timing_add_missed(&tasks[3], 300);
+    size_t length = timing_encode(tasks, TASKS, encoded, sizeof(encoded));
+    TEST_ASSERT_TRUE(length > 0);
+
+    for (size_t cut = 0; cut < length; cut++) {
+        TEST_ASSERT_FALSE(timing_decode(encoded, cut, decoded, TASKS));
+    }
+    // Trailing bytes are not a valid record either
+    encoded[length] = 0;
+    TEST_ASSERT_FALSE(timing_decode(encoded, length + 1, decoded, TASKS));
+
+    // Nor is a task id the decoder has no slot for
+    TEST_ASSERT_FALSE(timing_decode(encoded, length, decoded, 3));
+
+    // Encoding into any smaller buffer fails rather than truncating
+    for (size_t capacity = 0; capacity < length; capacity++) {
+        TEST_ASSERT_EQUAL(0, timing_encode(tasks, TASKS, encoded, capacity));
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bucket_boundaries);
+    RUN_TEST(test_counters_saturate);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_truncated_input_rejected);
+    return UNITY_END();
+}
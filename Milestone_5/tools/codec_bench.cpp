@@ -0,0 +1,252 @@
+// Host tool: benchmarks every column codec (codecs.h) on synthetic and
+// recorded register traces and prints, per trace and codec, the encode and
+// decode time per sample, the bytes per sample and the compression ratio
+// against raw 16-bit values.
+//
+// Build and run from Milestone_5/:
+//   g++ -std=c++17 -O2 -Ilib/compression -Itest/native/include tools/codec_bench.cpp
+//       lib/compression/{codecs,bitstream}.cpp -o codec_bench
+//   ./codec_bench [trace.csv | frame.bin ...]
+//
+// Synthetic traces are always run. Recorded traces:
+//   .csv  one sample per line, register values separated by commas or
+//         whitespace (same format as tools/entropy_train.cpp)
+//   .bin  legacy Milestone_3 Delta+RLE payload (e.g. ../Milestone_3/current_frame.bin):
+//         [count u16 BE] [registers u8] [data size u16 LE], then per register the
+//         first value (u16 LE) and 0x00 <run> / 0x01 <delta i16 BE> tokens; a
+//         trailing CRC is ignored
+//
+// Every register is encoded in batches of BENCH_BATCH samples, as the device
+// does; a sample is one register value.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "codecs.h"
+#include "synthetic_traces.h"
+
+#define BENCH_BATCH 100
+#define BENCH_MIN_SAMPLES 200000  // Values encoded per measurement (repeats short traces)
+
+struct Trace {
+    std::string name;
+    std::vector<std::vector<uint16_t>> columns;  // One series per register
+};
+
+static bool ends_with(const char* text, const char* suffix) {
+    size_t text_len = strlen(text);
+    size_t suffix_len = strlen(suffix);
+    return text_len >= suffix_len && strcmp(text + text_len - suffix_len, suffix) == 0;
+}
+
+static bool load_csv(const char* path, Trace* trace) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    trace->name = path;
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') {
+            continue;
+        }
+        std::vector<uint16_t> row;
+        char* cursor = line;
+        while (*cursor) {
+            char* end;
+            long value = strtol(cursor, &end, 10);
+            if (end == cursor) {
+                cursor++;
+                continue;
+            }
+            row.push_back((uint16_t)value);
+            cursor = end;
+        }
+        if (row.empty()) {
+            continue;
+        }
+        if (trace->columns.empty()) {
+            trace->columns.resize(row.size());
+        }
+        if (row.size() != trace->columns.size()) {
+            continue;
+        }
+        for (size_t reg = 0; reg < row.size(); reg++) {
+            trace->columns[reg].push_back(row[reg]);
+        }
+    }
+    fclose(file);
+    return !trace->columns.empty();
+}
+
+static bool load_legacy_frame(const char* path, Trace* trace) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        bytes.push_back((uint8_t)c);
+    }
+    fclose(file);
+
+    if (bytes.size() < 5) {
+        return false;
+    }
+    size_t count = ((size_t)bytes[0] << 8) | bytes[1];
+    size_t registers = bytes[2];
+    size_t data_len = bytes[3] | ((size_t)bytes[4] << 8);
+    if (5 + data_len > bytes.size()) {
+        fprintf(stderr, "%s: truncated legacy frame\n", path);
+        return false;
+    }
+    trace->name = path;
+    trace->columns.assign(registers, std::vector<uint16_t>());
+    size_t pos = 5;
+    size_t end = 5 + data_len;
+    for (size_t reg = 0; reg < registers; reg++) {
+        if (pos + 2 > end) {
+            return false;
+        }
+        uint16_t value = (uint16_t)(bytes[pos] | (bytes[pos + 1] << 8));
+        pos += 2;
+        std::vector<uint16_t>& column = trace->columns[reg];
+        column.push_back(value);
+        while (column.size() < count) {
+            if (pos + 2 > end) {
+                return false;
+            }
+            if (bytes[pos] == 0x00) {
+                for (size_t i = 0; i < bytes[pos + 1] && column.size() < count; i++) {
+                    column.push_back(value);
+                }
+                pos += 2;
+            } else {
+                if (pos + 3 > end) {
+                    return false;
+                }
+                value = (uint16_t)(value + (int16_t)((bytes[pos + 1] << 8) | bytes[pos + 2]));
+                column.push_back(value);
+                pos += 3;
+            }
+        }
+    }
+    return true;
+}
+
+static void synthetic_traces(std::vector<Trace>* traces) {
+    const size_t samples = 2000;
+    trace_rng_t rng;
+
+    Trace inverter;
+    inverter.name = "synthetic inverter (10 registers)";
+    std::vector<uint16_t> rows(samples * 10);
+    trace_seed(&rng, 1);
+    trace_inverter(&rng, rows.data(), samples);
+    inverter.columns.assign(10, std::vector<uint16_t>(samples));
+    for (size_t reg = 0; reg < 10; reg++) {
+        for (size_t i = 0; i < samples; i++) {
+            inverter.columns[reg][i] = rows[i * 10 + reg];
+        }
+    }
+    traces->push_back(inverter);
+
+    Trace counter;
+    counter.name = "synthetic energy counter ramp";
+    counter.columns.assign(1, std::vector<uint16_t>(samples));
+    trace_ramp(counter.columns[0].data(), 1, samples, 65000, 3);
+    traces->push_back(counter);
+
+    Trace noisy;
+    noisy.name = "synthetic noisy walk (+/-200)";
+    noisy.columns.assign(1, std::vector<uint16_t>(samples));
+    trace_seed(&rng, 2);
+    trace_walk(&rng, noisy.columns[0].data(), 1, samples, 30000, 200, 0, 65535);
+    traces->push_back(noisy);
+
+    Trace flat;
+    flat.name = "synthetic flat";
+    flat.columns.assign(1, std::vector<uint16_t>(samples, 1234));
+    traces->push_back(flat);
+}
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void bench_trace(const Trace& trace) {
+    size_t values = 0;
+    for (const std::vector<uint16_t>& column : trace.columns) {
+        values += column.size();
+    }
+    if (values == 0) {
+        return;
+    }
+    size_t repeats = (BENCH_MIN_SAMPLES + values - 1) / values;
+
+    printf("\n%s: %zu registers, %zu samples\n", trace.name.c_str(), trace.columns.size(), values);
+    printf("  %-12s %12s %12s %14s %8s\n", "codec", "encode ns/s", "decode ns/s", "bytes/sample", "ratio");
+
+    std::vector<uint8_t> encoded(BENCH_BATCH * 8 + 64);
+    std::vector<uint16_t> decoded(BENCH_BATCH);
+    for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+        size_t total_bytes = 0;
+        bool exact = true;
+        double encode_ns = 0;
+        double decode_ns = 0;
+        for (size_t repeat = 0; repeat < repeats; repeat++) {
+            for (const std::vector<uint16_t>& column : trace.columns) {
+                for (size_t first = 0; first < column.size(); first += BENCH_BATCH) {
+                    size_t count = column.size() - first < BENCH_BATCH ? column.size() - first : BENCH_BATCH;
+
+                    auto start = std::chrono::steady_clock::now();
+                    bit_writer_t writer;
+                    bit_writer_init(&writer, encoded.data(), encoded.size());
+                    size_t length = column_encode(codec, column.data() + first, 1, count, &writer);
+                    encode_ns += elapsed_ns(start);
+
+                    start = std::chrono::steady_clock::now();
+                    bit_reader_t reader;
+                    bit_reader_init(&reader, encoded.data(), length);
+                    bool ok = column_decode(codec, &reader, decoded.data(), 1, count);
+                    decode_ns += elapsed_ns(start);
+
+                    if (repeat == 0) {
+                        total_bytes += length;
+                        exact &= ok && memcmp(decoded.data(), column.data() + first, count * sizeof(uint16_t)) == 0;
+                    }
+                }
+            }
+        }
+        double samples = (double)values * repeats;
+        double bytes_per_sample = (double)total_bytes / values;
+        printf("  %-12s %12.1f %12.1f %14.3f %8.2f%s\n", column_codec_name(codec), encode_ns / samples,
+               decode_ns / samples, bytes_per_sample, 2.0 / bytes_per_sample, exact ? "" : "  (NOT EXACT)");
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<Trace> traces;
+    synthetic_traces(&traces);
+    for (int i = 1; i < argc; i++) {
+        Trace trace;
+        bool loaded = ends_with(argv[i], ".bin") ? load_legacy_frame(argv[i], &trace) : load_csv(argv[i], &trace);
+        if (!loaded) {
+            fprintf(stderr, "skipping %s\n", argv[i]);
+            continue;
+        }
+        traces.push_back(trace);
+    }
+
+    printf("Batches of %d samples per register; ratio = raw 16-bit bytes / encoded bytes\n", BENCH_BATCH);
+    for (const Trace& trace : traces) {
+        bench_trace(trace);
+    }
+    return 0;
+}
@@ -0,0 +1,290 @@
+// Host tool: before/after benchmark of one Modbus poll (read of 10
+// registers), from the request frame to the decoded registers, including the
+// JSON request body and the "frame" hex taken out of the HTTP reply body.
+// "Before" is the hex-String path the firmware used until lib/modbus_frame
+// replaced it: format_request_frame + append_crc_to_frame, a String request
+// body, substring() of the reply, checkCRC and substring()/strtoul() register
+// decoding. "After" is the api_client / modbus_handler path: binary request,
+// hex-encoded into a stack body, reply hex decoded straight out of the body
+// and parsed in place. Both produce the same request body and registers, and
+// both reject a corrupted CRC, before anything is timed. The HTTP reply body
+// itself (HTTPClient::getString) is an input and allocates in both.
+//
+// Build and run from Milestone_5/:
+//   g++ -std=gnu++17 -O2 -Itest/native/include -Ilib/modbus_frame -Ilib/calculateCRC
+//       tools/modbus_bench.cpp lib/modbus_frame/modbus_frame.cpp
+//       lib/calculateCRC/calculateCRC.cpp -o modbus_bench
+//   ./modbus_bench [iterations]
+//
+// Heap allocations are counted by replacing the global operator new. String
+// is the host stand-in of test/native/include/Arduino.h (std::string with
+// small-string optimisation), so the "before" count is a lower bound of what
+// the Arduino String does on the device.
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <new>
+#include <Arduino.h>
+#include "modbus_frame.h"
+#include "calculateCRC.h"
+
+#define BENCH_ROUNDS 5
+#define BENCH_REGISTERS 10
+#define BENCH_SLAVE 0x11
+#define BODY_CAPACITY 64  // {"frame":"<request hex>"}
+
+NativeSerial Serial;
+
+static size_t allocations = 0;
+static size_t allocated_bytes = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    allocated_bytes += size;
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+static volatile size_t sink;  // Keeps results alive
+
+// ---------------- Before: hex-String path (pre-modbus_frame modbus_handler / checkCRC) ----------------
+static String legacy_format_request_frame(uint8_t slave_addr, uint8_t function_code, uint16_t start_reg,
+                                          uint16_t count_or_value) {
+    char frame[17];
+    snprintf(frame, sizeof(frame), "%02X%02X%04X%04X", slave_addr, function_code, start_reg, count_or_value);
+    return String(frame);
+}
+
+static String legacy_append_crc_to_frame(const String& frame_without_crc) {
+    int frame_length = frame_without_crc.length() / 2;
+    uint8_t frame_bytes[MODBUS_MAX_FRAME];
+    for (int i = 0; i < frame_length; i++) {
+        String byte_str = frame_without_crc.substring(i * 2, i * 2 + 2);
+        frame_bytes[i] = strtoul(byte_str.c_str(), nullptr, 16);
+    }
+    uint16_t crc = calculateCRC(frame_bytes, frame_length);
+    char crc_hex[5];
+    snprintf(crc_hex, sizeof(crc_hex), "%02X%02X", crc & 0xFF, (crc >> 8) & 0xFF);
+    return frame_without_crc + String(crc_hex);
+}
+
+static bool legacy_check_crc(const String& response_frame) {
+    if (response_frame.length() < 8) {
+        return false;
+    }
+    int frame_length = response_frame.length() / 2;
+    uint8_t response_bytes[MODBUS_MAX_FRAME];
+    for (int i = 0; i < frame_length; ++i) {
+        response_bytes[i] = strtoul(response_frame.substring(i * 2, i * 2 + 2).c_str(), nullptr, 16);
+    }
+    uint16_t received = (response_bytes[frame_length - 2]) | (response_bytes[frame_length - 1] << 8);
+    return calculateCRC(response_bytes, frame_length - 2) == received;
+}
+
+static bool legacy_is_exception_response(const String& response) {
+    if (response.length() < 4) {
+        return false;
+    }
+    String func_code_str = response.substring(2, 4);
+    return (strtoul(func_code_str.c_str(), nullptr, 16) & 0x80) != 0;
+}
+
+static bool legacy_decode_response_registers(const String& response, uint16_t* values, size_t max_count,
+                                             size_t* actual_count) {
+    *actual_count = 0;
+    if (response.length() < 6 || response.length() % 2 != 0 || !legacy_check_crc(response) ||
+        legacy_is_exception_response(response) || response.length() < 8) {
+        return false;
+    }
+    String byte_count_str = response.substring(4, 6);
+    size_t register_count = strtoul(byte_count_str.c_str(), nullptr, 16) / 2;
+    if (register_count > max_count) {
+        return false;
+    }
+    for (size_t i = 0; i < register_count; i++) {
+        size_t start_pos = 6 + i * 4;
+        if (start_pos + 4 > response.length() - 4) {
+            break;
+        }
+        String reg_str = response.substring(start_pos, start_pos + 4);
+        values[i] = strtoul(reg_str.c_str(), nullptr, 16);
+        (*actual_count)++;
+    }
+    return true;
+}
+
+// Request body and decoded registers of one poll; false if the reply is rejected
+static bool legacy_poll(const String& reply_body, char* request_body, uint16_t* values, size_t* count) {
+    String frame = legacy_format_request_frame(BENCH_SLAVE, 0x03, 0, BENCH_REGISTERS);
+    frame = legacy_append_crc_to_frame(frame);
+
+    // api_send_request(): request body, then the "frame" hex of the reply
+    String body;
+    body.reserve(frame.length() + 20);
+    body = "{\"frame\":\"";
+    body += frame;
+    body += "\"}";
+    memcpy(request_body, body.c_str(), body.length() + 1);
+
+    *count = 0;
+    size_t start = reply_body.find("\"frame\":\"");
+    if (start == std::string::npos) {
+        return false;
+    }
+    start += 9;
+    size_t end = reply_body.find('"', start);
+    String response = reply_body.substring(start, end);
+    return legacy_decode_response_registers(response, values, BENCH_REGISTERS, count);
+}
+
+// ---------------- After: binary frames, hex only at the HTTP edge ----------------
+static bool frame_poll(const String& reply_body, char* request_body, uint16_t* values, size_t* count) {
+    uint8_t request[MODBUS_REQUEST_SIZE];
+    size_t request_length = modbus_build_request(request, sizeof(request), BENCH_SLAVE, 0x03, 0, BENCH_REGISTERS);
+
+    // api_send_request(): body on the stack, reply hex decoded in place
+    static const char BODY_PREFIX[] = "{\"frame\":\"";
+    size_t body_length = sizeof(BODY_PREFIX) - 1;
+    memcpy(request_body, BODY_PREFIX, body_length);
+    body_length += modbus_hex_encode(request, request_length, request_body + body_length, BODY_CAPACITY - body_length);
+    memcpy(request_body + body_length, "\"}", 3);
+
+    *count = 0;
+    size_t start = reply_body.find("\"frame\":\"");
+    if (start == std::string::npos) {
+        return false;
+    }
+    start += 9;
+    size_t end = reply_body.find('"', start);
+    uint8_t reply[MODBUS_MAX_FRAME];
+    size_t reply_length = modbus_hex_decode(reply_body.c_str() + start, end - start, reply, sizeof(reply));
+    modbus_response_t response;
+    if (reply_length == 0 || modbus_parse_response(reply, reply_length, &response) != MODBUS_FRAME_OK ||
+        response.exception_code != 0) {
+        return false;
+    }
+    size_t register_count = modbus_register_count(&response);
+    if (register_count > BENCH_REGISTERS) {
+        return false;
+    }
+    for (size_t i = 0; i < register_count; i++) {
+        values[i] = modbus_register(&response, i);
+    }
+    *count = register_count;
+    return true;
+}
+
+// ---------------- Measurement ----------------
+typedef bool (*poll_fn)(const String&, char*, uint16_t*, size_t*);
+
+template <typename Pass>
+static double median_us(Pass pass, long iterations) {
+    double rounds[BENCH_ROUNDS];
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < iterations; i++) {
+            sink = pass();
+            asm volatile("" ::: "memory");
+        }
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        rounds[r] = elapsed.count() / iterations;
+    }
+    std::sort(rounds, rounds + BENCH_ROUNDS);
+    return rounds[BENCH_ROUNDS / 2];
+}
+
+// Allocations and bytes of one poll
+static void count_allocations(poll_fn poll, const String& reply_body, size_t* count, size_t* bytes) {
+    char request_body[BODY_CAPACITY];
+    uint16_t values[BENCH_REGISTERS];
+    size_t register_count;
+    size_t before = allocations;
+    size_t before_bytes = allocated_bytes;
+    sink = poll(reply_body, request_body, values, &register_count);
+    *count = allocations - before;
+    *bytes = allocated_bytes - before_bytes;
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 200000;
+    if (iterations <= 0) {
+        iterations = 200000;
+    }
+
+    // Reply of a 10-register read, as the cloud relays it (hex)
+    uint8_t reply[5 + 2 * BENCH_REGISTERS];
+    reply[0] = BENCH_SLAVE;
+    reply[1] = 0x03;
+    reply[2] = 2 * BENCH_REGISTERS;
+    for (size_t i = 0; i < BENCH_REGISTERS; i++) {
+        uint16_t value = (uint16_t)(2300 + 37 * i);
+        reply[3 + 2 * i] = (uint8_t)(value >> 8);
+        reply[4 + 2 * i] = (uint8_t)value;
+    }
+    uint16_t crc = calculateCRC(reply, sizeof(reply) - 2);
+    reply[sizeof(reply) - 2] = (uint8_t)crc;
+    reply[sizeof(reply) - 1] = (uint8_t)(crc >> 8);
+    char reply_hex[sizeof(reply) * 2 + 1];
+    modbus_hex_encode(reply, sizeof(reply), reply_hex, sizeof(reply_hex));
+    const String reply_body = String("{\"status\":\"ok\",\"frame\":\"") + reply_hex + "\"}";
+
+    // Same request, same registers, same CRC rejection before timing
+    char legacy_request[BODY_CAPACITY];
+    char frame_request[BODY_CAPACITY];
+    uint16_t legacy_values[BENCH_REGISTERS];
+    uint16_t frame_values[BENCH_REGISTERS];
+    size_t legacy_count;
+    size_t frame_count;
+    if (!legacy_poll(reply_body, legacy_request, legacy_values, &legacy_count) ||
+        !frame_poll(reply_body, frame_request, frame_values, &frame_count) || strcmp(legacy_request, frame_request) != 0 ||
+        legacy_count != BENCH_REGISTERS || frame_count != BENCH_REGISTERS ||
+        memcmp(legacy_values, frame_values, sizeof(legacy_values)) != 0) {
+        fprintf(stderr, "paths disagree\n");
+        return 1;
+    }
+    String corrupt_body = reply_body;
+    size_t digit = corrupt_body.find("\"frame\":\"") + 9 + 8;
+    corrupt_body[digit] = corrupt_body[digit] == '0' ? '1' : '0';
+    if (legacy_poll(corrupt_body, legacy_request, legacy_values, &legacy_count) ||
+        frame_poll(corrupt_body, frame_request, frame_values, &frame_count)) {
+        fprintf(stderr, "corrupted reply accepted\n");
+        return 1;
+    }
+
+    printf("Poll of %d registers (request body %s), median of %d rounds x %ld iterations\n", BENCH_REGISTERS,
+           frame_request, BENCH_ROUNDS, iterations);
+    size_t legacy_allocs, legacy_bytes, frame_allocs, frame_bytes;
+    count_allocations(legacy_poll, reply_body, &legacy_allocs, &legacy_bytes);
+    count_allocations(frame_poll, reply_body, &frame_allocs, &frame_bytes);
+    printf("  %-22s before %6zu (%zu bytes)   after %6zu (%zu bytes)\n", "heap allocations/poll", legacy_allocs,
+           legacy_bytes, frame_allocs, frame_bytes);
+
+    double before = median_us([&] {
+        char request_body[BODY_CAPACITY];
+        uint16_t values[BENCH_REGISTERS];
+        size_t count;
+        return (size_t)legacy_poll(reply_body, request_body, values, &count) + values[BENCH_REGISTERS - 1];
+    }, iterations);
+    double after = median_us([&] {
+        char request_body[BODY_CAPACITY];
+        uint16_t values[BENCH_REGISTERS];
+        size_t count;
+        return (size_t)frame_poll(reply_body, request_body, values, &count) + values[BENCH_REGISTERS - 1];
+    }, iterations);
+    printf("  %-22s before %8.2f us   after %8.2f us   (%+.0f%%)\n", "time/poll", before, after,
+           100.0 * (after - before) / before);
+    return 0;
+}
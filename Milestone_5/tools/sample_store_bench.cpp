@@ -0,0 +1,181 @@
+// Host tool: before/after benchmark of the sample buffer layout. "Before" is
+// the array-of-rows buffer the compressor and downsampler walked until the
+// column-major sample_store (lib/sample_store) replaced it: every register
+// column is read with a stride of READ_REGISTER_COUNT values. "After" runs the
+// same passes over the store's unit-stride columns, then the library entry
+// points themselves (compress_bitpack, compress_auto, downsample).
+//
+// Build and run from Milestone_5/:
+//   g++ -std=gnu++17 -O2 -Itest/native/include -Ilib/config -Ilib/error_handler -Ilib/scheduler
+//       -Ilib/compression -Ilib/sample_store tools/sample_store_bench.cpp
+//       lib/compression/{bitstream,codecs,compressor,downsampler,predictor}.cpp
+//       lib/sample_store/sample_store.cpp -o sample_store_bench
+//   ./sample_store_bench [iterations]
+//
+// Each pass runs `iterations` times per round (default 20000); the median of
+// BENCH_ROUNDS rounds is printed in microseconds per batch of
+// MAX_BUFFER_SAMPLES samples.
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include "host_support.h"
+#include "codecs.h"
+#include "compressor.h"
+#include "downsampler.h"
+#include "sample_store.h"
+#include "synthetic_traces.h"
+
+#define BENCH_ROUNDS 5
+#define BENCH_WINDOW AGG_WINDOW
+
+// Row of the pre-sample_store buffer (register values only)
+typedef struct {
+    uint16_t values[READ_REGISTER_COUNT];
+} legacy_row_t;
+
+static const size_t COUNT = MAX_BUFFER_SAMPLES;
+static const size_t WINDOWS = (MAX_BUFFER_SAMPLES + BENCH_WINDOW - 1) / BENCH_WINDOW;
+
+static legacy_row_t legacy_rows[MAX_BUFFER_SAMPLES];
+static legacy_row_t legacy_stats[WINDOWS * AGG_STAT_COUNT];
+static uint16_t store_storage[MAX_BUFFER_SAMPLES * READ_REGISTER_COUNT];
+static uint16_t stats_storage[WINDOWS * AGG_STAT_COUNT * READ_REGISTER_COUNT];
+static sample_store_t store;
+static sample_store_t stats;
+static uint8_t output[MAX_COMPRESSION_SIZE];
+static volatile size_t sink;  // Keeps results alive
+
+// ---------------- Passes over a column at a given stride ----------------
+static size_t encode_columns(uint8_t codec, const uint16_t* first, size_t register_step, size_t stride) {
+    bit_writer_t writer;
+    bit_writer_init(&writer, output, sizeof(output));
+    size_t total = 0;
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        total += column_encode(codec, first + reg * register_step, stride, COUNT, &writer);
+    }
+    return total;
+}
+
+// Size-only trials of every codec, as compress_auto() selects per register
+static size_t trial_columns(const uint16_t* first, size_t register_step, size_t stride) {
+    size_t total = 0;
+    for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+        size_t best = SIZE_MAX;
+        for (uint8_t codec = 0; codec < COLUMN_CODEC_COUNT; codec++) {
+            bit_writer_t counter;
+            bit_writer_init(&counter, nullptr, 0);
+            best = std::min(best, column_encode(codec, first + reg * register_step, stride, COUNT, &counter));
+        }
+        total += best;
+    }
+    return total;
+}
+
+// Pre-sample_store downsampler: windows outer, registers inner, strided reads
+static size_t legacy_downsample(void) {
+    for (size_t w = 0; w < WINDOWS; w++) {
+        size_t first = w * BENCH_WINDOW;
+        size_t end = std::min(first + BENCH_WINDOW, COUNT);
+        size_t actual = end - first;
+        for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+            uint16_t min_val = legacy_rows[first].values[reg];
+            uint16_t max_val = min_val;
+            uint32_t sum = 0;
+            for (size_t j = first; j < end; j++) {
+                uint16_t v = legacy_rows[j].values[reg];
+                if (v < min_val) min_val = v;
+                if (v > max_val) max_val = v;
+                sum += v;
+            }
+            legacy_stats[AGG_STAT_MIN * WINDOWS + w].values[reg] = min_val;
+            legacy_stats[AGG_STAT_MAX * WINDOWS + w].values[reg] = max_val;
+            legacy_stats[AGG_STAT_MEAN * WINDOWS + w].values[reg] = (uint16_t)((sum + actual / 2) / actual);
+            legacy_stats[AGG_STAT_LAST * WINDOWS + w].values[reg] = legacy_rows[end - 1].values[reg];
+        }
+    }
+    return WINDOWS * AGG_STAT_COUNT;
+}
+
+// ---------------- Timing ----------------
+template <typename Pass>
+static double median_us(Pass pass, long iterations) {
+    double rounds[BENCH_ROUNDS];
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < iterations; i++) {
+            sink = pass();
+            asm volatile("" ::: "memory");  // Inputs may have changed: no folding of repeated passes
+        }
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        rounds[r] = elapsed.count() / iterations;
+    }
+    std::sort(rounds, rounds + BENCH_ROUNDS);
+    return rounds[BENCH_ROUNDS / 2];
+}
+
+static void report(const char* name, double before, double after) {
+    printf("  %-26s before %8.2f us   after %8.2f us   (%+.0f%%)\n", name, before, after,
+           100.0 * (after - before) / before);
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 20000;
+    if (iterations <= 0) {
+        iterations = 20000;
+    }
+
+    sample_store_attach(&store, store_storage, nullptr, COUNT, COUNT);
+    sample_store_attach(&stats, stats_storage, nullptr, WINDOWS * AGG_STAT_COUNT, WINDOWS * AGG_STAT_COUNT);
+    uint16_t rows[MAX_BUFFER_SAMPLES * READ_REGISTER_COUNT];
+    trace_rng_t rng;
+    trace_seed(&rng, 1);
+    trace_inverter(&rng, rows, COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        memcpy(legacy_rows[i].values, rows + i * READ_REGISTER_COUNT, sizeof(legacy_rows[i].values));
+        sample_store_set_row(&store, i, rows + i * READ_REGISTER_COUNT);
+    }
+
+    // Both layouts must produce the same encoding before timing them
+    if (encode_columns(COLUMN_CODEC_BITPACK, legacy_rows[0].values, 1, READ_REGISTER_COUNT) !=
+            encode_columns(COLUMN_CODEC_BITPACK, store.columns, COUNT, 1) ||
+        trial_columns(legacy_rows[0].values, 1, READ_REGISTER_COUNT) != trial_columns(store.columns, COUNT, 1)) {
+        fprintf(stderr, "layouts disagree\n");
+        return 1;
+    }
+    legacy_downsample();
+    downsample_min_max_mean_last(&store, COUNT, BENCH_WINDOW, &stats);
+    for (size_t row = 0; row < WINDOWS * AGG_STAT_COUNT; row++) {
+        for (size_t reg = 0; reg < READ_REGISTER_COUNT; reg++) {
+            if (legacy_stats[row].values[reg] != sample_store_get(&stats, row, reg)) {
+                fprintf(stderr, "aggregates disagree\n");
+                return 1;
+            }
+        }
+    }
+
+    printf("%u samples x %u registers, median of %d rounds x %ld iterations\n", (unsigned)COUNT,
+           (unsigned)READ_REGISTER_COUNT, BENCH_ROUNDS, iterations);
+
+    printf("Same pass, row-major (stride %u) vs column-major (stride 1):\n", (unsigned)READ_REGISTER_COUNT);
+    report("bit-packed columns",
+           median_us([] { return encode_columns(COLUMN_CODEC_BITPACK, legacy_rows[0].values, 1, READ_REGISTER_COUNT); },
+                     iterations),
+           median_us([] { return encode_columns(COLUMN_CODEC_BITPACK, store.columns, COUNT, 1); }, iterations));
+    report("codec trials (all codecs)",
+           median_us([] { return trial_columns(legacy_rows[0].values, 1, READ_REGISTER_COUNT); }, iterations),
+           median_us([] { return trial_columns(store.columns, COUNT, 1); }, iterations));
+    report("min/max/mean/last",
+           median_us([] { return legacy_downsample(); }, iterations),
+           median_us([] { return downsample_min_max_mean_last(&store, COUNT, BENCH_WINDOW, &stats); }, iterations));
+
+    printf("Library entry points over the sample store:\n");
+    printf("  %-26s %8.2f us\n", "compress_bitpack",
+           median_us([] { return compress_bitpack(&store, COUNT, output, sizeof(output)).compressed_payload_size; },
+                     iterations));
+    printf("  %-26s %8.2f us\n", "compress_auto",
+           median_us([] { return compress_auto(&store, COUNT, output, sizeof(output)).compressed_payload_size; },
+                     iterations));
+    return 0;
+}